@@ -0,0 +1,204 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+// Простой каркас микробенчмарков
+
+// Каждый замер: несколько прогревочных повторений (не учитываются),
+// затем повторения с замером времени каждого. Повторение может
+// выполнять операцию несколько раз подряд (opsPerRep) - так меряются
+// операции короче разрешения часов; время пересчитывается на одну операцию.
+
+// По всем повторениям считаются минимум, среднее, медиана и p99
+// (точно, по отсортированным замерам; при малом числе повторений p99 -
+// это по сути максимум). Медиана устойчива к единичным выбросам -
+// по ней удобнее сравнивать запуски.
+
+// Число повторений ограничено и количеством, и бюджетом времени:
+// на графе в 10M рёбер одно повторение может идти секунды.
+
+// Результаты выводятся таблицей и (по желанию) в JSON для сравнения
+// с сохранёнными результатами.
+
+// Не даёт компилятору выбросить вычисление, результат которого не используется
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Результат одного замера (время - наносекунды на одну операцию)
+struct BenchResult {
+    string name;         // Что меряли (например, "dijkstra_find_path")
+    long long size;      // Размер входа (рёбер, байт, вершин пути)
+    string unit;         // В чём измеряется size
+    int repetitions;     // Сколько повторений учтено
+    long long opsPerRep; // Операций в одном повторении
+    double minNs;
+    double meanNs;
+    double medianNs;
+    double p99Ns;
+};
+
+// Параметры запуска
+struct BenchConfig {
+    int warmup = 2;              // Прогревочных повторений
+    int repetitions = 15;        // Повторений с замером (не больше)
+    int minRepetitions = 3;      // Повторений с замером (не меньше)
+    double budgetSeconds = 2.0;  // Сколько времени можно тратить на один замер
+    string filter;               // Выполнять только замеры, в имени которых есть эта строка
+};
+
+class BenchRunner {
+public:
+    explicit BenchRunner(const BenchConfig& config) : config(config) {}
+
+    // Нужно ли выполнять замер с таким именем (с учётом --filter)
+    bool selected(const string& name) const {
+        return config.filter.empty() || name.find(config.filter) != string::npos;
+    }
+
+    // Выполняет замер
+    // setup Подготовка перед каждым повторением (не входит во время, может быть пустой)
+    // body Замеряемая операция; получает номер повторения
+    void run(const string& name, long long size, const string& unit, long long opsPerRep,
+             const function<void()>& setup, const function<void(int)>& body) {
+        if (!selected(name)) {
+            return;
+        }
+
+        // Прогрев; если одно повторение дольше бюджета, одного прогрева достаточно
+        double warmed = 0;
+        for (int i = 0; i < config.warmup && (i == 0 || warmed < config.budgetSeconds); i++) {
+            if (setup) {
+                setup();
+            }
+            auto begin = chrono::steady_clock::now();
+            body(i);
+            warmed += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        }
+
+        vector<double> samples;
+        double spent = 0;
+        for (int i = 0; i < config.repetitions; i++) {
+            if (i >= config.minRepetitions && spent >= config.budgetSeconds) {
+                break;
+            }
+            if (setup) {
+                setup();
+            }
+            auto begin = chrono::steady_clock::now();
+            body(i);
+            auto end = chrono::steady_clock::now();
+            double ns = chrono::duration<double, nano>(end - begin).count();
+            samples.push_back(ns / static_cast<double>(opsPerRep));
+            spent += ns / 1e9;
+        }
+
+        BenchResult result;
+        result.name = name;
+        result.size = size;
+        result.unit = unit;
+        result.repetitions = static_cast<int>(samples.size());
+        result.opsPerRep = opsPerRep;
+
+        sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double sample : samples) {
+            sum += sample;
+        }
+        result.minNs = samples.front();
+        result.meanNs = sum / static_cast<double>(samples.size());
+        result.medianNs = percentile(samples, 0.5);
+        result.p99Ns = percentile(samples, 0.99);
+
+        print(result);
+        results.push_back(result);
+    }
+
+    // Все результаты в JSON
+    string toJson() const {
+        ostringstream out;
+        out << "{\n  \"suite\": \"microbench\",\n";
+        out << "  \"config\": {\"warmup\": " << config.warmup
+            << ", \"repetitions\": " << config.repetitions
+            << ", \"min_repetitions\": " << config.minRepetitions
+            << ", \"budget_seconds\": " << config.budgetSeconds << "},\n";
+        out << "  \"results\": [";
+        out << fixed << setprecision(1);
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult& r = results[i];
+            out << (i == 0 ? "\n" : ",\n")
+                << "    {\"name\": \"" << r.name << "\", \"size\": " << r.size
+                << ", \"unit\": \"" << r.unit << "\", \"repetitions\": " << r.repetitions
+                << ", \"ops_per_rep\": " << r.opsPerRep
+                << ", \"min_ns\": " << r.minNs << ", \"mean_ns\": " << r.meanNs
+                << ", \"median_ns\": " << r.medianNs << ", \"p99_ns\": " << r.p99Ns << "}";
+        }
+        out << "\n  ]\n}\n";
+        return out.str();
+    }
+
+    // Сохраняет JSON в файл; false, если файл не удалось записать
+    bool writeJson(const string& path) const {
+        ofstream file(path);
+        if (!file) {
+            return false;
+        }
+        file << toJson();
+        return static_cast<bool>(file);
+    }
+
+    const vector<BenchResult>& getResults() const {
+        return results;
+    }
+
+private:
+    BenchConfig config;
+    vector<BenchResult> results;
+
+    // Значение, не больше которого доля quantile замеров (замеры отсортированы)
+    static double percentile(const vector<double>& sorted, double quantile) {
+        size_t rank = static_cast<size_t>(quantile * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[min(rank, sorted.size() - 1)];
+    }
+
+    // Время в удобных единицах
+    static string formatNs(double ns) {
+        ostringstream out;
+        out << fixed << setprecision(2);
+        if (ns < 1e3) {
+            out << ns << " нс";
+        } else if (ns < 1e6) {
+            out << ns / 1e3 << " мкс";
+        } else if (ns < 1e9) {
+            out << ns / 1e6 << " мс";
+        } else {
+            out << ns / 1e9 << " с";
+        }
+        return out.str();
+    }
+
+    // Строка таблицы
+    static void print(const BenchResult& r) {
+        cout << left << setw(30) << r.name << right << setw(10) << r.size << " " << left
+             << setw(6) << r.unit
+             << "  медиана " << setw(12) << formatNs(r.medianNs)
+             << "  p99 " << setw(12) << formatNs(r.p99Ns)
+             << "  мин " << setw(12) << formatNs(r.minNs)
+             << "  (" << r.repetitions << " x " << r.opsPerRep << ")" << endl;
+    }
+};
+
+#endif // BENCH_HARNESS_H
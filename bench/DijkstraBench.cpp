@@ -0,0 +1,263 @@
+// Сравнение очередей для алгоритма Дейкстры на больших графах
+
+// Радикс-куча (целые веса) и 4-арная куча (дробные веса) из Dijkstra.h
+// сравниваются с классической реализацией на std::priority_queue.
+// Граф: V вершин, E случайных неориентированных рёбер (по умолчанию 1 000 000)
+// плюс кольцо через все вершины, чтобы граф был связным.
+
+// Дополнительно для поиска пути между двумя вершинами сравнивается
+// обычный findPath и A* с ориентирами (Landmarks.h): время и число
+// обработанных вершин.
+
+// Иерархия сжатий (ContractionHierarchy.h) проверяется на сетке со
+// случайными весами - она похожа на дорожную сеть, для которой метод
+// и придуман (на случайных графах иерархия получается слишком плотной).
+
+// Запуск: ./dijkstra_bench [рёбер] [вершин] [запусков]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <queue>
+#include <random>
+#include <chrono>
+#include <string>
+#include <functional>
+#include <cmath>
+
+#include "../common/Dijkstra.h"
+#include "../common/Landmarks.h"
+#include "../common/ContractionHierarchy.h"
+
+using namespace std;
+
+// Эталонная реализация: ленивая Дейкстра на std::priority_queue
+static vector<double> baselineDijkstra(const vector<vector<pair<int, double>>>& adj, int start) {
+    vector<double> dist(adj.size(), INF);
+    typedef pair<double, int> Item;
+    priority_queue<Item, vector<Item>, greater<Item>> pq;
+
+    dist[start] = 0;
+    pq.push({0, start});
+
+    while (!pq.empty()) {
+        Item top = pq.top();
+        pq.pop();
+        int u = top.second;
+        if (top.first != dist[u]) {
+            continue;
+        }
+        for (const auto& arc : adj[u]) {
+            double candidate = dist[u] + arc.second;
+            if (candidate < dist[arc.first]) {
+                dist[arc.first] = candidate;
+                pq.push({candidate, arc.first});
+            }
+        }
+    }
+    return dist;
+}
+
+// Среднее время одного запуска в миллисекундах
+static double measure(int runs, const function<void(int)>& body) {
+    auto begin = chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) {
+        body(i);
+    }
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(end - begin).count() / runs;
+}
+
+// Прогоняет один тип весов: строит граф, сравнивает время и результаты
+static bool runCase(const string& name, int vertices, int edges, int runs, bool integerWeights) {
+    mt19937 rng(42);
+    uniform_int_distribution<int> vertexDist(0, vertices - 1);
+    uniform_int_distribution<int> intWeight(1, 1000);
+    uniform_real_distribution<double> realWeight(0.5, 1000.0);
+
+    Dijkstra dijkstra(vertices);
+    vector<vector<pair<int, double>>> adj(vertices);
+
+    auto add = [&](int a, int b, double w) {
+        dijkstra.addEdge(a, b, w);
+        dijkstra.addEdge(b, a, w);
+        adj[a].push_back({b, w});
+        adj[b].push_back({a, w});
+    };
+
+    for (int v = 0; v < vertices; v++) {
+        add(v, (v + 1) % vertices, integerWeights ? intWeight(rng) : realWeight(rng));
+    }
+    for (int i = vertices; i < edges; i++) {
+        add(vertexDist(rng), vertexDist(rng), integerWeights ? intWeight(rng) : realWeight(rng));
+    }
+
+    vector<int> sources(runs);
+    for (int& s : sources) {
+        s = vertexDist(rng);
+    }
+
+    // Прогрев и проверка, что результаты совпадают
+    vector<double> expected = baselineDijkstra(adj, sources[0]);
+    vector<double> actual = dijkstra.findShortestPaths(sources[0]);
+    for (int v = 0; v < vertices; v++) {
+        // Дробные суммы по разным кратчайшим путям могут отличаться в последних битах
+        if (fabs(expected[v] - actual[v]) > 1e-9 * max(1.0, expected[v])) {
+            cout << name << ": РЕЗУЛЬТАТЫ НЕ СОВПАДАЮТ (вершина " << v << ")" << endl;
+            return false;
+        }
+    }
+
+    double baseMs = measure(runs, [&](int i) { baselineDijkstra(adj, sources[i]); });
+    double fastMs = measure(runs, [&](int i) { dijkstra.findShortestPaths(sources[i]); });
+
+    cout << left << setw(28) << name
+         << " priority_queue: " << fixed << setprecision(2) << setw(9) << baseMs << " мс"
+         << "  Dijkstra.h: " << setw(9) << fastMs << " мс"
+         << "  ускорение: x" << setprecision(2) << baseMs / fastMs << endl;
+
+    // Запросы "из точки в точку": обычный поиск против ALT
+    const int landmarkCount = 8;
+    const int queries = runs * 20;
+    Landmarks landmarks;
+    double buildMs = measure(1, [&](int) { landmarks.build(dijkstra, landmarkCount); });
+
+    vector<pair<int, int>> pairs(queries);
+    for (auto& p : pairs) {
+        p = {vertexDist(rng), vertexDist(rng)};
+    }
+
+    long long plainSettled = 0;
+    long long altSettled = 0;
+    double plainMs = measure(queries, [&](int i) {
+        SearchStats stats;
+        dijkstra.findPath(pairs[i].first, pairs[i].second, &stats);
+        plainSettled += stats.settled;
+    });
+    double altMs = measure(queries, [&](int i) {
+        SearchStats stats;
+        landmarks.findPath(dijkstra, pairs[i].first, pairs[i].second, &stats);
+        altSettled += stats.settled;
+    });
+
+    // Пути должны совпадать по длине
+    for (int i = 0; i < min(queries, 10); i++) {
+        double plain = dijkstra.findPath(pairs[i].first, pairs[i].second).first;
+        double alt = landmarks.findPath(dijkstra, pairs[i].first, pairs[i].second).first;
+        if (fabs(plain - alt) > 1e-9 * max(1.0, plain)) {
+            cout << name << ": ALT НАШЁЛ НЕ КРАТЧАЙШИЙ ПУТЬ" << endl;
+            return false;
+        }
+    }
+
+    cout << left << setw(28) << "  точка-точка" << fixed << setprecision(2)
+         << " findPath: " << setw(9) << plainMs << " мс, "
+         << plainSettled / queries << " вершин"
+         << "  ALT(K=" << landmarkCount << "): " << setw(9) << altMs << " мс, "
+         << altSettled / queries << " вершин"
+         << "  (построение ориентиров " << buildMs << " мс)" << endl;
+    return true;
+}
+
+// Иерархия сжатий на сетке side x side: построение и запросы против findPath и ALT
+static bool runHierarchyCase(int side, int queries) {
+    mt19937 rng(7);
+    uniform_real_distribution<double> realWeight(1.0, 10.0);
+    int vertices = side * side;
+    uniform_int_distribution<int> vertexDist(0, vertices - 1);
+
+    Dijkstra dijkstra(vertices);
+    auto add = [&](int a, int b) {
+        double w = realWeight(rng);
+        dijkstra.addEdge(a, b, w);
+        dijkstra.addEdge(b, a, w);
+    };
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            int v = r * side + c;
+            if (c + 1 < side) {
+                add(v, v + 1);
+            }
+            if (r + 1 < side) {
+                add(v, v + side);
+            }
+        }
+    }
+
+    ContractionHierarchy hierarchy;
+    double buildMs = measure(1, [&](int) { hierarchy.build(dijkstra); });
+    Landmarks landmarks;
+    landmarks.build(dijkstra, 8);
+
+    vector<pair<int, int>> pairs(queries);
+    for (auto& p : pairs) {
+        p = {vertexDist(rng), vertexDist(rng)};
+    }
+
+    // Длины и сами пути (после распаковки ярлыков) должны совпадать с обычным поиском
+    for (int i = 0; i < min(queries, 50); i++) {
+        pair<double, vector<int>> plain = dijkstra.findPath(pairs[i].first, pairs[i].second);
+        pair<double, vector<int>> ch = hierarchy.findPath(pairs[i].first, pairs[i].second);
+        bool ok = fabs(plain.first - ch.first) <= 1e-9 * max(1.0, plain.first) &&
+                  !ch.second.empty() && ch.second.front() == pairs[i].first &&
+                  ch.second.back() == pairs[i].second;
+        double unpacked = 0;
+        for (size_t k = 0; ok && k + 1 < ch.second.size(); k++) {
+            const vector<int>& nb = dijkstra.getNeighbors(ch.second[k]);
+            const vector<double>& w = dijkstra.getWeights(ch.second[k]);
+            double best = INF;
+            for (size_t j = 0; j < nb.size(); j++) {
+                if (nb[j] == ch.second[k + 1]) {
+                    best = min(best, w[j]);
+                }
+            }
+            unpacked += best;
+        }
+        if (!ok || fabs(unpacked - plain.first) > 1e-9 * max(1.0, plain.first)) {
+            cout << "CH: НЕВЕРНЫЙ ПУТЬ (запрос " << i << ")" << endl;
+            return false;
+        }
+    }
+
+    long long plainSettled = 0;
+    long long altSettled = 0;
+    long long chSettled = 0;
+    double plainMs = measure(queries, [&](int i) {
+        SearchStats stats;
+        dijkstra.findPath(pairs[i].first, pairs[i].second, &stats);
+        plainSettled += stats.settled;
+    });
+    double altMs = measure(queries, [&](int i) {
+        SearchStats stats;
+        landmarks.findPath(dijkstra, pairs[i].first, pairs[i].second, &stats);
+        altSettled += stats.settled;
+    });
+    double chMs = measure(queries, [&](int i) {
+        SearchStats stats;
+        hierarchy.findPath(pairs[i].first, pairs[i].second, &stats);
+        chSettled += stats.settled;
+    });
+
+    cout << "Сетка " << side << "x" << side << ", иерархия сжатий: построение "
+         << fixed << setprecision(2) << buildMs << " мс, рёбер с ярлыками "
+         << hierarchy.arcCount() << endl;
+    cout << left << setw(28) << "  точка-точка" << fixed << setprecision(3)
+         << " findPath: " << plainMs << " мс, " << plainSettled / queries << " вершин"
+         << "  ALT: " << altMs << " мс, " << altSettled / queries << " вершин"
+         << "  CH: " << chMs << " мс, " << chSettled / queries << " вершин" << endl;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int edges = argc > 1 ? stoi(argv[1]) : 1000000;
+    int vertices = argc > 2 ? stoi(argv[2]) : 250000;
+    int runs = argc > 3 ? stoi(argv[3]) : 5;
+
+    cout << "Граф: " << vertices << " вершин, " << edges << " рёбер, "
+         << runs << " запусков из случайных вершин" << endl;
+
+    bool ok = runCase("целые веса (радикс-куча)", vertices, edges, runs, true);
+    ok = runCase("дробные веса (4-арная куча)", vertices, edges, runs, false) && ok;
+    ok = runHierarchyCase(200, runs * 20) && ok;
+    return ok ? 0 : 1;
+}
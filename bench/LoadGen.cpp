@@ -0,0 +1,547 @@
+// Генератор нагрузки для сервера (TCP и UDP)
+
+// Открывает N соединений (для UDP - N сокетов) и нагружает сервер из M
+// потоков. Каждое соединение - обычный Client, поэтому кадры TCP и
+// доставка UDP с подтверждением и повторной отправкой те же, что у клиента.
+// Поток работает со своими соединениями по очереди, и одновременно
+// выполняется не больше M запросов.
+
+// Режимы:
+//   закрытый цикл (--rate=0) - следующий запрос сразу после ответа,
+//     показывает наибольшую пропускную способность;
+//   открытый цикл (--rate=R) - запросы по расписанию, R в секунду на всех.
+//     Задержка считается от момента, когда запрос ДОЛЖЕН был уйти по
+//     расписанию, а не от фактической отправки. Если сервер не успевает,
+//     запросы копятся, и их ожидание входит в задержку - без этой поправки
+//     (coordinated omission) медленные ответы "прячут" запросы, которые
+//     генератор просто не успел отправить, и перцентили выглядят лучше,
+//     чем видят реальные клиенты.
+
+// Смесь запросов: K разных графов по V вершин (в пределах ограничений
+// сервера: 6-20 вершин и рёбер), начальная и конечная вершины случайные.
+// От K зависит доля попаданий в кэш ответов и хранилище графов сервера.
+
+// Запуск: ./loadgen <IP> <протокол> <порт> [параметры]
+//         (протокол tcp, udp или shm; shm - только с адресом unix:<путь>)
+//   --connections=N  Соединений (по умолчанию 8)
+//   --threads=M      Потоков (по умолчанию = соединений)
+//   --rate=R         Запросов в секунду на всех (0 - закрытый цикл, по умолчанию)
+//   --duration=S     Длительность замера, секунды (по умолчанию 10)
+//   --warmup=S       Прогрев без учёта в статистике, секунды (по умолчанию 1)
+//   --graphs=K       Разных графов (по умолчанию 16)
+//   --vertices=V     Вершин в графе, 6-20 (по умолчанию 12)
+//   --weighted       Случайные целые веса 1-9 (иначе все веса 1)
+//   --deadline-ms=D  Срок ответа в запросе, мс (0 - срок по умолчанию сервера)
+//   --json=FILE      Сохранить результаты в JSON
+//   --async=W        AsyncClient: до W запросов в полёте на соединение (tcp, udp)
+//
+// Вместо одного сервера можно задать несколько через запятую
+// ("127.0.0.1:8080,127.0.0.1:8081" или "unix:/a.sock,unix:/b.sock", порт
+// тогда не указывается): запросы распределяет PooledClient, а в конце
+// выводится, сколько запросов обслужил каждый сервер.
+
+// Перегруженный сервер отвечает OVERLOADED или DEADLINE_EXCEEDED - такие
+// ответы считаются отдельно (они быстрые и входят в задержку и пропускную
+// способность, поэтому при перегрузке смотреть нужно и на коды ответов).
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+#include "../client/Client.h"
+#include "../client/AsyncClient.h"
+#include "../client/PooledClient.h"
+#include "../common/Histogram.h"
+
+using namespace std;
+
+// Сколько ждать перед повторным подключением после ошибки (миллисекунды)
+const int RECONNECT_DELAY_MS = 100;
+// Кодов ответа сервера (SUCCESS..DEADLINE_EXCEEDED)
+const int RESPONSE_CODES = DEADLINE_EXCEEDED + 1;
+// Перцентили в таблице распределения
+const vector<double> REPORT_PERCENTILES = {0.5, 0.75, 0.9, 0.95, 0.99, 0.999, 0.9999, 1.0};
+
+// Параметры запуска
+struct LoadConfig {
+    string ip;
+    string protocol;
+    int port = 0;
+    int connections = 8;
+    int threads = 0;
+    double rate = 0;
+    double duration = 10;
+    double warmup = 1;
+    int graphs = 16;
+    int vertices = 12;
+    bool weighted = false;
+    uint32_t deadlineMs = 0;
+    string jsonPath;
+    int asyncWindow = 0;     // 0 - синхронный Client
+    vector<string> endpoints; // Несколько серверов (PooledClient); пусто - один сервер
+};
+
+// Результаты одного потока
+struct ThreadStats {
+    Histogram latency;       // От запланированного момента отправки (мкс)
+    Histogram service;       // От фактической отправки (мкс)
+    uint64_t errors = 0;     // Запросов без ответа (обрыв, потеря UDP)
+    uint64_t codes[RESPONSE_CODES] = {};  // Ответы по кодам ошибок сервера
+    vector<uint64_t> endpointRequests;    // Запросов по серверам (PooledClient)
+};
+
+// Граф: кольцо через все вершины и хорды до 20 рёбер
+static vector<Edge> makeGraph(int vertices, bool weighted, mt19937& rng) {
+    uniform_int_distribution<int> vertexDist(0, vertices - 1);
+    uniform_int_distribution<int> weightDist(1, 9);
+    vector<Edge> edges;
+    for (int v = 0; v < vertices; v++) {
+        edges.push_back({v, (v + 1) % vertices, weighted ? weightDist(rng) : 1.0});
+    }
+    while (static_cast<int>(edges.size()) < 20) {
+        int a = vertexDist(rng);
+        int b = vertexDist(rng);
+        if (a != b) {
+            edges.push_back({a, b, weighted ? weightDist(rng) : 1.0});
+        }
+    }
+    return edges;
+}
+
+// Клиент одного соединения: Client или PooledClient
+template <typename ClientType>
+static unique_ptr<ClientType> makeClient(const LoadConfig& config) {
+    if constexpr (is_same_v<ClientType, PooledClient>) {
+        return make_unique<PooledClient>(config.endpoints, config.protocol);
+    } else {
+        return make_unique<Client>(config.ip, config.port, config.protocol);
+    }
+}
+
+// Поток нагрузки
+template <typename ClientType>
+static void runWorker(const LoadConfig& config, int index, int connectionCount,
+                      const vector<vector<Edge>>& graphs,
+                      chrono::steady_clock::time_point measureBegin,
+                      chrono::steady_clock::time_point end, ThreadStats& stats) {
+    vector<unique_ptr<ClientType>> clients;
+    for (int i = 0; i < connectionCount; i++) {
+        clients.push_back(makeClient<ClientType>(config));
+        clients.back()->connect();
+    }
+
+    mt19937 rng(1000 + index);
+    uniform_int_distribution<int> graphDist(0, static_cast<int>(graphs.size()) - 1);
+    uniform_int_distribution<int> vertexDist(0, config.vertices - 1);
+
+    // Расписание открытого цикла: поток отправляет каждый interval
+    double threadRate = config.rate / config.threads;
+    chrono::nanoseconds interval(0);
+    if (threadRate > 0) {
+        interval = chrono::nanoseconds(static_cast<long long>(1e9 / threadRate));
+    }
+    // Потоки начинают со сдвигом, чтобы запросы не уходили пачками
+    auto scheduled = chrono::steady_clock::now() + interval * index / config.threads;
+
+    size_t next = 0;
+    while (true) {
+        auto now = chrono::steady_clock::now();
+        if (now >= end) {
+            break;  // Запросы, которые не успели уйти до конца замера, не отправляются
+        }
+        if (threadRate > 0) {
+            if (scheduled >= end) {
+                break;
+            }
+            if (scheduled > now) {
+                this_thread::sleep_until(scheduled);
+            }
+        } else {
+            scheduled = now;
+        }
+
+        ClientType& client = *clients[next];
+        next = (next + 1) % clients.size();
+
+        ClientRequest request = {vertexDist(rng), vertexDist(rng), config.deadlineMs};
+        const vector<Edge>& edges = graphs[graphDist(rng)];
+
+        auto sent = chrono::steady_clock::now();
+        ServerResponse response;
+        bool ok = client.isConnected() && client.sendRequest(request, edges, response);
+        auto done = chrono::steady_clock::now();
+
+        // Прогрев не учитывается
+        if (scheduled >= measureBegin) {
+            if (ok) {
+                stats.latency.record(static_cast<uint64_t>(
+                    chrono::duration_cast<chrono::microseconds>(done - scheduled).count()));
+                stats.service.record(static_cast<uint64_t>(
+                    chrono::duration_cast<chrono::microseconds>(done - sent).count()));
+                if (response.error_code >= 0 && response.error_code < RESPONSE_CODES) {
+                    stats.codes[response.error_code]++;
+                }
+            } else {
+                stats.errors++;
+            }
+        }
+
+        // Соединение после ошибки в непонятном состоянии - открываем заново
+        if (!ok) {
+            client.disconnect();
+            this_thread::sleep_for(chrono::milliseconds(RECONNECT_DELAY_MS));
+            client.connect();
+        }
+
+        scheduled += interval;
+    }
+
+    if constexpr (is_same_v<ClientType, PooledClient>) {
+        stats.endpointRequests.assign(config.endpoints.size(), 0);
+        for (const auto& client : clients) {
+            for (size_t e = 0; e < client->endpointCount() && e < config.endpoints.size(); e++) {
+                stats.endpointRequests[e] += client->endpointRequests(e);
+            }
+        }
+    }
+}
+
+// Поток нагрузки на AsyncClient: запросы не ждут ответов, в полёте
+// до asyncWindow на соединение (в закрытом цикле submit ждёт места в окне)
+static void runAsyncWorker(const LoadConfig& config, int index, int connectionCount,
+                           const vector<vector<Edge>>& graphs,
+                           chrono::steady_clock::time_point measureBegin,
+                           chrono::steady_clock::time_point end, ThreadStats& stats) {
+    // Ответы приходят в потоках ввода-вывода клиентов - статистика под мьютексом
+    mutex statsMutex;
+    vector<unique_ptr<AsyncClient>> clients;
+    for (int i = 0; i < connectionCount; i++) {
+        clients.emplace_back(new AsyncClient(config.ip, config.port, config.protocol,
+                                             static_cast<size_t>(config.asyncWindow)));
+        clients.back()->connect();
+    }
+
+    mt19937 rng(1000 + index);
+    uniform_int_distribution<int> graphDist(0, static_cast<int>(graphs.size()) - 1);
+    uniform_int_distribution<int> vertexDist(0, config.vertices - 1);
+
+    double threadRate = config.rate / config.threads;
+    chrono::nanoseconds interval(0);
+    if (threadRate > 0) {
+        interval = chrono::nanoseconds(static_cast<long long>(1e9 / threadRate));
+    }
+    auto scheduled = chrono::steady_clock::now() + interval * index / config.threads;
+
+    size_t next = 0;
+    while (true) {
+        auto now = chrono::steady_clock::now();
+        if (now >= end) {
+            break;
+        }
+        if (threadRate > 0) {
+            if (scheduled >= end) {
+                break;
+            }
+            if (scheduled > now) {
+                this_thread::sleep_until(scheduled);
+            }
+        } else {
+            scheduled = now;
+        }
+
+        AsyncClient& client = *clients[next];
+        next = (next + 1) % clients.size();
+
+        ClientRequest request = {vertexDist(rng), vertexDist(rng), config.deadlineMs};
+        const vector<Edge>& edges = graphs[graphDist(rng)];
+
+        auto planned = scheduled;
+        bool queued = client.submit(request, edges, [&stats, &statsMutex, planned, measureBegin](
+                                                        bool ok, const ServerResponse& response) {
+            auto done = chrono::steady_clock::now();
+            if (planned < measureBegin) {
+                return;
+            }
+            lock_guard<mutex> lock(statsMutex);
+            if (ok) {
+                uint64_t micros = static_cast<uint64_t>(
+                    chrono::duration_cast<chrono::microseconds>(done - planned).count());
+                stats.latency.record(micros);
+                stats.service.record(micros);
+                if (response.error_code >= 0 && response.error_code < RESPONSE_CODES) {
+                    stats.codes[response.error_code]++;
+                }
+            } else {
+                stats.errors++;
+            }
+        });
+        if (!queued) {
+            // Соединение потеряно - открываем заново
+            if (scheduled >= measureBegin) {
+                lock_guard<mutex> lock(statsMutex);
+                stats.errors++;
+            }
+            client.disconnect();
+            this_thread::sleep_for(chrono::milliseconds(RECONNECT_DELAY_MS));
+            client.connect();
+        }
+
+        scheduled += interval;
+    }
+
+    // Ответы на уже отправленные запросы дожидаемся: обратные вызовы
+    // ссылаются на statsMutex этого потока
+    for (auto& client : clients) {
+        client->drain();
+    }
+}
+
+// Перцентили одной гистограммы в JSON
+static string histogramJson(const Histogram& histogram) {
+    ostringstream out;
+    out << fixed << setprecision(1);
+    out << "{\"p50\": " << histogram.percentile(0.5)
+        << ", \"p90\": " << histogram.percentile(0.9)
+        << ", \"p99\": " << histogram.percentile(0.99)
+        << ", \"p999\": " << histogram.percentile(0.999)
+        << ", \"max\": " << histogram.max()
+        << ", \"mean\": " << (histogram.count() == 0 ? 0.0 :
+               static_cast<double>(histogram.getSum()) / static_cast<double>(histogram.count()))
+        << "}";
+    return out.str();
+}
+
+// Таблица распределения (как у HdrHistogram: значение, перцентиль, сколько значений не больше)
+static void printDistribution(const string& title, const Histogram& histogram) {
+    cout << title << endl;
+    // setw считает байты, а не буквы, поэтому заголовок выровнен вручную
+    cout << "           мкс  перцентиль    запросов" << endl;
+    for (double q : REPORT_PERCENTILES) {
+        uint64_t value = histogram.percentile(q);
+        uint64_t below = 0;
+        for (int b = 0; b <= Histogram::bucketIndex(value); b++) {
+            below += histogram.bucketCount(b);
+        }
+        cout << "  " << setw(12) << value << setw(12) << fixed << setprecision(4) << q
+             << setw(12) << below << endl;
+    }
+}
+
+// Выводит справку
+static void printUsage(const char* programName) {
+    cout << "Использование: " << programName << " <IP> <протокол> <порт> [параметры]" << endl;
+    cout << "               " << programName << " unix:<путь> <протокол> [параметры]" << endl;
+    cout << "               " << programName << " <IP:порт>,<IP:порт>,... <протокол> [параметры]" << endl;
+    cout << "  --connections=N  Соединений (по умолчанию 8)" << endl;
+    cout << "  --threads=M      Потоков (по умолчанию = соединений)" << endl;
+    cout << "  --rate=R         Запросов в секунду на всех (0 - закрытый цикл)" << endl;
+    cout << "  --duration=S     Длительность замера, секунды (по умолчанию 10)" << endl;
+    cout << "  --warmup=S       Прогрев, секунды (по умолчанию 1)" << endl;
+    cout << "  --graphs=K       Разных графов (по умолчанию 16)" << endl;
+    cout << "  --vertices=V     Вершин в графе, 6-20 (по умолчанию 12)" << endl;
+    cout << "  --weighted       Случайные веса 1-9" << endl;
+    cout << "  --deadline-ms=D  Срок ответа в запросе, мс (0 - по умолчанию сервера)" << endl;
+    cout << "  --json=FILE      Сохранить результаты в JSON" << endl;
+    cout << "  --async=W        Асинхронный клиент, до W запросов в полёте на соединение" << endl;
+}
+
+// Разбирает параметры; false, если они неверны
+static bool parseArguments(int argc, char* argv[], LoadConfig& config) {
+    // У Unix-сокета ("unix:/путь") и списка серверов порта нет - параметры
+    // сразу после протокола
+    string target = argc >= 2 ? argv[1] : "";
+    bool pool = target.find(',') != string::npos ||
+                (!isUnixAddress(target) && target.find(':') != string::npos);
+    bool unixSocket = isUnixAddress(target) || pool;
+    int firstOption = unixSocket ? 3 : 4;
+    if (argc < firstOption) {
+        return false;
+    }
+    config.ip = target;
+    if (pool) {
+        stringstream list(target);
+        string endpoint;
+        while (getline(list, endpoint, ',')) {
+            string address;
+            int port;
+            if (!PooledClient::parseEndpoint(endpoint, address, port)) {
+                cout << "Неверный адрес сервера: " << endpoint << endl;
+                return false;
+            }
+            config.endpoints.push_back(endpoint);
+        }
+    }
+    config.protocol = argv[2];
+    try {
+        if (!unixSocket) {
+            config.port = stoi(argv[3]);
+        }
+        for (int i = firstOption; i < argc; i++) {
+            string option = argv[i];
+            size_t eq = option.find('=');
+            string key = option.substr(0, eq);
+            string value = eq == string::npos ? "" : option.substr(eq + 1);
+            if (key == "--connections") {
+                config.connections = stoi(value);
+            } else if (key == "--threads") {
+                config.threads = stoi(value);
+            } else if (key == "--rate") {
+                config.rate = stod(value);
+            } else if (key == "--duration") {
+                config.duration = stod(value);
+            } else if (key == "--warmup") {
+                config.warmup = stod(value);
+            } else if (key == "--graphs") {
+                config.graphs = stoi(value);
+            } else if (key == "--vertices") {
+                config.vertices = stoi(value);
+            } else if (key == "--weighted") {
+                config.weighted = true;
+            } else if (key == "--deadline-ms") {
+                config.deadlineMs = static_cast<uint32_t>(stoul(value));
+            } else if (key == "--json") {
+                config.jsonPath = value;
+            } else if (key == "--async") {
+                config.asyncWindow = stoi(value);
+            } else {
+                cout << "Неизвестный параметр: " << option << endl;
+                return false;
+            }
+        }
+    } catch (...) {
+        cout << "Неверное значение параметра" << endl;
+        return false;
+    }
+    if (config.threads == 0) {
+        config.threads = config.connections;
+    }
+    return (config.protocol == "tcp" || config.protocol == "udp" ||
+            (config.protocol == "shm" && unixSocket)) &&
+           (unixSocket || Validator::isValidPort(config.port)) && config.connections > 0 &&
+           config.threads > 0 && config.threads <= config.connections &&
+           config.rate >= 0 && config.duration > 0 && config.warmup >= 0 &&
+           config.graphs > 0 && config.vertices >= 6 && config.vertices <= 20 &&
+           config.asyncWindow >= 0 && (config.asyncWindow == 0 || config.protocol != "shm") &&
+           (config.asyncWindow == 0 || config.endpoints.empty());
+}
+
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+    if (!parseArguments(argc, argv, config)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Клиенты пишут в лог каждый шаг обмена - под нагрузкой оставляем только ошибки
+    Logger::setLevel(Logger::Level::ERROR);
+
+    mt19937 rng(42);
+    vector<vector<Edge>> graphs;
+    for (int i = 0; i < config.graphs; i++) {
+        graphs.push_back(makeGraph(config.vertices, config.weighted, rng));
+    }
+
+    string target = isUnixAddress(config.ip) || !config.endpoints.empty() ? config.ip : config.ip + ":" + to_string(config.port);
+    cout << "Нагрузка: " << config.protocol << " " << target
+         << ", соединений " << config.connections << ", потоков " << config.threads << ", "
+         << (config.rate > 0 ? "открытый цикл " + to_string(static_cast<long long>(config.rate)) +
+                                   " запр/с"
+                             : string("закрытый цикл"))
+         << ", " << config.duration << " с (+" << config.warmup << " с прогрева)"
+         << (config.asyncWindow > 0 ? ", асинхронно, окно " + to_string(config.asyncWindow) : string())
+         << endl;
+
+    auto begin = chrono::steady_clock::now();
+    auto measureBegin = begin + chrono::duration_cast<chrono::nanoseconds>(
+                                    chrono::duration<double>(config.warmup));
+    auto end = measureBegin + chrono::duration_cast<chrono::nanoseconds>(
+                                  chrono::duration<double>(config.duration));
+
+    vector<ThreadStats> stats(static_cast<size_t>(config.threads));
+    vector<thread> workers;
+    for (int t = 0; t < config.threads; t++) {
+        // Соединения делятся между потоками поровну (первым достаётся остаток)
+        int count = config.connections / config.threads + (t < config.connections % config.threads ? 1 : 0);
+        auto worker = config.asyncWindow > 0 ? runAsyncWorker
+                      : config.endpoints.empty() ? runWorker<Client> : runWorker<PooledClient>;
+        workers.emplace_back(worker, cref(config), t, count, cref(graphs),
+                             measureBegin, end, ref(stats[static_cast<size_t>(t)]));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    // Фактическое время замера: последние запросы могли завершиться после end
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - measureBegin).count();
+
+    ThreadStats total;
+    for (const ThreadStats& s : stats) {
+        total.latency.merge(s.latency);
+        total.service.merge(s.service);
+        total.errors += s.errors;
+        for (int c = 0; c < RESPONSE_CODES; c++) {
+            total.codes[c] += s.codes[c];
+        }
+    }
+
+    uint64_t completed = total.latency.count();
+    double throughput = static_cast<double>(completed) / elapsed;
+
+    cout << "Ответов: " << completed << ", ошибок: " << total.errors
+         << ", пропускная способность: " << fixed << setprecision(1) << throughput << " запр/с"
+         << endl;
+    cout << "Коды ответов: успех " << total.codes[SUCCESS]
+         << ", неверный запрос " << total.codes[INVALID_REQUEST]
+         << ", нет пути " << total.codes[NO_PATH]
+         << ", перегружен " << total.codes[OVERLOADED]
+         << ", срок истёк " << total.codes[DEADLINE_EXCEEDED] << endl;
+    if (!config.endpoints.empty()) {
+        cout << "Запросов по серверам:";
+        for (size_t e = 0; e < config.endpoints.size(); e++) {
+            uint64_t requests = 0;
+            for (const ThreadStats& s : stats) {
+                requests += e < s.endpointRequests.size() ? s.endpointRequests[e] : 0;
+            }
+            cout << (e == 0 ? " " : ", ") << config.endpoints[e] << " - " << requests;
+        }
+        cout << endl;
+    }
+    printDistribution("Задержка от запланированной отправки (с поправкой на coordinated omission):",
+                      total.latency);
+    printDistribution("Время обслуживания (от фактической отправки):", total.service);
+
+    if (!config.jsonPath.empty()) {
+        ofstream file(config.jsonPath);
+        file << fixed << setprecision(1);
+        file << "{\n  \"tool\": \"loadgen\",\n"
+             << "  \"protocol\": \"" << config.protocol << "\",\n"
+             << "  \"connections\": " << config.connections << ",\n"
+             << "  \"threads\": " << config.threads << ",\n"
+             << "  \"mode\": \"" << (config.rate > 0 ? "open" : "closed") << "\",\n"
+             << "  \"target_rate\": " << config.rate << ",\n"
+             << "  \"duration_s\": " << elapsed << ",\n"
+             << "  \"graphs\": " << config.graphs << ",\n"
+             << "  \"vertices\": " << config.vertices << ",\n"
+             << "  \"requests\": " << completed << ",\n"
+             << "  \"errors\": " << total.errors << ",\n"
+             << "  \"overloaded\": " << total.codes[OVERLOADED] << ",\n"
+             << "  \"deadline_exceeded\": " << total.codes[DEADLINE_EXCEEDED] << ",\n"
+             << "  \"throughput_rps\": " << throughput << ",\n"
+             << "  \"latency_us\": " << histogramJson(total.latency) << ",\n"
+             << "  \"service_time_us\": " << histogramJson(total.service) << "\n}\n";
+        if (!file) {
+            cout << "Не удалось записать " << config.jsonPath << endl;
+            return 1;
+        }
+        cout << "Результаты сохранены в " << config.jsonPath << endl;
+    }
+    return total.errors > 0 && completed == 0 ? 1 : 0;
+}
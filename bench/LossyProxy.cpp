@@ -0,0 +1,273 @@
+// UDP-прокси с потерями, задержкой и узким местом (для проверки канала UDP)
+
+// Заменяет netem там, где его нет (нет прав или модуля ядра): клиент
+// отправляет пакеты прокси, прокси - серверу и обратно. Для каждого
+// адреса клиента прокси открывает свой сокет к серверу, поэтому сервер
+// различает клиентов, как без прокси.
+
+// В обе стороны:
+//   --loss=P    - каждый пакет теряется с вероятностью P процентов;
+//   --delay=MS  - каждый пакет задерживается на MS миллисекунд (RTT
+//                 увеличивается на 2 * MS);
+//   --rate=PPS  - узкое место: не больше PPS пакетов в секунду, лишние
+//                 ждут в очереди из --queue=N пакетов (по умолчанию 64),
+//                 а при полной очереди отбрасываются (drop-tail, как
+//                 буфер маршрутизатора). Так видно, как отправитель
+//                 переживает перегрузку, а не только случайные потери.
+// При остановке (SIGINT, SIGTERM) выводит, сколько пакетов передано и
+// потеряно в каждую сторону.
+
+// Запуск: ./lossyproxy <порт прокси> <порт сервера> [параметры]
+//   --loss=P --delay=MS --rate=PPS --queue=N
+//   --seed=S  Начальное значение генератора потерь (по умолчанию случайное)
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <map>
+#include <queue>
+#include <random>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <cstdint>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+// Наибольший размер датаграммы
+const size_t DATAGRAM_SIZE = 65536;
+// Очередь узкого места по умолчанию (пакетов)
+const int DEFAULT_QUEUE = 64;
+// Наибольшее ожидание poll без пакетов в пути (миллисекунды)
+const int IDLE_POLL_MS = 100;
+
+// Направления
+enum Direction { TO_SERVER = 0, TO_CLIENT = 1 };
+
+// Параметры запуска
+struct ProxyConfig {
+    int listenPort = 0;
+    int serverPort = 0;
+    double loss = 0;
+    int delayMs = 0;
+    int rate = 0;
+    int queue = DEFAULT_QUEUE;
+    unsigned seed = random_device{}();
+};
+
+// Пакет в пути
+struct InFlight {
+    Clock::time_point releaseAt;
+    uint64_t order;  // Порядок при равном времени
+    int socket;      // Через какой сокет отправить
+    sockaddr_in to;
+    vector<char> data;
+
+    bool operator>(const InFlight& other) const {
+        return releaseAt != other.releaseAt ? releaseAt > other.releaseAt : order > other.order;
+    }
+};
+
+// Счётчики направления
+struct DirectionStats {
+    uint64_t received = 0;
+    uint64_t lost = 0;       // Случайные потери (--loss)
+    uint64_t overflow = 0;   // Отброшены узким местом (--rate, --queue)
+};
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) {
+    stopRequested = 1;
+}
+
+static void usage(const char* program) {
+    cerr << "Использование: " << program << " <порт прокси> <порт сервера>"
+         << " [--loss=P] [--delay=MS] [--rate=PPS] [--queue=N] [--seed=S]" << endl;
+}
+
+static bool parseArgs(int argc, char* argv[], ProxyConfig& config) {
+    if (argc < 3) {
+        return false;
+    }
+    try {
+        config.listenPort = stoi(argv[1]);
+        config.serverPort = stoi(argv[2]);
+        for (int i = 3; i < argc; i++) {
+            string arg = argv[i];
+            size_t eq = arg.find('=');
+            string name = arg.substr(0, eq);
+            string value = eq == string::npos ? "" : arg.substr(eq + 1);
+            if (name == "--loss") {
+                config.loss = stod(value);
+            } else if (name == "--delay") {
+                config.delayMs = stoi(value);
+            } else if (name == "--rate") {
+                config.rate = stoi(value);
+            } else if (name == "--queue") {
+                config.queue = stoi(value);
+            } else if (name == "--seed") {
+                config.seed = static_cast<unsigned>(stoul(value));
+            } else {
+                cerr << "Неизвестный параметр: " << arg << endl;
+                return false;
+            }
+        }
+    } catch (const exception&) {
+        return false;
+    }
+    return config.listenPort > 0 && config.serverPort > 0 && config.loss >= 0 && config.loss <= 100 &&
+           config.delayMs >= 0 && config.rate >= 0 && config.queue > 0;
+}
+
+static sockaddr_in loopback(int port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+static string keyOf(const sockaddr_in& addr) {
+    char ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+    return string(ip) + ":" + to_string(ntohs(addr.sin_port));
+}
+
+int main(int argc, char* argv[]) {
+    ProxyConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int listenSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in listenAddr = loopback(config.listenPort);
+    if (listenSocket < 0 || bind(listenSocket, reinterpret_cast<sockaddr*>(&listenAddr), sizeof(listenAddr)) < 0) {
+        cerr << "Не удалось открыть порт " << config.listenPort << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    sockaddr_in serverAddr = loopback(config.serverPort);
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    mt19937 rng(config.seed);
+    uniform_real_distribution<double> percent(0, 100);
+    auto delay = chrono::milliseconds(config.delayMs);
+    // Узкое место: пакет уходит не раньше, чем через interval после
+    // предыдущего в ту же сторону
+    auto interval = config.rate > 0 ? Clock::duration(chrono::seconds(1)) / config.rate : Clock::duration(0);
+    Clock::time_point bottleneckFree[2] = {Clock::now(), Clock::now()};
+
+    // Сокет к серверу для каждого клиента и обратное соответствие
+    map<string, int> upstreamOf;
+    map<int, sockaddr_in> clientOf;
+    priority_queue<InFlight, vector<InFlight>, greater<InFlight>> inFlight;
+    uint64_t order = 0;
+    DirectionStats stats[2];
+    vector<char> buffer(DATAGRAM_SIZE);
+
+    // Пакет принят: теряется, ждёт узкого места или задержки
+    auto admit = [&](Direction direction, int socket, const sockaddr_in& to, const char* data, size_t size) {
+        DirectionStats& counters = stats[direction];
+        counters.received++;
+        if (config.loss > 0 && percent(rng) < config.loss) {
+            counters.lost++;
+            return;
+        }
+        auto now = Clock::now();
+        auto departAt = now;
+        if (config.rate > 0) {
+            departAt = max(now, bottleneckFree[direction]);
+            if (departAt - now >= interval * config.queue) {
+                counters.overflow++;
+                return;
+            }
+            bottleneckFree[direction] = departAt + interval;
+        }
+        inFlight.push({departAt + delay, order++, socket, to, vector<char>(data, data + size)});
+    };
+
+    cout << "Прокси 127.0.0.1:" << config.listenPort << " -> 127.0.0.1:" << config.serverPort
+         << " (потери " << config.loss << "%, задержка " << config.delayMs << " мс";
+    if (config.rate > 0) {
+        cout << ", узкое место " << config.rate << " пак/с, очередь " << config.queue;
+    }
+    cout << ")" << endl;
+
+    while (!stopRequested) {
+        // Пакеты, чьё время пришло
+        auto now = Clock::now();
+        while (!inFlight.empty() && inFlight.top().releaseAt <= now) {
+            const InFlight& packet = inFlight.top();
+            sendto(packet.socket, packet.data.data(), packet.data.size(), 0,
+                   reinterpret_cast<const sockaddr*>(&packet.to), sizeof(packet.to));
+            inFlight.pop();
+        }
+
+        int timeoutMs = IDLE_POLL_MS;
+        if (!inFlight.empty()) {
+            auto wait = chrono::ceil<chrono::milliseconds>(inFlight.top().releaseAt - now);
+            timeoutMs = static_cast<int>(min<chrono::milliseconds::rep>(wait.count(), IDLE_POLL_MS));
+        }
+
+        vector<pollfd> fds;
+        fds.push_back({listenSocket, POLLIN, 0});
+        for (const auto& entry : clientOf) {
+            fds.push_back({entry.first, POLLIN, 0});
+        }
+        if (poll(fds.data(), fds.size(), timeoutMs) <= 0) {
+            continue;
+        }
+
+        for (const pollfd& fd : fds) {
+            if (!(fd.revents & POLLIN)) {
+                continue;
+            }
+            sockaddr_in from{};
+            socklen_t fromLength = sizeof(from);
+            ssize_t size = recvfrom(fd.fd, buffer.data(), buffer.size(), MSG_DONTWAIT,
+                                    reinterpret_cast<sockaddr*>(&from), &fromLength);
+            if (size < 0) {
+                continue;
+            }
+            if (fd.fd != listenSocket) {
+                admit(TO_CLIENT, listenSocket, clientOf[fd.fd], buffer.data(), static_cast<size_t>(size));
+                continue;
+            }
+            string key = keyOf(from);
+            auto found = upstreamOf.find(key);
+            if (found == upstreamOf.end()) {
+                int upstream = socket(AF_INET, SOCK_DGRAM, 0);
+                if (upstream < 0) {
+                    continue;
+                }
+                found = upstreamOf.emplace(key, upstream).first;
+                clientOf[upstream] = from;
+            }
+            admit(TO_SERVER, found->second, serverAddr, buffer.data(), static_cast<size_t>(size));
+        }
+    }
+
+    const char* names[2] = {"клиент -> сервер", "сервер -> клиент"};
+    for (int direction = TO_SERVER; direction <= TO_CLIENT; direction++) {
+        const DirectionStats& counters = stats[direction];
+        cout << names[direction] << ": пакетов " << counters.received << ", потеряно " << counters.lost
+             << ", отброшено узким местом " << counters.overflow << endl;
+    }
+
+    for (const auto& entry : clientOf) {
+        close(entry.first);
+    }
+    close(listenSocket);
+    return 0;
+}
@@ -0,0 +1,267 @@
+// Микробенчмарки основных операций клиента и сервера
+
+// Замеряются:
+//   graph_add_edges              - Graph::addEdges (построение графа на клиенте)
+//   dijkstra_find_shortest_paths - Dijkstra::findShortestPaths (из одной вершины во все)
+//   dijkstra_find_path           - Dijkstra::findPath (из точки в точку)
+//   request_to_bytes             - requestToBytes
+//   response_to_bytes            - responseToBytes (путь заданной длины)
+//   bytes_to_response            - bytesToResponse
+//   input_parser_parse_graph     - InputParser::parseGraph (строка "A B w, ...")
+//   udp_parse_packet             - UDPProtocol::parsePacket (пакет с блоком рёбер)
+
+// Графы генерируются с фиксированным зерном: кольцо через все вершины
+// (чтобы граф был связным) плюс случайные рёбра, вершин в 4 раза меньше,
+// чем рёбер, целые веса 1..1000. Размеры - от 20 до 10M рёбер.
+
+// Запуск: ./bench [параметры]
+//   --max-edges=N    Наибольший размер графа (по умолчанию 10000000)
+//   --reps=N         Повторений с замером (по умолчанию 15)
+//   --warmup=N       Прогревочных повторений (по умолчанию 2)
+//   --budget=S       Секунд на один замер (по умолчанию 2)
+//   --filter=STR     Только замеры, в имени которых есть STR
+//   --json=FILE      Сохранить результаты в JSON
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <memory>
+
+#include "../bench/BenchHarness.h"
+#include "../common/Graph.h"
+#include "../common/Protocol.h"
+#include "../common/UDPProtocol.h"
+#include "../common/Dijkstra.h"
+#include "../utils/InputParser.h"
+
+using namespace std;
+
+// Размеры графов (рёбер)
+const vector<long long> GRAPH_SIZES = {20, 1000, 100000, 1000000, 10000000};
+// Операций сериализации в одном повторении (одна операция короче разрешения часов)
+const int SERIALIZE_OPS = 1000;
+// Запросов "из точки в точку" в одном повторении
+const int PATH_QUERIES = 16;
+
+// Случайный связный граф с edges рёбрами
+static vector<Edge> generateGraph(long long edges) {
+    mt19937 rng(42);
+    int vertices = static_cast<int>(max(6LL, edges / 4));
+    uniform_int_distribution<int> vertexDist(0, vertices - 1);
+    uniform_int_distribution<int> weightDist(1, 1000);
+
+    vector<Edge> result;
+    result.reserve(static_cast<size_t>(edges));
+    for (int v = 0; v < vertices && static_cast<long long>(result.size()) < edges; v++) {
+        result.push_back({v, (v + 1) % vertices, static_cast<double>(weightDist(rng))});
+    }
+    while (static_cast<long long>(result.size()) < edges) {
+        result.push_back({vertexDist(rng), vertexDist(rng), static_cast<double>(weightDist(rng))});
+    }
+    return result;
+}
+
+// Число вершин графа (наибольший номер + 1)
+static int countVertices(const vector<Edge>& edges) {
+    int vertices = 0;
+    for (const Edge& edge : edges) {
+        vertices = max(vertices, max(edge.from, edge.to) + 1);
+    }
+    return vertices;
+}
+
+// Граф в текстовом формате ввода клиента: "0 1 5, 1 2 7, ..."
+static string graphToText(const vector<Edge>& edges) {
+    string text;
+    text.reserve(edges.size() * 20);
+    for (size_t i = 0; i < edges.size(); i++) {
+        if (i > 0) {
+            text += ", ";
+        }
+        text += to_string(edges[i].from);
+        text += ' ';
+        text += to_string(edges[i].to);
+        text += ' ';
+        text += to_string(static_cast<int>(edges[i].weight));
+    }
+    return text;
+}
+
+// Ответ с путём из length вершин
+static ServerResponse makeResponse(long long length) {
+    ServerResponse response;
+    response.error_code = SUCCESS;
+    response.path.resize(static_cast<size_t>(length));
+    for (long long i = 0; i < length; i++) {
+        response.path[static_cast<size_t>(i)] = static_cast<int>(i);
+    }
+    response.path_length = static_cast<double>(length - 1);
+    return response;
+}
+
+// Замеры на одном размере графа
+static void runGraphSize(BenchRunner& runner, long long size) {
+    vector<Edge> edges = generateGraph(size);
+    int vertices = countVertices(edges);
+
+    // Graph::addEdges: граф пересоздаётся перед каждым повторением,
+    // удаление старого графа во время не входит
+    unique_ptr<Graph> graph;
+    runner.run("graph_add_edges", size, "edges", 1,
+               [&] { graph.reset(new Graph()); },
+               [&](int) { graph->addEdges(edges); });
+    graph.reset();
+
+    bool searchSelected = runner.selected("dijkstra_find_shortest_paths") ||
+                          runner.selected("dijkstra_find_path");
+    if (searchSelected) {
+        Dijkstra dijkstra(vertices);
+        for (const Edge& edge : edges) {
+            dijkstra.addEdge(edge.from, edge.to, edge.weight);
+            dijkstra.addEdge(edge.to, edge.from, edge.weight);
+        }
+
+        mt19937 rng(7);
+        uniform_int_distribution<int> vertexDist(0, vertices - 1);
+        // Каждое повторение выполняет одни и те же запросы: разброс между
+        // повторениями - это шум измерения, а не разная длина путей
+        vector<pair<int, int>> pairs(PATH_QUERIES);
+        for (auto& p : pairs) {
+            p = {vertexDist(rng), vertexDist(rng)};
+        }
+
+        runner.run("dijkstra_find_shortest_paths", size, "edges", 1, nullptr, [&](int) {
+            vector<double> dist = dijkstra.findShortestPaths(pairs[0].first);
+            doNotOptimize(dist);
+        });
+        runner.run("dijkstra_find_path", size, "edges", PATH_QUERIES, nullptr, [&](int) {
+            for (const auto& p : pairs) {
+                pair<double, vector<int>> path = dijkstra.findPath(p.first, p.second);
+                doNotOptimize(path);
+            }
+        });
+    }
+
+    if (runner.selected("input_parser_parse_graph")) {
+        string text = graphToText(edges);
+        vector<InputParser::Edge> parsed;
+        runner.run("input_parser_parse_graph", size, "edges", 1, nullptr, [&](int) {
+            InputParser::parseGraph(text, parsed);
+        });
+    }
+
+    if (runner.selected("udp_parse_packet")) {
+        // Пакет собирается вручную, а не через createDataPacket: GCC 12 с -O2
+        // выдаёт на встроенном vector::insert ложное предупреждение array-bounds
+        vector<char> payload = edgesToBytes(edges);
+        UDPPacketHeader header;
+        header.type = PACKET_DATA;
+        header.packet_id = 1;
+        header.data_len = static_cast<uint32_t>(payload.size());
+        vector<char> packet(sizeof(header) + payload.size());
+        memcpy(packet.data(), &header, sizeof(header));
+        memcpy(packet.data() + sizeof(header), payload.data(), payload.size());
+        long long ops = max(1LL, SERIALIZE_OPS * 16000LL / static_cast<long long>(packet.size()));
+        runner.run("udp_parse_packet", static_cast<long long>(packet.size()), "bytes", ops,
+                   nullptr, [&](int) {
+            for (long long i = 0; i < ops; i++) {
+                auto parsed = UDPProtocol::parsePacket(packet);
+                doNotOptimize(parsed);
+            }
+        });
+    }
+}
+
+// Замеры сериализации запроса и ответа
+static void runSerialization(BenchRunner& runner, long long maxPath) {
+    ClientRequest request = {3, 17};
+    runner.run("request_to_bytes", static_cast<long long>(REQUEST_SIZE), "bytes", SERIALIZE_OPS, nullptr, [&](int) {
+        for (int i = 0; i < SERIALIZE_OPS; i++) {
+            request.start_node = i;
+            vector<char> bytes = requestToBytes(request);
+            doNotOptimize(bytes);
+        }
+    });
+
+    // Длины пути - те же размеры, что у графов
+    for (long long length : GRAPH_SIZES) {
+        if (length > maxPath) {
+            break;
+        }
+        ServerResponse response = makeResponse(length);
+        vector<char> bytes = responseToBytes(response);
+        long long ops = max(1LL, SERIALIZE_OPS * 100LL / length);
+
+        runner.run("response_to_bytes", length, "nodes", ops, nullptr, [&](int) {
+            for (long long i = 0; i < ops; i++) {
+                vector<char> encoded = responseToBytes(response);
+                doNotOptimize(encoded);
+            }
+        });
+        runner.run("bytes_to_response", length, "nodes", ops, nullptr, [&](int) {
+            for (long long i = 0; i < ops; i++) {
+                ServerResponse decoded = bytesToResponse(bytes);
+                doNotOptimize(decoded);
+            }
+        });
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    long long maxEdges = GRAPH_SIZES.back();
+    string jsonPath;
+
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        size_t eq = option.find('=');
+        string key = option.substr(0, eq);
+        string value = eq == string::npos ? "" : option.substr(eq + 1);
+        try {
+            if (key == "--max-edges") {
+                maxEdges = stoll(value);
+            } else if (key == "--reps") {
+                config.repetitions = stoi(value);
+            } else if (key == "--warmup") {
+                config.warmup = stoi(value);
+            } else if (key == "--budget") {
+                config.budgetSeconds = stod(value);
+            } else if (key == "--filter") {
+                config.filter = value;
+            } else if (key == "--json") {
+                jsonPath = value;
+            } else {
+                cout << "Неизвестный параметр: " << option << endl;
+                return 1;
+            }
+        } catch (...) {
+            cout << "Неверное значение параметра: " << option << endl;
+            return 1;
+        }
+    }
+    if (config.repetitions < 1 || config.warmup < 0 || maxEdges < GRAPH_SIZES.front()) {
+        cout << "Неверные параметры запуска" << endl;
+        return 1;
+    }
+    config.minRepetitions = min(config.minRepetitions, config.repetitions);
+
+    BenchRunner runner(config);
+
+    runSerialization(runner, maxEdges);
+    for (long long size : GRAPH_SIZES) {
+        if (size > maxEdges) {
+            break;
+        }
+        runGraphSize(runner, size);
+    }
+
+    if (!jsonPath.empty()) {
+        if (!runner.writeJson(jsonPath)) {
+            cout << "Не удалось записать " << jsonPath << endl;
+            return 1;
+        }
+        cout << "Результаты сохранены в " << jsonPath << endl;
+    }
+    return 0;
+}
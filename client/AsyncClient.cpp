@@ -0,0 +1,482 @@
+#include "../client/AsyncClient.h"
+
+using namespace std;
+
+// Наибольший кадр ответа TCP (как у Client и сервера)
+const uint32_t BUFFER_SIZE = 4096;
+// Сколько байт читать из сокета за раз
+const size_t READ_CHUNK = 64 * 1024;
+// Сколько ждать ответа UDP (как у Client: доставка запроса и ответа)
+const auto UDP_RESPONSE_TIMEOUT = chrono::milliseconds(18000);
+
+// Конструктор
+AsyncClient::AsyncClient(const string& serverIP, int serverPort, const string& protocol, size_t window)
+    : serverIP(serverIP), serverPort(serverPort), protocol(protocol), window(max<size_t>(1, window)),
+      clientSocket(-1), wakeFd(-1), running(false), outstanding(0), outputSent(0) {
+}
+
+// Деструктор
+AsyncClient::~AsyncClient() {
+    disconnect();
+}
+
+// Подключается и запускает поток ввода-вывода
+bool AsyncClient::connect() {
+    if (running) {
+        return true;
+    }
+    if (!openSocket()) {
+        return false;
+    }
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        Logger::error("Не удалось создать eventfd");
+        close(clientSocket);
+        clientSocket = -1;
+        return false;
+    }
+    running = true;
+    ioThread = thread(&AsyncClient::ioLoop, this);
+    return true;
+}
+
+// Создаёт сокет и подключается
+bool AsyncClient::openSocket() {
+    if (isUnixAddress(serverIP)) {
+        if (!SocketAddress::unixPath(unixAddressPath(serverIP), serverAddr)) {
+            Logger::error("Неверный путь Unix-сокета");
+            return false;
+        }
+    } else {
+        sockaddr_in inetAddr;
+        memset(&inetAddr, 0, sizeof(inetAddr));
+        inetAddr.sin_family = AF_INET;
+        inetAddr.sin_port = htons(serverPort);
+        if (inet_pton(AF_INET, serverIP.c_str(), &inetAddr.sin_addr) <= 0) {
+            Logger::error("Неверный IP-адрес");
+            return false;
+        }
+        serverAddr = SocketAddress::inet(inetAddr);
+    }
+
+    int socketType = (protocol == "udp") ? SOCK_DGRAM : SOCK_STREAM;
+    clientSocket = socket(serverAddr.family(), socketType | SOCK_CLOEXEC, 0);
+    if (clientSocket < 0) {
+        Logger::error("Не удалось создать сокет");
+        return false;
+    }
+
+    // Датаграммному Unix-сокету нужно имя, иначе серверу некуда ответить
+    if (protocol == "udp" && serverAddr.family() == AF_UNIX) {
+        sockaddr_un autoAddr;
+        memset(&autoAddr, 0, sizeof(autoAddr));
+        autoAddr.sun_family = AF_UNIX;
+        if (bind(clientSocket, (sockaddr*)&autoAddr, sizeof(sa_family_t)) < 0) {
+            Logger::error("Не удалось получить адрес для Unix-сокета");
+            close(clientSocket);
+            clientSocket = -1;
+            return false;
+        }
+    }
+
+    if (protocol == "udp") {
+        // Окно канала - окно клиента: каждый запрос - один сегмент
+        channel = make_unique<ReliableChannel>(ReliableChannel::newId(),
+                                               RttEstimator::forDestination(serverIP + ":" + to_string(serverPort)),
+                                               window);
+    }
+
+    // UDP тоже подключается: send/recv без адреса, и ядро отбрасывает
+    // пакеты не от сервера
+    if (::connect(clientSocket, serverAddr.get(), serverAddr.length) < 0) {
+        Logger::error("Не удалось подключиться к серверу");
+        close(clientSocket);
+        clientSocket = -1;
+        return false;
+    }
+    if (protocol == "tcp" && serverAddr.family() == AF_INET) {
+        int noDelay = 1;
+        setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    }
+    // Поток ввода-вывода не блокируется на сокете: его ждёт poll
+    int flags = fcntl(clientSocket, F_GETFL, 0);
+    fcntl(clientSocket, F_SETFL, flags | O_NONBLOCK);
+    return true;
+}
+
+// Останавливает поток ввода-вывода
+void AsyncClient::disconnect() {
+    if (ioThread.joinable()) {
+        {
+            lock_guard<mutex> lock(stateMutex);
+            running = false;
+        }
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+        ioThread.join();
+    }
+    running = false;
+    for (int* fd : {&clientSocket, &wakeFd}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    output.clear();
+    outputSent = 0;
+    input.clear();
+}
+
+// Ставит запрос с обратным вызовом
+bool AsyncClient::submit(const ClientRequest& request, const vector<Edge>& edges, Callback callback) {
+    // Запрос собирается вне блокировки: поток ввода-вывода только
+    // переносит готовые байты в сокет
+    Pending pending;
+    pending.callback = move(callback);
+    vector<char> requestData = requestToBytes(request);
+    vector<char> edgesData = edgesToBytes(edges);
+    if (protocol == "udp") {
+        // Заголовок с packet_id добавит поток ввода-вывода
+        pending.data = move(requestData);
+        pending.data.insert(pending.data.end(), edgesData.begin(), edgesData.end());
+    } else {
+        // Два кадра: длина в сетевом порядке и данные
+        for (const vector<char>* frame : {&requestData, &edgesData}) {
+            uint32_t networkSize = htonl(static_cast<uint32_t>(frame->size()));
+            const char* sizeBytes = reinterpret_cast<const char*>(&networkSize);
+            pending.data.insert(pending.data.end(), sizeBytes, sizeBytes + sizeof(networkSize));
+            pending.data.insert(pending.data.end(), frame->begin(), frame->end());
+        }
+    }
+
+    unique_lock<mutex> lock(stateMutex);
+    windowChanged.wait(lock, [this] { return outstanding < window || !running; });
+    if (!running) {
+        return false;
+    }
+    // Будить поток нужно, только если очередь была пуста: иначе он ещё
+    // не забрал её и заберёт вместе с этим запросом
+    bool wasEmpty = submitted.empty();
+    submitted.push_back(move(pending));
+    outstanding++;
+    lock.unlock();
+
+    if (wasEmpty) {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+    return true;
+}
+
+// Ставит запрос с future
+future<ServerResponse> AsyncClient::submit(const ClientRequest& request, const vector<Edge>& edges) {
+    auto promise = make_shared<std::promise<ServerResponse>>();
+    future<ServerResponse> result = promise->get_future();
+    bool queued = submit(request, edges, [promise](bool ok, const ServerResponse& response) {
+        if (ok) {
+            promise->set_value(response);
+        } else {
+            promise->set_exception(make_exception_ptr(runtime_error("ответ сервера не получен")));
+        }
+    });
+    if (!queued) {
+        promise->set_exception(make_exception_ptr(runtime_error("клиент не подключён")));
+    }
+    return result;
+}
+
+// Запросов в полёте
+size_t AsyncClient::inFlight() {
+    lock_guard<mutex> lock(stateMutex);
+    return outstanding;
+}
+
+// Ждёт завершения всех запросов
+void AsyncClient::drain() {
+    unique_lock<mutex> lock(stateMutex);
+    windowChanged.wait(lock, [this] { return outstanding == 0; });
+}
+
+// Главный цикл потока ввода-вывода
+void AsyncClient::ioLoop() {
+    bool tcp = protocol != "udp";
+    while (running) {
+        takeSubmitted();
+        if (tcp && !flushTCP()) {
+            Logger::error("Соединение с сервером потеряно");
+            break;
+        }
+
+        short events = POLLIN;
+        if (tcp && outputSent < output.size()) {
+            events |= POLLOUT;
+        }
+        pollfd fds[2] = {{clientSocket, events, 0}, {wakeFd, POLLIN, 0}};
+        // UDP: просыпаемся точно к ближайшему повтору или отказу
+        int timeout = tcp ? -1 : nextUDPTimeout();
+        int ready = poll(fds, 2, timeout);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            uint64_t value;
+            ssize_t got = read(wakeFd, &value, sizeof(value));
+            (void)got;
+        }
+        if (fds[0].revents != 0) {
+            if (tcp) {
+                if (!readTCP()) {
+                    Logger::error("Соединение с сервером потеряно");
+                    break;
+                }
+            } else {
+                readUDP();
+            }
+        }
+        if (!tcp) {
+            checkUDPTimeouts();
+        }
+    }
+    // Новые запросы больше не принимаются, поставленные завершаются
+    failAll();
+}
+
+// Забирает поставленные запросы
+void AsyncClient::takeSubmitted() {
+    deque<Pending> batch;
+    {
+        lock_guard<mutex> lock(stateMutex);
+        batch.swap(submitted);
+    }
+    for (auto& pending : batch) {
+        if (protocol == "udp") {
+            uint32_t seq = channel->send(pending.data, [this](const vector<char>& packet) {
+                return sendDatagram(packet);
+            });
+            // Сообщение хранит канал (для повторов)
+            pending.data.clear();
+            pending.expiresAt = chrono::steady_clock::now() + UDP_RESPONSE_TIMEOUT;
+            udpInFlight.emplace(seq, move(pending));
+        } else {
+            // Отправленная часть вывода больше не нужна
+            if (outputSent > 0 && outputSent == output.size()) {
+                output.clear();
+                outputSent = 0;
+            }
+            output.insert(output.end(), pending.data.begin(), pending.data.end());
+            pending.data = vector<char>();
+            tcpInFlight.push_back(move(pending));
+        }
+    }
+}
+
+// TCP: дописывает вывод в сокет
+bool AsyncClient::flushTCP() {
+    while (outputSent < output.size()) {
+        ssize_t sent = send(clientSocket, output.data() + outputSent, output.size() - outputSent,
+                            MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return true;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        outputSent += static_cast<size_t>(sent);
+    }
+    output.clear();
+    outputSent = 0;
+    return true;
+}
+
+// TCP: читает и разбирает ответы
+bool AsyncClient::readTCP() {
+    char buffer[READ_CHUNK];
+    while (true) {
+        ssize_t got = recv(clientSocket, buffer, sizeof(buffer), 0);
+        if (got == 0) {
+            return false;
+        }
+        if (got < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        input.insert(input.end(), buffer, buffer + got);
+    }
+
+    // Полные кадры - ответы на запросы в порядке отправки
+    size_t offset = 0;
+    while (input.size() - offset >= sizeof(uint32_t)) {
+        uint32_t networkSize;
+        memcpy(&networkSize, input.data() + offset, sizeof(networkSize));
+        uint32_t dataSize = ntohl(networkSize);
+        if (dataSize > BUFFER_SIZE || tcpInFlight.empty()) {
+            Logger::error("Некорректный ответ сервера");
+            return false;
+        }
+        if (input.size() - offset - sizeof(networkSize) < dataSize) {
+            break;
+        }
+        const char* data = input.data() + offset + sizeof(networkSize);
+        vector<char> responseData(data, data + dataSize);
+        offset += sizeof(networkSize) + dataSize;
+
+        Pending pending = move(tcpInFlight.front());
+        tcpInFlight.pop_front();
+        complete(pending, true, responseData);
+    }
+    input.erase(input.begin(), input.begin() + offset);
+    return true;
+}
+
+// UDP: отправляет пакет канала
+bool AsyncClient::sendDatagram(const vector<char>& packet) {
+    // Ошибка отправки (например, переполнен буфер сокета) - то же, что
+    // потерянный пакет: его повторит канал
+    return send(clientSocket, packet.data(), packet.size(), 0) >= 0;
+}
+
+// UDP: читает пакеты канала
+void AsyncClient::readUDP() {
+    vector<char> packet(64 * 1024);
+    auto sender = [this](const vector<char>& datagram) {
+        return sendDatagram(datagram);
+    };
+    auto deliver = [this](uint32_t, vector<char>& message) {
+        deliverUDP(message);
+    };
+    while (true) {
+        ssize_t got = recv(clientSocket, packet.data(), packet.size(), 0);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // EAGAIN - пакетов больше нет; ECONNREFUSED - сервер ещё не
+            // слушает порт, сегменты будут повторены по таймеру
+            return;
+        }
+        auto [header, payload] = UDPProtocol::parsePacket(vector<char>(packet.begin(), packet.begin() + got));
+        // Пакеты прошлого канала пропускаются
+        channel->receive(header, payload, sender, deliver);
+    }
+}
+
+// UDP: ответ из канала
+void AsyncClient::deliverUDP(vector<char>& message) {
+    // Ответ начинается с номера сегмента запроса
+    uint32_t requestSeq = 0;
+    if (message.size() < sizeof(requestSeq)) {
+        return;
+    }
+    memcpy(&requestSeq, message.data(), sizeof(requestSeq));
+    auto found = udpInFlight.find(requestSeq);
+    if (found == udpInFlight.end()) {
+        // Ответ на запрос, чей срок уже вышел
+        return;
+    }
+    Pending pending = move(found->second);
+    udpInFlight.erase(found);
+    complete(pending, true, vector<char>(message.begin() + sizeof(requestSeq), message.end()));
+}
+
+// UDP: повторы и сроки
+void AsyncClient::checkUDPTimeouts() {
+    channel->onTimer([this](const vector<char>& packet) {
+        return sendDatagram(packet);
+    });
+    if (channel->failed()) {
+        // Сервер не подтверждает сегменты: запросы в полёте завершаются,
+        // следующие пойдут по новому каналу с пустым окном
+        Logger::error("Потеряна связь с сервером");
+        for (auto& [seq, pending] : udpInFlight) {
+            complete(pending, false, {});
+        }
+        udpInFlight.clear();
+        channel = make_unique<ReliableChannel>(ReliableChannel::newId(),
+                                               RttEstimator::forDestination(serverIP + ":" + to_string(serverPort)),
+                                               window);
+        return;
+    }
+
+    auto now = chrono::steady_clock::now();
+    for (auto it = udpInFlight.begin(); it != udpInFlight.end(); ) {
+        if (now >= it->second.expiresAt) {
+            Pending pending = move(it->second);
+            it = udpInFlight.erase(it);
+            complete(pending, false, {});
+        } else {
+            ++it;
+        }
+    }
+}
+
+// UDP: мс до ближайшего таймера или срока
+int AsyncClient::nextUDPTimeout() const {
+    if (udpInFlight.empty() && channel->unacked() == 0) {
+        return -1;
+    }
+    auto nearest = channel->nextDeadline();
+    for (const auto& entry : udpInFlight) {
+        nearest = min(nearest, entry.second.expiresAt);
+    }
+    if (nearest == chrono::steady_clock::time_point::max()) {
+        return -1;
+    }
+    auto now = chrono::steady_clock::now();
+    if (nearest <= now) {
+        return 0;
+    }
+    // Округление вверх: poll не проснётся раньше срока
+    auto remaining = chrono::duration_cast<chrono::microseconds>(nearest - now);
+    return static_cast<int>((remaining.count() + 999) / 1000);
+}
+
+// Завершает запрос
+void AsyncClient::complete(Pending& pending, bool ok, const vector<char>& responseData) {
+    ServerResponse response{};
+    if (ok) {
+        response = bytesToResponse(responseData);
+    }
+    if (pending.callback) {
+        pending.callback(ok, response);
+    }
+    lock_guard<mutex> lock(stateMutex);
+    outstanding--;
+    windowChanged.notify_all();
+}
+
+// Завершает все незавершённые запросы
+void AsyncClient::failAll() {
+    deque<Pending> waiting;
+    {
+        // running сбрасывается под той же блокировкой, под которой submit его
+        // проверяет: запрос, поставленный после обмена очереди, потерялся бы
+        // и drain ждал бы его вечно
+        lock_guard<mutex> lock(stateMutex);
+        running = false;
+        waiting.swap(submitted);
+        windowChanged.notify_all();
+    }
+    for (auto& pending : waiting) {
+        complete(pending, false, {});
+    }
+    while (!tcpInFlight.empty()) {
+        Pending pending = move(tcpInFlight.front());
+        tcpInFlight.pop_front();
+        complete(pending, false, {});
+    }
+    for (auto& [id, pending] : udpInFlight) {
+        complete(pending, false, {});
+    }
+    udpInFlight.clear();
+}
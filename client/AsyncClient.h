@@ -0,0 +1,159 @@
+#ifndef ASYNC_CLIENT_H
+#define ASYNC_CLIENT_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+
+#include "../common/Protocol.h"
+#include "../common/UDPProtocol.h"
+#include "../common/SocketAddress.h"
+#include "../common/RttEstimator.h"
+#include "../common/ReliableChannel.h"
+#include "../utils/Logger.h"
+
+using namespace std;
+
+// Асинхронный клиент: много запросов в полёте через одно подключение
+
+// В отличие от Client::sendRequest, submit не ждёт ответа: запрос
+// ставится в очередь, а фоновый поток ввода-вывода отправляет запросы
+// и разбирает ответы, не дожидаясь каждого по очереди:
+//   - TCP: запросы идут подряд по одному подключению; сервер отвечает на
+//     запросы подключения строго по порядку, поэтому ответ сопоставляется
+//     запросу по месту в очереди (в протоколе TCP нет ID запроса);
+//   - UDP: запросы идут по надёжному каналу (ReliableChannel) с окном
+//     в window сегментов; ответ начинается с номера сегмента запроса -
+//     ответы на параллельно обработанные запросы могут идти в любом
+//     порядке. Потерянные запросы и ответы канал повторяет сам.
+// Окно (window) ограничивает число запросов в полёте: submit ждёт, пока
+// окно заполнено, - так очередь клиента и сервера не растёт без предела.
+
+// Обратные вызовы выполняются в потоке ввода-вывода: они должны быть
+// короткими и не вызывать submit этого же клиента при заполненном окне.
+
+// Окно по умолчанию
+const size_t DEFAULT_ASYNC_WINDOW = 64;
+
+class AsyncClient {
+public:
+    // Результат запроса: ok = false - ответ не получен (нет связи,
+    // таймаут UDP или клиент отключён), response тогда не заполнен
+    using Callback = function<void(bool ok, const ServerResponse& response)>;
+
+    // serverIP IP-адрес сервера или "unix:/путь"
+    // serverPort Порт сервера (не нужен для Unix-сокета)
+    // protocol "tcp" или "udp"
+    // window Наибольшее число запросов в полёте
+    AsyncClient(const string& serverIP, int serverPort, const string& protocol,
+                size_t window = DEFAULT_ASYNC_WINDOW);
+
+    // Деструктор - отключается (незавершённые запросы получают ok = false)
+    ~AsyncClient();
+
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator=(const AsyncClient&) = delete;
+
+    // Подключается и запускает поток ввода-вывода
+    bool connect();
+
+    // Останавливает поток ввода-вывода и закрывает сокет
+    void disconnect();
+
+    // Ставит запрос; callback вызывается в потоке ввода-вывода
+    // false, если клиент не подключён (callback тогда не вызывается)
+    bool submit(const ClientRequest& request, const vector<Edge>& edges, Callback callback);
+
+    // Ставит запрос; future получает ответ или исключение runtime_error
+    future<ServerResponse> submit(const ClientRequest& request, const vector<Edge>& edges);
+
+    // Запросов в полёте (поставлено и ещё не завершено)
+    size_t inFlight();
+
+    // Ждёт завершения всех поставленных запросов
+    void drain();
+
+private:
+    // Запрос в полёте
+    struct Pending {
+        vector<char> data;          // TCP: два кадра подряд; UDP: сообщение канала
+        Callback callback;
+        chrono::steady_clock::time_point expiresAt;  // Срок ответа (UDP)
+    };
+
+    string serverIP;
+    int serverPort;
+    string protocol;
+    size_t window;
+    SocketAddress serverAddr;
+    int clientSocket;
+    int wakeFd;                      // Будит поток ввода-вывода при новом запросе
+    thread ioThread;
+    atomic<bool> running;            // Сбрасывается под stateMutex (см. failAll)
+
+    // Общие с submit (под stateMutex)
+    mutex stateMutex;
+    condition_variable windowChanged;
+    deque<Pending> submitted;        // Поставлены, ещё не отправлены
+    size_t outstanding;              // Поставлены и не завершены
+
+    // Только поток ввода-вывода
+    deque<Pending> tcpInFlight;      // Отправлены, ждут ответа (по порядку)
+    unique_ptr<ReliableChannel> channel;           // Канал к серверу (UDP)
+    unordered_map<uint32_t, Pending> udpInFlight;  // По номеру сегмента запроса
+    vector<char> output;             // TCP: ещё не записанные байты
+    size_t outputSent;
+    vector<char> input;              // TCP: полученные, ещё не разобранные байты
+
+    // Создаёт сокет и подключается
+    bool openSocket();
+
+    // Главный цикл потока ввода-вывода
+    void ioLoop();
+
+    // Забирает поставленные запросы и отправляет их
+    void takeSubmitted();
+
+    // TCP: дописывает в сокет накопленный вывод; false при ошибке
+    bool flushTCP();
+    // TCP: читает и разбирает ответы; false при ошибке или закрытии
+    bool readTCP();
+
+    // UDP: читает пакеты канала (сегменты ответов и подтверждения)
+    void readUDP();
+    // UDP: повторы канала; завершает просроченные запросы
+    void checkUDPTimeouts();
+    // UDP: мс до ближайшего таймера или срока (для poll), -1 - ждать нечего
+    int nextUDPTimeout() const;
+    // UDP: отправляет пакет канала
+    bool sendDatagram(const vector<char>& packet);
+    // UDP: ответ из канала
+    void deliverUDP(vector<char>& message);
+
+    // Завершает запрос и освобождает место в окне
+    void complete(Pending& pending, bool ok, const vector<char>& responseData);
+
+    // Завершает все незавершённые запросы с ok = false
+    void failAll();
+};
+
+#endif
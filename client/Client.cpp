@@ -5,16 +5,16 @@ using namespace std;
 
 // Размер буфера для приёма данных
 const int BUFFER_SIZE = 4096;
-// Таймаут ожидания ACK (3 секунды - требование 2.9.3)
-const int UDP_ACK_TIMEOUT_MS = 3000;
-// Количество попыток отправки (3 раза - требование 2.9.4)
-const int UDP_MAX_ATTEMPTS = 3;
+// Сколько ждать ответа UDP: до 9 секунд на доставку запроса (дольше канал
+// считает связь потерянной) и столько же на обработку и доставку ответа
+const auto UDP_RESPONSE_TIMEOUT = chrono::milliseconds(18000);
+// Таймаут ожидания ответа через общую память
+const int SHM_RESPONSE_TIMEOUT_MS = 5000;
 
 // Конструктор клиента
 Client::Client(const string& serverIP, int serverPort, const string& protocol)
     : serverIP(serverIP), serverPort(serverPort), protocol(protocol), 
-      clientSocket(-1), connected(false), nextPacketId(1) {
-    memset(&serverAddr, 0, sizeof(serverAddr));
+      clientSocket(-1), connected(false), shmEdgesUsed(0) {
 }
 
 // Деструктор
@@ -24,25 +24,51 @@ Client::~Client() {
 
 // Подключается к серверу
 bool Client::connect() {
-    if (!createSocket()) {
-        return false;
+    if (isUnixAddress(serverIP)) {
+        if (!SocketAddress::unixPath(unixAddressPath(serverIP), serverAddr)) {
+            Logger::error("Неверный путь Unix-сокета");
+            return false;
+        }
+    } else {
+        sockaddr_in inetAddr;
+        memset(&inetAddr, 0, sizeof(inetAddr));
+        inetAddr.sin_family = AF_INET;
+        inetAddr.sin_port = htons(serverPort);
+        if (inet_pton(AF_INET, serverIP.c_str(), &inetAddr.sin_addr) <= 0) {
+            Logger::error("Неверный IP-адрес");
+            return false;
+        }
+        serverAddr = SocketAddress::inet(inetAddr);
     }
     
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_port = htons(serverPort);
+    if (protocol == "shm" && serverAddr.family() != AF_UNIX) {
+        Logger::error("Протокол shm работает только через Unix-сокет (unix:/путь)");
+        return false;
+    }
     
-    if (inet_pton(AF_INET, serverIP.c_str(), &serverAddr.sin_addr) <= 0) {
-        Logger::error("Неверный IP-адрес");
-        close(clientSocket);
+    if (!createSocket()) {
         return false;
     }
     
-    if (protocol == "tcp") {
-        if (::connect(clientSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+    if (protocol == "shm") {
+        if (!connectShm()) {
+            close(clientSocket);
+            clientSocket = -1;
+            return false;
+        }
+    } else if (protocol == "tcp") {
+        if (::connect(clientSocket, serverAddr.get(), serverAddr.length) < 0) {
             Logger::error("Не удалось подключиться к серверу");
             close(clientSocket);
+            clientSocket = -1;
             return false;
         }
+        // Запрос - четыре небольших send (длина и данные дважды): без
+        // TCP_NODELAY каждый следующий ждёт ACK сервера (алгоритм Нейгла)
+        if (serverAddr.family() == AF_INET) {
+            int noDelay = 1;
+            setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        }
     }
     
     connected = true;
@@ -56,36 +82,49 @@ void Client::disconnect() {
         close(clientSocket);
         clientSocket = -1;
     }
+    shm.reset();
+    shmUploads.clear();
+    channel.reset();
+    shmEdgesUsed = 0;
     connected = false;
 }
 
 // Создаёт сокет
 bool Client::createSocket() {
-    int socketType = (protocol == "tcp") ? SOCK_STREAM : SOCK_DGRAM;
+    int socketType = (protocol == "udp") ? SOCK_DGRAM : SOCK_STREAM;
     
-    clientSocket = socket(AF_INET, socketType, 0);
+    clientSocket = socket(serverAddr.family(), socketType, 0);
     if (clientSocket < 0) {
         Logger::error("Не удалось создать сокет");
         return false;
     }
     
-    if (protocol == "udp") {
-        // Устанавливаем таймаут для операций сокета
-        struct timeval tv;
-        tv.tv_sec = UDP_ACK_TIMEOUT_MS / 1000;
-        tv.tv_usec = (UDP_ACK_TIMEOUT_MS % 1000) * 1000;
-        
-        if (setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) {
-            Logger::warning("Не удалось установить таймаут для UDP");
+    // Датаграммному Unix-сокету без имени сервер не сможет ответить:
+    // bind с одним только семейством даёт сокету уникальное абстрактное имя
+    if (protocol == "udp" && serverAddr.family() == AF_UNIX) {
+        sockaddr_un autoAddr;
+        memset(&autoAddr, 0, sizeof(autoAddr));
+        autoAddr.sun_family = AF_UNIX;
+        if (bind(clientSocket, (sockaddr*)&autoAddr, sizeof(sa_family_t)) < 0) {
+            Logger::error("Не удалось получить адрес для Unix-сокета");
+            close(clientSocket);
+            clientSocket = -1;
+            return false;
         }
     }
     
+    if (protocol == "udp") {
+        // Таймауты UDP отсчитываются через poll (receiveUDPPacket), а
+        // повторы ведёт канал
+        openChannel();
+    }
+    
     return true;
 }
 
 // Отправляет запрос и получает ответ
 bool Client::sendRequest(const ClientRequest& request, 
-                         const vector<vector<int>>& edges, 
+                         const vector<Edge>& edges, 
                          ServerResponse& response) {
     if (!connected) {
         Logger::error("Не подключён к серверу");
@@ -94,49 +133,35 @@ bool Client::sendRequest(const ClientRequest& request,
     
     // Сериализуем данные для отправки
     vector<char> requestData = requestToBytes(request);
+    vector<char> responseData;
     
-    // Формируем данные о рёбрах
-    vector<char> edgesData;
-    int numEdges = edges.size();
-    edgesData.resize(sizeof(int));
-    memcpy(edgesData.data(), &numEdges, sizeof(int));
-    
-    for (const auto& edge : edges) {
-        if (edge.size() != 2) {
-            Logger::error("Некорректное ребро (должно быть 2 вершины)");
+    if (protocol == "shm") {
+        // Рёбра пишутся прямо в общую память, блок рёбер не собирается
+        if (!exchangeShm(requestData, edges, responseData)) {
             return false;
         }
-        
-        int from = edge[0];
-        int to = edge[1];
-        
-        size_t oldSize = edgesData.size();
-        edgesData.resize(oldSize + 2 * sizeof(int));
-        
-        memcpy(edgesData.data() + oldSize, &from, sizeof(int));
-        memcpy(edgesData.data() + oldSize + sizeof(int), &to, sizeof(int));
+        response = bytesToResponse(responseData);
+        return true;
     }
     
-    // Отправляем данные с подтверждением
-    vector<char> responseData;
+    // Формируем данные о рёбрах (вместе с весами)
+    vector<char> edgesData = edgesToBytes(edges);
     
     if (protocol == "tcp") {
         // TCP: отправляем ДВА отдельных сообщения
         Logger::info("Отправка TCP запроса (2 сообщения)...");
         
         // 1. Отправляем requestData
-        if (!sendTCP(requestData)) {
-            Logger::error("Не удалось отправить requestData по TCP");
-            return false;
-        }
-        Logger::info("requestData отправлен (" + to_string(requestData.size()) + " байт)");
-        
         // 2. Отправляем edgesData
-        if (!sendTCP(edgesData)) {
-            Logger::error("Не удалось отправить edgesData по TCP");
-            return false;
+        // Перегруженный сервер отвечает OVERLOADED сразу после подключения и
+        // закрывает его - тогда отправка не удаётся, но ответ уже лежит в
+        // буфере сокета, поэтому после ошибки отправки ответ всё равно читается
+        if (sendTCP(requestData) && sendTCP(edgesData)) {
+            Logger::info("requestData отправлен (" + to_string(requestData.size()) + " байт)");
+            Logger::info("edgesData отправлен (" + to_string(edgesData.size()) + " байт)");
+        } else {
+            Logger::warning("Не удалось отправить запрос по TCP, проверяем ответ сервера");
         }
-        Logger::info("edgesData отправлен (" + to_string(edgesData.size()) + " байт)");
         
         // 3. Получаем ответ
         if (!receiveTCP(responseData)) {
@@ -154,13 +179,7 @@ bool Client::sendRequest(const ClientRequest& request,
         Logger::info("Начало UDP обмена");
         Logger::info("Размер полезной нагрузки: " + to_string(payload.size()) + " байт");
         
-        if (!sendWithAck(payload)) {
-            return false;
-        }
-        
-        Logger::info("Запрос подтверждён сервером, ожидаем ответ...");
-        
-        if (!receiveResponse(responseData)) {
+        if (!exchangeUDP(payload, responseData)) {
             Logger::error("Не удалось получить ответ от сервера");
             return false;
         }
@@ -173,123 +192,91 @@ bool Client::sendRequest(const ClientRequest& request,
     return true;
 }
 
-// Отправляет данные с подтверждением (надежная UDP-доставка)
-bool Client::sendWithAck(const vector<char>& payload) {
-    uint32_t packet_id = getNextPacketId();
-    vector<char> dataPacket = UDPProtocol::createDataPacket(packet_id, payload);
-    
-    // Пытаемся отправить до 3 раз (требование 2.9.4)
-    for (int attempt = 0; attempt < UDP_MAX_ATTEMPTS; attempt++) {
-        // 1. Отправляем данные
-        if (!sendUDP(dataPacket)) {
-            Logger::warning("Не удалось отправить пакет (попытка " + 
-                           to_string(attempt + 1) + ")");
-            continue;
-        }
-        
-        // 2. Ждём подтверждение (ACK)
-        if (waitForAck(packet_id)) {
-            Logger::info("Пакет подтверждён сервером");
-            return true; // Успех!
+// Открывает новый канал к серверу
+void Client::openChannel() {
+    // Оценка RTT общая для всех клиентов этого сервера в процессе
+    channel = make_unique<ReliableChannel>(ReliableChannel::newId(),
+                                           RttEstimator::forDestination(serverIP + ":" + to_string(serverPort)));
+}
+
+// Запрос и ответ через надёжный канал
+bool Client::exchangeUDP(const vector<char>& payload, vector<char>& responseData) {
+    auto sender = [this](const vector<char>& packet) {
+        return sendUDP(packet);
+    };
+    uint32_t seq = channel->send(payload, sender);
+
+    // Ответ начинается с номера сегмента запроса: ответ на прошлый
+    // запрос (его время уже вышло) пропускаем
+    bool received = false;
+    auto deliver = [&](uint32_t, vector<char>& message) {
+        uint32_t requestSeq = 0;
+        if (message.size() < sizeof(requestSeq)) {
+            return;
         }
-        
-        // 3. ACK не пришёл - логируем и повторяем
-        if (attempt < UDP_MAX_ATTEMPTS - 1) {
-            Logger::warning("Подтверждение не получено, повторная отправка...");
-            this_thread::sleep_for(chrono::milliseconds(100));
+        memcpy(&requestSeq, message.data(), sizeof(requestSeq));
+        if (requestSeq != seq) {
+            Logger::warning("Получен ответ на другой запрос, игнорируем...");
+            return;
         }
-    }
-    
-    // Все попытки исчерпаны
-    Logger::error("Потеряна связь с сервером");
-    return false;
-}
+        responseData.assign(message.begin() + sizeof(requestSeq), message.end());
+        received = true;
+    };
 
-// Ожидает подтверждение (ACK) от сервера
-bool Client::waitForAck(uint32_t expected_packet_id) {
     char buffer[BUFFER_SIZE];
-    sockaddr_in fromAddr;
-    socklen_t fromLen = sizeof(fromAddr);
-    
-    // Пытаемся получить ACK несколько раз
-    for (int attempt = 0; attempt < UDP_MAX_ATTEMPTS; attempt++) {
-        int bytesRead = recvfrom(clientSocket, buffer, sizeof(buffer), 0,
-                                (sockaddr*)&fromAddr, &fromLen);
-        
-        if (bytesRead > 0) {
-            auto [header, payload] = UDPProtocol::parsePacket(
-                vector<char>(buffer, buffer + bytesRead)
-            );
-            
-            Logger::info("Получен пакет: тип=" + to_string(header.type) + 
-                        ", ID=" + to_string(header.packet_id));
-            
-            if (header.type == PACKET_ACK && header.packet_id == expected_packet_id) {
-                Logger::info("Получен ACK для пакета " + to_string(expected_packet_id));
-                return true;
-            } else if (header.type == PACKET_DATA) {
-                // Это не ACK, а уже ответ! Сохраняем его для последующего использования
-                Logger::warning("Получен DATA вместо ACK - сервер отправил ответ слишком быстро");
-                // TODO: Нужно сохранить этот пакет, чтобы не потерять!
-            }
-        } else {
-            Logger::warning("Таймаут ожидания ACK (попытка " + to_string(attempt + 1) + ")");
+    auto giveUpAt = chrono::steady_clock::now() + UDP_RESPONSE_TIMEOUT;
+    while (!received) {
+        if (channel->failed()) {
+            Logger::error("Потеряна связь с сервером");
+            // Следующий запрос пойдёт по новому каналу, с пустым окном
+            openChannel();
+            return false;
         }
-        
-        if (attempt < UDP_MAX_ATTEMPTS - 1) {
-            this_thread::sleep_for(chrono::milliseconds(100));
+        if (chrono::steady_clock::now() >= giveUpAt) {
+            Logger::error("Таймаут ожидания ответа");
+            return false;
         }
+
+        // Ждём пакет до ближайшего таймера повтора
+        int bytesRead = receiveUDPPacket(buffer, sizeof(buffer), min(channel->nextDeadline(), giveUpAt));
+        if (bytesRead < 0) {
+            channel->onTimer(sender);
+            continue;
+        }
+        auto [header, packetPayload] = UDPProtocol::parsePacket(vector<char>(buffer, buffer + bytesRead));
+        // Пакеты прошлого канала пропускаются
+        channel->receive(header, packetPayload, sender, deliver);
     }
-    
-    return false;
+    return true;
 }
 
-// Получает ответ от сервера
-bool Client::receiveResponse(vector<char>& responseData) {
-    char buffer[BUFFER_SIZE];
-    sockaddr_in fromAddr;
-    socklen_t fromLen = sizeof(fromAddr);
-    
-    Logger::info("Ожидание ответа от сервера (до 3 попыток)...");
-    
-    for (int attempt = 0; attempt < UDP_MAX_ATTEMPTS; attempt++) {
-        Logger::info("Попытка " + to_string(attempt + 1) + " получить ответ...");
-        
-        int bytesRead = recvfrom(clientSocket, buffer, sizeof(buffer), 0,
-                                (sockaddr*)&fromAddr, &fromLen);
+// Получает один UDP-пакет до срока
+int Client::receiveUDPPacket(char* buffer, size_t size, chrono::steady_clock::time_point deadline) {
+    while (true) {
+        auto now = chrono::steady_clock::now();
+        if (now >= deadline) {
+            return -1;
+        }
+        // Оставшееся время округляется вверх: poll не проснётся раньше срока
+        auto remaining = chrono::duration_cast<chrono::microseconds>(deadline - now);
+        int timeoutMs = static_cast<int>((remaining.count() + 999) / 1000);
         
-        if (bytesRead > 0) {
-            Logger::info("Получено " + to_string(bytesRead) + " байт");
-            
-            auto [header, payload] = UDPProtocol::parsePacket(
-                vector<char>(buffer, buffer + bytesRead)
-            );
-            
-            Logger::info("Тип пакета: " + to_string(header.type) + ", ID: " + to_string(header.packet_id));
-            
-            if (header.type == PACKET_DATA) {
-                Logger::info("Получен пакет с данными ответа");
-                responseData = payload;
-                return true;
-            } else if (header.type == PACKET_ACK) {
-                Logger::warning("Получен ACK вместо данных, игнорируем...");
-            }
-        } else {
-            Logger::warning("Таймаут при получении данных (попытка " + to_string(attempt + 1) + ")");
+        pollfd pfd = {clientSocket, POLLIN, 0};
+        int ready = poll(&pfd, 1, timeoutMs);
+        if (ready < 0 && errno != EINTR) {
+            return -1;
+        }
+        if (ready <= 0) {
+            continue;
         }
         
-        if (attempt < UDP_MAX_ATTEMPTS - 1) {
-            this_thread::sleep_for(chrono::milliseconds(100));
+        int bytesRead = recvfrom(clientSocket, buffer, size, MSG_DONTWAIT, nullptr, nullptr);
+        if (bytesRead > 0) {
+            return bytesRead;
         }
+        // Ошибка (например, ECONNREFUSED от прошлой отправки) или пустой
+        // пакет - ждём дальше до срока
     }
-    
-    Logger::error("Все попытки получения ответа исчерпаны");
-    return false;
-}
-
-// Получает следующий ID пакета
-uint32_t Client::getNextPacketId() {
-    return nextPacketId.fetch_add(1);
 }
 
 // Проверяет состояние подключения
@@ -302,11 +289,13 @@ bool Client::sendTCP(const vector<char>& data) {
     uint32_t dataSize = data.size();
     uint32_t networkSize = htonl(dataSize);
     
-    if (send(clientSocket, &networkSize, sizeof(networkSize), 0) < 0) {
+    // MSG_NOSIGNAL: если сервер уже закрыл соединение, send вернёт ошибку,
+    // а не завершит клиент сигналом SIGPIPE
+    if (send(clientSocket, &networkSize, sizeof(networkSize), MSG_NOSIGNAL) < 0) {
         return false;
     }
     
-    if (send(clientSocket, data.data(), data.size(), 0) < 0) {
+    if (send(clientSocket, data.data(), data.size(), MSG_NOSIGNAL) < 0) {
         return false;
     }
     
@@ -315,10 +304,11 @@ bool Client::sendTCP(const vector<char>& data) {
 
 // Получает данные по TCP
 bool Client::receiveTCP(vector<char>& data) {
+    // MSG_WAITALL: кадр может прийти несколькими частями
     uint32_t networkSize;
-    int bytesRead = recv(clientSocket, &networkSize, sizeof(networkSize), 0);
+    int bytesRead = recv(clientSocket, &networkSize, sizeof(networkSize), MSG_WAITALL);
     
-    if (bytesRead <= 0) {
+    if (bytesRead != sizeof(networkSize)) {
         return false;
     }
     
@@ -330,9 +320,9 @@ bool Client::receiveTCP(vector<char>& data) {
     }
     
     char buffer[BUFFER_SIZE];
-    bytesRead = recv(clientSocket, buffer, dataSize, 0);
+    bytesRead = recv(clientSocket, buffer, dataSize, MSG_WAITALL);
     
-    if (bytesRead <= 0) {
+    if (bytesRead <= 0 || static_cast<uint32_t>(bytesRead) != dataSize) {
         return false;
     }
     
@@ -343,6 +333,102 @@ bool Client::receiveTCP(vector<char>& data) {
 // Отправляет данные по UDP
 bool Client::sendUDP(const vector<char>& data) {
     int bytesSent = sendto(clientSocket, data.data(), data.size(), 0,
-                          (sockaddr*)&serverAddr, sizeof(serverAddr));
+                          serverAddr.get(), serverAddr.length);
     return bytesSent > 0;
-}
\ No newline at end of file
+}
+
+// Передаёт серверу область общей памяти
+bool Client::connectShm() {
+    if (::connect(clientSocket, serverAddr.get(), serverAddr.length) < 0) {
+        Logger::error("Не удалось подключиться к серверу");
+        return false;
+    }
+    shm = make_unique<ShmChannel>();
+    if (!shm->create(SHM_DEFAULT_EDGE_BYTES) || !shm->sendDescriptors(clientSocket)) {
+        Logger::error("Не удалось создать область общей памяти");
+        shm.reset();
+        return false;
+    }
+    // Сервер подтверждает, что отобразил область; если он перегружен,
+    // подключение просто закрывается
+    char ready = 0;
+    if (recv(clientSocket, &ready, sizeof(ready), 0) != sizeof(ready) || ready != 'R') {
+        Logger::error("Сервер не принял область общей памяти");
+        shm.reset();
+        return false;
+    }
+    return true;
+}
+
+// Выгружает рёбра в область рёбер
+bool Client::uploadEdges(const vector<Edge>& edges, uint64_t& offset, uint64_t& size) {
+    size = edgesByteSize(edges.size());
+    if (size > shm->edgeAreaSize()) {
+        Logger::error("Граф не помещается в область общей памяти");
+        return false;
+    }
+
+    // Хэш зависит от порядка рёбер: блок должен совпасть байт в байт
+    uint64_t key = edges.size();
+    for (const auto& edge : edges) {
+        key = key * 0x100000001b3ULL ^ hashEdge(edge);
+    }
+    auto found = shmUploads.find(key);
+    if (found != shmUploads.end() && found->second.second == size &&
+        edgesEqual(edges, shm->edgeArea() + found->second.first, size)) {
+        offset = found->second.first;
+        return true;
+    }
+
+    // Новый граф - в свободную часть области; когда места нет, область
+    // начинается заново: запросы идут по одному, и сервер уже ответил
+    // на все, что ссылались на старые графы
+    size_t start = (shmEdgesUsed + 7) / 8 * 8;
+    if (start + size > shm->edgeAreaSize()) {
+        shmUploads.clear();
+        start = 0;
+    }
+    writeEdges(edges, shm->edgeArea() + start);
+    shmEdgesUsed = start + size;
+    offset = start;
+    shmUploads[key] = {offset, size};
+    return true;
+}
+
+// Запрос и ответ через общую память
+bool Client::exchangeShm(const vector<char>& requestData, const vector<Edge>& edges,
+                         vector<char>& responseData) {
+    uint64_t offset;
+    uint64_t size;
+    if (!uploadEdges(edges, offset, size)) {
+        return false;
+    }
+
+    // Ответы приходят по порядку, и каждый забирается до следующего
+    // запроса, поэтому ячейка запроса всегда свободна
+    ShmRequestSlot* slot = shm->requestSlot();
+    if (slot == nullptr) {
+        Logger::error("Кольцо запросов общей памяти заполнено");
+        return false;
+    }
+    slot->edgesOffset = offset;
+    slot->edgesSize = size;
+    slot->requestSize = static_cast<uint32_t>(requestData.size());
+    memcpy(slot->request, requestData.data(), min(requestData.size(), REQUEST_SIZE));
+    shm->publishRequest();
+
+    ShmResponseSlot* answer = shm->waitResponse(clientSocket, SHM_RESPONSE_TIMEOUT_MS);
+    if (answer == nullptr) {
+        // Канал больше не годится: опоздавший ответ сервера лёг бы в кольцо
+        // как ответ на следующий запрос, а сервер, возможно, ещё читает
+        // область рёбер, которую перезаписал бы следующий граф
+        Logger::error("Не удалось получить ответ через общую память");
+        disconnect();
+        return false;
+    }
+    size_t answerSize = min<size_t>(answer->size, SHM_RESPONSE_CAPACITY);
+    responseData.assign(answer->data, answer->data + answerSize);
+    shm->releaseResponse();
+    Logger::info("Ответ получен через общую память (" + to_string(responseData.size()) + " байт)");
+    return true;
+}
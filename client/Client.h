@@ -12,9 +12,12 @@
 #include <chrono>
 #include <thread>
 #include <atomic>
+#include <memory>
 #include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
 
@@ -23,19 +26,25 @@
 #include "../utils/Validator.h"
 #include "../utils/InputParser.h"
 #include "../common/UDPProtocol.h"
+#include "../common/SocketAddress.h"
+#include "../common/ShmChannel.h"
+#include "../common/RttEstimator.h"
+#include "../common/ReliableChannel.h"
 
 using namespace std;
 
 // Класс клиента для связи с сервером
 
-// Поддерживает работу по протоколам TCP и UDP
+// Поддерживает работу по протоколам TCP и UDP, а для сервера на этой же
+// машине - через общую память (shm)
 // Отправляет запросы на поиск кратчайшего пути в графе
 class Client {
 public:
     // Конструктор клиента
-    // serverIP IP-адрес сервера (например, "127.0.0.1")
+    // serverIP IP-адрес сервера (например, "127.0.0.1") или
+    //          "unix:/путь" - Unix-сокет сервера на этой же машине (порт не нужен)
     // serverPort Порт сервера (1024-65535)
-    // protocol Тип протокола ("tcp" или "udp")
+    // protocol Тип протокола ("tcp", "udp" или "shm" - только с "unix:/путь")
     Client(const string& serverIP, int serverPort, const string& protocol);
 
     // Деструктор - закрывает соединение
@@ -46,6 +55,7 @@ public:
 
     // Для TCP устанавливает соединение
     // Для UDP просто создаёт сокет (UDP не требует установки соединения)
+    // Для shm подключается к Unix-сокету и передаёт серверу область памяти
     bool connect();
 
     // Отключается от сервера
@@ -70,7 +80,7 @@ public:
     //         cout << "Длина пути: " << response.pathLength << endl;
     //     }
     // }
-    bool sendRequest(const ClientRequest& request, const vector<vector<int>>& edges, ServerResponse& response);
+    bool sendRequest(const ClientRequest& request, const vector<Edge>& edges, ServerResponse& response);
 
     // Проверяет, установлено ли соединение
     // true, если клиент подключён к серверу
@@ -79,32 +89,36 @@ public:
 private:
     string serverIP;             // IP-адрес сервера
     int serverPort;              // Порт сервера
-    string protocol;             // Тип протокола (tcp/udp)
+    string protocol;             // Тип протокола (tcp/udp/shm)
     int clientSocket;            // Дескриптор сокета
-    sockaddr_in serverAddr;      // Адрес сервера
+    SocketAddress serverAddr;    // Адрес сервера (AF_INET или AF_UNIX)
     bool connected;              // Флаг состояния подключения
     
-    // Для надёжной UDP-доставки
-    atomic<uint32_t> nextPacketId;
+    // Надёжный канал к серверу (UDP): повтор до подтверждения в обе стороны
+    unique_ptr<ReliableChannel> channel;
+
+    // Канал в общей памяти (протокол shm)
+    unique_ptr<ShmChannel> shm;
+    // Уже выгруженные в общую память графы: хэш рёбер -> (смещение, размер)
+    map<uint64_t, pair<uint64_t, uint64_t>> shmUploads;
+    // Занято в области рёбер (дальше - свободно)
+    size_t shmEdgesUsed;
 
     // Создаёт сокет клиента
     // true, если сокет успешно создан
     bool createSocket();
     
-    // Отправляет данные с подтверждением (надёжная UDP-доставка)
-    // payload Данные для отправки
-    bool sendWithAck(const vector<char>& payload);
-    
-    // Ожидает подтверждение (ACK) от сервера
-    // expected_packet_id Ожидаемый ID пакета
-    bool waitForAck(uint32_t expected_packet_id);
-    
-    // Получает ответ от сервера
-    // responseData Буфер для полученных данных
-    bool receiveResponse(vector<char>& responseData);
-    
-    // Получает следующий ID пакета
-    uint32_t getNextPacketId();
+    // Открывает новый канал к серверу (ID канала - случайный)
+    void openChannel();
+
+    // Запрос и ответ через надёжный канал (UDP)
+    // payload Запрос и рёбра одним сообщением
+    // responseData Байты ответа (выходной параметр)
+    bool exchangeUDP(const vector<char>& payload, vector<char>& responseData);
+
+    // Получает один UDP-пакет, ожидая не дольше deadline
+    // Число байт или -1, если время вышло
+    int receiveUDPPacket(char* buffer, size_t size, chrono::steady_clock::time_point deadline);
 
     // Отправляет запрос по TCP
     // data Сериализованные данные запроса
@@ -120,6 +134,18 @@ private:
     // data Сериализованные данные запроса
     // true, если отправка успешна
     bool sendUDP(const vector<char>& data);
+
+    // Передаёт серверу область общей памяти и ждёт подтверждения
+    bool connectShm();
+
+    // Рёбра в области рёбер: тот же граф выгружается один раз, дальше
+    // запросы ссылаются на него по смещению
+    // false, если граф не помещается в область
+    bool uploadEdges(const vector<Edge>& edges, uint64_t& offset, uint64_t& size);
+
+    // Запрос и ответ через общую память
+    bool exchangeShm(const vector<char>& requestData, const vector<Edge>& edges,
+                     vector<char>& responseData);
 };
 
 #endif
\ No newline at end of file
@@ -6,15 +6,19 @@ using namespace std;
 // Выводит справку по использованию программы
 void printUsage(const char* programName) {
     cout << "Использование: " << programName << " <IP-адрес> <протокол> <порт>" << endl;
+    cout << "               " << programName << " unix:<путь> <протокол>" << endl;
     cout << endl;
     cout << "Параметры:" << endl;
     cout << "  <IP-адрес>  - IP-адрес сервера (например, 127.0.0.1)" << endl;
-    cout << "  <протокол>  - Тип протокола: tcp или udp" << endl;
+    cout << "  <протокол>  - Тип протокола: tcp, udp или shm (общая память, только с unix:<путь>)" << endl;
     cout << "  <порт>      - Номер порта сервера (1024-65535)" << endl;
+    cout << "  unix:<путь> - Unix-сокет сервера на этой же машине (вместо IP-адреса и порта)" << endl;
     cout << endl;
     cout << "Примеры:" << endl;
     cout << "  " << programName << " 127.0.0.1 tcp 8080" << endl;
     cout << "  " << programName << " 192.168.1.10 udp 12345" << endl;
+    cout << "  " << programName << " unix:/tmp/graph.sock tcp" << endl;
+    cout << "  " << programName << " unix:/tmp/graph.sock shm" << endl;
 }
 
 // Проверяет, является ли ввод ссылкой на файл
@@ -110,6 +114,7 @@ bool validateGraphFile(const string& filename, string& errorMsg) {
 bool processClientRequest(Client& client) {
     // Ввод описания графа или имени файла
     cout << "\nВведите описание графа (формат: A B, B C, C D, ...)" << endl;
+    cout << "вес ребра можно указать третьим числом (A B 2.5), по умолчанию 1" << endl;
     cout << "или имя файла (file:graph.txt или просто graph.txt)" << endl;
     cout << "или 'exit' для завершения работы: ";
     
@@ -151,7 +156,7 @@ bool processClientRequest(Client& client) {
     }
     
     // строковые имена в числовые индексы
-    vector<vector<int>> edges;
+    vector<Edge> edges;
     map<string, int> vertexMap;
     int nextIndex = 0;
     
@@ -165,8 +170,8 @@ bool processClientRequest(Client& client) {
             vertexMap[edge.vertex2] = nextIndex++;
         }
         
-        // Создаём числовое ребро
-        edges.push_back({vertexMap[edge.vertex1], vertexMap[edge.vertex2]});
+        // Создаём числовое ребро (с весом)
+        edges.push_back({vertexMap[edge.vertex1], vertexMap[edge.vertex2], edge.weight});
     }
     
     // Валидация размера графа
@@ -217,7 +222,8 @@ bool processClientRequest(Client& client) {
     
     // 5. Обрабатываем ответ
     if (response.error_code == SUCCESS) {
-        cout << "\nРезультат: " << response.path.size() - 1 << endl;
+        // Длина пути = сумма весов (для невзвешенного графа - число рёбер)
+        cout << "\nРезультат: " << formatPathLength(response.path_length) << endl;
         
         // Создаём обратный словарь (индекс -> имя)
         map<int, string> indexToName;
@@ -247,6 +253,10 @@ bool processClientRequest(Client& client) {
         Logger::error("Путь между вершинами не существует");
     } else if (response.error_code == INVALID_REQUEST) {
         Logger::error("Неверный запрос");
+    } else if (response.error_code == OVERLOADED) {
+        Logger::error("Сервер перегружен, повторите запрос позже");
+    } else if (response.error_code == DEADLINE_EXCEEDED) {
+        Logger::error("Сервер не успел обработать запрос в срок");
     } else {
         Logger::error("Неизвестная ошибка");
     }
@@ -256,8 +266,9 @@ bool processClientRequest(Client& client) {
 
 // Главная функция клиента
 int main(int argc, char* argv[]) {
-    // Проверяем количество аргументов
-    if (argc != 4) {
+    // Проверяем количество аргументов (у Unix-сокета порта нет)
+    bool unixSocket = argc >= 2 && isUnixAddress(argv[1]);
+    if (argc != (unixSocket ? 3 : 4)) {
         Logger::error("Неверное количество аргументов");
         printUsage(argv[0]);
         return 1;
@@ -271,27 +282,40 @@ int main(int argc, char* argv[]) {
     transform(protocol.begin(), protocol.end(), protocol.begin(), ::tolower);
     
     // Парсим порт
-    int port;
-    try {
-        port = stoi(argv[3]);
-    } catch (...) {
-        Logger::error("Порт должен быть числом");
-        printUsage(argv[0]);
-        return 1;
+    int port = 0;
+    if (!unixSocket) {
+        try {
+            port = stoi(argv[3]);
+        } catch (...) {
+            Logger::error("Порт должен быть числом");
+            printUsage(argv[0]);
+            return 1;
+        }
     }
     
     // Валидация параметров
-    if (!Validator::isValidIP(serverIP)) {
+    if (unixSocket) {
+        SocketAddress unixAddr;
+        if (!SocketAddress::unixPath(unixAddressPath(serverIP), unixAddr)) {
+            Logger::error("Путь Unix-сокета пустой или слишком длинный");
+            return 1;
+        }
+    } else if (!Validator::isValidIP(serverIP)) {
         Logger::error("Неверный формат IP-адреса");
         return 1;
     }
     
-    if (!Validator::isValidProtocol(protocol)) {
-        Logger::error("Протокол должен быть tcp или udp");
+    // shm - общая память с сервером на этой же машине, только через Unix-сокет
+    if (protocol == "shm" && !unixSocket) {
+        Logger::error("Протокол shm работает только с unix:<путь>");
+        return 1;
+    }
+    if (protocol != "shm" && !Validator::isValidProtocol(protocol)) {
+        Logger::error("Протокол должен быть tcp, udp или shm");
         return 1;
     }
     
-    if (!Validator::isValidPort(port)) {
+    if (!unixSocket && !Validator::isValidPort(port)) {
         Logger::error("Порт должен быть в диапазоне 1024-65535");
         return 1;
     }
@@ -0,0 +1,202 @@
+#include "../client/PooledClient.h"
+
+using namespace std;
+
+// Точек каждого сервера на кольце: чем больше, тем ровнее делятся графы
+const int VIRTUAL_NODES = 64;
+// Сколько ошибок подряд исключают сервер
+const int EJECT_AFTER_FAILURES = 3;
+// Время исключения: первое и наибольшее (удваивается после неудачной пробы)
+const chrono::milliseconds EJECT_COOLDOWN(1000);
+const chrono::milliseconds MAX_EJECT_COOLDOWN(30000);
+
+// Хэш точки кольца: FNV-1a по адресу и номеру точки, затем перемешивание
+// (у соседних номеров иначе были бы близкие хэши и точки шли бы подряд)
+static uint64_t ringPoint(const string& name, int index) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (char c : name + "#" + to_string(index)) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3ULL;
+    }
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+    return hash ^ (hash >> 31);
+}
+
+// Конструктор
+PooledClient::PooledClient(const vector<string>& endpointList, const string& protocol)
+    : protocol(protocol) {
+    for (const string& name : endpointList) {
+        string address;
+        int port = 0;
+        if (!parseEndpoint(name, address, port)) {
+            Logger::error("Неверный адрес сервера: " + name);
+            continue;
+        }
+        Endpoint endpoint;
+        endpoint.name = name;
+        endpoint.client = make_unique<Client>(address, port, protocol);
+        endpoints.push_back(move(endpoint));
+    }
+    for (size_t i = 0; i < endpoints.size(); i++) {
+        for (int v = 0; v < VIRTUAL_NODES; v++) {
+            ring[ringPoint(endpoints[i].name, v)] = i;
+        }
+    }
+}
+
+// Разбирает адрес сервера
+bool PooledClient::parseEndpoint(const string& endpoint, string& address, int& port) {
+    if (isUnixAddress(endpoint)) {
+        address = endpoint;
+        port = 0;
+        return !unixAddressPath(endpoint).empty();
+    }
+    size_t colon = endpoint.rfind(':');
+    if (colon == string::npos) {
+        return false;
+    }
+    address = endpoint.substr(0, colon);
+    try {
+        port = stoi(endpoint.substr(colon + 1));
+    } catch (...) {
+        return false;
+    }
+    return Validator::isValidIP(address) && Validator::isValidPort(port);
+}
+
+// Подключается ко всем серверам
+bool PooledClient::connect() {
+    for (auto& endpoint : endpoints) {
+        if (endpoint.client->connect()) {
+            markHealthy(endpoint);
+        } else {
+            // Недоступный сервер сразу исключается до первой пробы
+            endpoint.failures = EJECT_AFTER_FAILURES - 1;
+            markFailed(endpoint);
+        }
+    }
+    return isConnected();
+}
+
+// Отключается от всех серверов
+void PooledClient::disconnect() {
+    for (auto& endpoint : endpoints) {
+        endpoint.client->disconnect();
+    }
+}
+
+// Отправляет запрос
+bool PooledClient::sendRequest(const ClientRequest& request, const vector<Edge>& edges,
+                               ServerResponse& response) {
+    uint64_t graphHash = hashGraph(edges);
+    vector<bool> tried(endpoints.size(), false);
+
+    // Каждый сервер - не больше одной попытки на запрос
+    for (size_t attempt = 0; attempt < endpoints.size(); attempt++) {
+        size_t index = route(graphHash, tried);
+        if (index == endpoints.size()) {
+            break;
+        }
+        tried[index] = true;
+        Endpoint& endpoint = endpoints[index];
+
+        // Подключение могло быть закрыто после ошибки - открываем заново
+        bool ok = (endpoint.client->isConnected() || endpoint.client->connect()) &&
+                  endpoint.client->sendRequest(request, edges, response);
+        if (ok) {
+            endpoint.requests++;
+            markHealthy(endpoint);
+            return true;
+        }
+        markFailed(endpoint);
+    }
+    Logger::error("Ни один сервер не ответил");
+    return false;
+}
+
+// Есть ли сервер в кольце
+bool PooledClient::isConnected() const {
+    return healthyEndpoints() > 0;
+}
+
+// Сервер для графа
+string PooledClient::endpointFor(const vector<Edge>& edges) {
+    size_t index = route(hashGraph(edges), vector<bool>(endpoints.size(), false));
+    return index == endpoints.size() ? string() : endpoints[index].name;
+}
+
+size_t PooledClient::endpointCount() const {
+    return endpoints.size();
+}
+
+size_t PooledClient::healthyEndpoints() const {
+    size_t count = 0;
+    for (const auto& endpoint : endpoints) {
+        if (!endpoint.ejected) {
+            count++;
+        }
+    }
+    return count;
+}
+
+const string& PooledClient::endpointName(size_t index) const {
+    return endpoints[index].name;
+}
+
+uint64_t PooledClient::endpointRequests(size_t index) const {
+    return endpoints[index].requests;
+}
+
+// Сервер для хэша графа
+size_t PooledClient::route(uint64_t graphHash, const vector<bool>& tried) {
+    if (ring.empty()) {
+        return endpoints.size();
+    }
+    auto now = chrono::steady_clock::now();
+    // Обход кольца по часовой стрелке от хэша графа (с переходом через ноль)
+    auto it = ring.lower_bound(graphHash);
+    for (size_t step = 0; step < ring.size(); step++, ++it) {
+        if (it == ring.end()) {
+            it = ring.begin();
+        }
+        size_t index = it->second;
+        if (!tried[index] && available(endpoints[index], now)) {
+            return index;
+        }
+    }
+    return endpoints.size();
+}
+
+// Доступен ли сервер
+bool PooledClient::available(const Endpoint& endpoint, chrono::steady_clock::time_point now) const {
+    return !endpoint.ejected || now >= endpoint.retryAt;
+}
+
+// Успешный запрос
+void PooledClient::markHealthy(Endpoint& endpoint) {
+    if (endpoint.ejected) {
+        Logger::info("Сервер " + endpoint.name + " снова в кольце");
+    }
+    endpoint.ejected = false;
+    endpoint.failures = 0;
+    endpoint.cooldown = chrono::milliseconds(0);
+}
+
+// Ошибка запроса
+void PooledClient::markFailed(Endpoint& endpoint) {
+    // После ошибки состояние подключения неизвестно - следующий запрос откроет новое
+    endpoint.client->disconnect();
+    endpoint.failures++;
+    if (endpoint.ejected) {
+        // Проба не удалась: исключаем на вдвое большее время
+        endpoint.cooldown = min(endpoint.cooldown * 2, MAX_EJECT_COOLDOWN);
+    } else if (endpoint.failures >= EJECT_AFTER_FAILURES) {
+        endpoint.ejected = true;
+        endpoint.cooldown = EJECT_COOLDOWN;
+        Logger::warning("Сервер " + endpoint.name + " исключён из кольца на " +
+                        to_string(endpoint.cooldown.count()) + " мс");
+    } else {
+        return;
+    }
+    endpoint.retryAt = chrono::steady_clock::now() + endpoint.cooldown;
+}
@@ -0,0 +1,103 @@
+#ifndef POOLED_CLIENT_H
+#define POOLED_CLIENT_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+
+#include "../client/Client.h"
+#include "../common/Protocol.h"
+#include "../common/SocketAddress.h"
+#include "../utils/Logger.h"
+#include "../utils/Validator.h"
+
+using namespace std;
+
+// Клиент нескольких серверов: запросы распределяются по серверам
+
+// Серверов может быть несколько (например, по процессу на группу ядер).
+// К каждому держится постоянное подключение (свой Client), а сервер для
+// запроса выбирается согласованным хэшированием хэша графа: запросы к
+// одному графу всегда идут на один сервер, и его кэш ответов и хранилище
+// графов работают так же, как с одним сервером.
+
+// Кольцо хэшей: у каждого сервера VIRTUAL_NODES точек на кольце, граф
+// достаётся первому серверу по часовой стрелке от хэша графа. Если сервер
+// выпадает, его графы расходятся по соседям, а графы остальных серверов
+// остаются на месте.
+
+// Неисправные серверы: после нескольких ошибок подряд сервер исключается
+// на время (оно удваивается при каждой неудачной пробе), его запросы идут
+// к следующему серверу на кольце. По истечении времени один запрос идёт
+// на исключённый сервер как проба: успех возвращает сервер в кольцо.
+
+// Как и Client, объект не потокобезопасный: по одному на поток.
+
+class PooledClient {
+public:
+    // endpoints Адреса серверов: "IP:порт" или "unix:/путь"
+    // protocol Тип протокола ("tcp", "udp" или "shm")
+    PooledClient(const vector<string>& endpoints, const string& protocol);
+
+    // Разбирает адрес сервера "IP:порт" или "unix:/путь"
+    // false, если адрес неверный
+    static bool parseEndpoint(const string& endpoint, string& address, int& port);
+
+    // Подключается ко всем серверам
+    // true, если подключён хотя бы один (остальные исключаются до пробы)
+    bool connect();
+
+    // Отключается от всех серверов
+    void disconnect();
+
+    // Отправляет запрос на сервер графа (при ошибке - на следующий по кольцу)
+    // true, если какой-то сервер ответил
+    bool sendRequest(const ClientRequest& request, const vector<Edge>& edges, ServerResponse& response);
+
+    // Есть ли хоть один сервер, не исключённый из кольца
+    bool isConnected() const;
+
+    // Адрес сервера, на который сейчас ушёл бы запрос с этим графом
+    // (пусто, если все исключены)
+    string endpointFor(const vector<Edge>& edges);
+
+    // Число серверов и сколько из них в кольце
+    size_t endpointCount() const;
+    size_t healthyEndpoints() const;
+
+    // Адрес сервера и сколько запросов он обслужил
+    const string& endpointName(size_t index) const;
+    uint64_t endpointRequests(size_t index) const;
+
+private:
+    struct Endpoint {
+        string name;                  // Адрес, как задан
+        unique_ptr<Client> client;    // Постоянное подключение
+        int failures = 0;             // Ошибок подряд
+        bool ejected = false;         // Исключён из кольца
+        chrono::steady_clock::time_point retryAt;  // Когда пробовать снова
+        chrono::milliseconds cooldown{0};          // Текущее время исключения
+        uint64_t requests = 0;        // Обслужено запросов
+    };
+
+    string protocol;
+    vector<Endpoint> endpoints;
+    // Кольцо: точка -> номер сервера
+    map<uint64_t, size_t> ring;
+
+    // Сервер для хэша графа, пропуская уже опробованные (tried)
+    // endpoints.size(), если подходящего нет
+    size_t route(uint64_t graphHash, const vector<bool>& tried);
+
+    // Доступен ли сервер сейчас (в кольце или пора пробовать)
+    bool available(const Endpoint& endpoint, chrono::steady_clock::time_point now) const;
+
+    // Учитывает успех и ошибку запроса к серверу
+    void markHealthy(Endpoint& endpoint);
+    void markFailed(Endpoint& endpoint);
+};
+
+#endif
@@ -0,0 +1,386 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include <vector>
+#include <queue>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+#include "../common/Dijkstra.h"
+#include "../common/DaryHeap.h"
+
+using namespace std;
+
+// Иерархия сжатий (Contraction Hierarchies, CH)
+
+// Принцип работы:
+
+// Предобработка. Вершины по очереди "сжимаются" (удаляются из графа)
+// от наименее важных к наиболее важным. Номер вершины в этом порядке - её ранг.
+// Если при удалении v кратчайший путь u -> v -> w пропадает (нет другого
+// пути u -> w не длиннее, "свидетеля"), добавляем ребро-ярлык (shortcut)
+// u -> w с весом d(u, v) + d(v, w) и запоминаем, что внутри него лежит v.
+
+// Порядок: важность вершины = удвоенная разность рёбер (сколько ярлыков
+// придётся добавить минус сколько рёбер удалится) + число уже сжатых соседей.
+// Важность пересчитывается лениво: достаём вершину с минимальной важностью,
+// пересчитываем, и если она перестала быть минимальной - кладём обратно.
+
+// Запрос. В построенной иерархии любой кратчайший путь можно пройти так:
+// сначала только "вверх" по рангам от start, потом только "вниз" к end.
+// Поэтому запускаем два поиска, оба только по рёбрам вверх: от start и от end.
+// Они встречаются в самой важной вершине пути. Каждый поиск видит
+// лишь малую часть графа - на дорожных сетях это сотни вершин из миллионов.
+
+// Распаковка. Найденный путь состоит из ярлыков; каждый ярлык (a, b)
+// с промежуточной вершиной m заменяем на (a, m) + (m, b), пока не останутся
+// только исходные рёбра.
+
+class ContractionHierarchy {
+public:
+    // Ребро иерархии
+    struct Arc {
+        int to;          // Куда ведёт ребро
+        double weight;   // Вес (для ярлыка - сумма весов заменённых рёбер)
+        int middle;      // Промежуточная вершина ярлыка (-1 для исходного ребра)
+    };
+
+private:
+    int n = 0;
+    vector<int> rank;           // rank[v] = порядковый номер сжатия вершины v
+    vector<vector<Arc>> up;     // up[v] = рёбра от v к вершинам с большим рангом
+
+    // Сколько вершин может обработать поиск свидетеля. Если свидетель не найден
+    // за это время, ярлык добавляется "на всякий случай" - это не ломает
+    // корректность, только немного увеличивает иерархию.
+    // Для оценки важности хватает грубого поиска, при сжатии ищем тщательнее
+    static const int ESTIMATE_SETTLE_LIMIT = 50;
+    static const int CONTRACT_SETTLE_LIMIT = 500;
+
+    // Добавляет ребро u -> w или уменьшает вес уже существующего
+    static void addOrUpdate(vector<vector<Arc>>& adj, int u, int w, double weight, int middle) {
+        for (Arc& arc : adj[u]) {
+            if (arc.to == w) {
+                if (weight < arc.weight) {
+                    arc.weight = weight;
+                    arc.middle = middle;
+                }
+                return;
+            }
+        }
+        adj[u].push_back({w, weight, middle});
+    }
+
+    // Ребро между a и b хранится у вершины с меньшим рангом
+    const Arc* findArc(int a, int b) const {
+        int low = rank[a] < rank[b] ? a : b;
+        int high = low == a ? b : a;
+        for (const Arc& arc : up[low]) {
+            if (arc.to == high) {
+                return &arc;
+            }
+        }
+        return nullptr;
+    }
+
+    // Заменяет ребро (a, b) иерархии исходными рёбрами и дописывает вершины в path
+    // (без a, она уже в пути). Стек вместо рекурсии - ярлыки могут быть глубокими
+    void unpack(int a, int b, vector<int>& path) const {
+        vector<pair<int, int>> stack;
+        stack.push_back({a, b});
+        while (!stack.empty()) {
+            pair<int, int> segment = stack.back();
+            stack.pop_back();
+            const Arc* arc = findArc(segment.first, segment.second);
+            if (arc == nullptr || arc->middle < 0) {
+                path.push_back(segment.second);
+                continue;
+            }
+            // Сначала обработаем (a, m), потом (m, b)
+            stack.push_back({arc->middle, segment.second});
+            stack.push_back({segment.first, arc->middle});
+        }
+    }
+
+public:
+    ContractionHierarchy() {}
+
+    // Построена ли иерархия
+    bool empty() const {
+        return n == 0;
+    }
+
+    // Сколько всего рёбер (исходных и ярлыков) в иерархии
+    size_t arcCount() const {
+        size_t count = 0;
+        for (const auto& arcs : up) {
+            count += arcs.size();
+        }
+        return count;
+    }
+
+    // Строит иерархию по графу
+    // graph Граф (неориентированный: каждое ребро добавлено в обе стороны)
+    // cancelled (необязательно) - функция, которая говорит, что построение пора прервать
+    // false, если построение прервано
+    bool build(const Dijkstra& graph, const function<bool()>& cancelled = nullptr) {
+        int count = graph.getVertexCount();
+
+        // Рабочий граф: параллельные рёбра схлопываются в самое лёгкое
+        vector<vector<Arc>> adj(count);
+        for (int u = 0; u < count; u++) {
+            const vector<int>& neighbors = graph.getNeighbors(u);
+            const vector<double>& weights = graph.getWeights(u);
+            for (size_t i = 0; i < neighbors.size(); i++) {
+                if (neighbors[i] != u) {
+                    addOrUpdate(adj, u, neighbors[i], weights[i], -1);
+                }
+            }
+        }
+
+        vector<char> contracted(count, 0);
+        vector<int> deletedNeighbors(count, 0);
+        vector<int> order(count, 0);
+        vector<vector<Arc>> upward(count);
+
+        // Общие буферы поиска свидетелей (очищаются по списку затронутых вершин)
+        vector<double> witnessDist(count, INF);
+        vector<int> touched;
+        vector<char> isTarget(count, 0);
+        DaryHeap<4> heap(count);
+
+        // Поиск свидетелей от u в графе без v; возвращает число нужных ярлыков
+        // и, если apply = true, добавляет их
+        auto processVertex = [&](int v, bool apply) {
+            // Живые соседи v
+            vector<Arc> neighbors;
+            for (const Arc& arc : adj[v]) {
+                if (!contracted[arc.to]) {
+                    neighbors.push_back(arc);
+                }
+            }
+
+            int shortcuts = 0;
+            for (size_t i = 0; i < neighbors.size(); i++) {
+                int u = neighbors[i].to;
+
+                // Дальше самого длинного пути через v искать не нужно
+                double limit = 0;
+                for (size_t j = i + 1; j < neighbors.size(); j++) {
+                    limit = max(limit, neighbors[i].weight + neighbors[j].weight);
+                }
+                if (i + 1 == neighbors.size()) {
+                    break;
+                }
+
+                // Цели поиска - соседи v после u; когда все они обработаны, можно остановиться
+                int targetsLeft = 0;
+                for (size_t j = i + 1; j < neighbors.size(); j++) {
+                    if (!isTarget[neighbors[j].to]) {
+                        isTarget[neighbors[j].to] = 1;
+                        targetsLeft++;
+                    }
+                }
+
+                // Ограниченная Дейкстра от u, вершина v и сжатые вершины запрещены
+                witnessDist[u] = 0;
+                touched.push_back(u);
+                heap.pushOrDecrease(u, 0);
+                int settled = 0;
+                int settleLimit = apply ? CONTRACT_SETTLE_LIMIT : ESTIMATE_SETTLE_LIMIT;
+                while (!heap.empty() && settled < settleLimit && targetsLeft > 0) {
+                    int x = heap.pop();
+                    settled++;
+                    if (witnessDist[x] > limit) {
+                        break;
+                    }
+                    if (isTarget[x]) {
+                        isTarget[x] = 0;
+                        targetsLeft--;
+                    }
+                    for (const Arc& arc : adj[x]) {
+                        if (arc.to == v || contracted[arc.to]) {
+                            continue;
+                        }
+                        double candidate = witnessDist[x] + arc.weight;
+                        if (candidate < witnessDist[arc.to]) {
+                            if (witnessDist[arc.to] == INF) {
+                                touched.push_back(arc.to);
+                            }
+                            witnessDist[arc.to] = candidate;
+                            heap.pushOrDecrease(arc.to, candidate);
+                        }
+                    }
+                }
+
+                // Пары (u, w) с w после u в списке, чтобы не считать каждую пару дважды
+                for (size_t j = i + 1; j < neighbors.size(); j++) {
+                    int w = neighbors[j].to;
+                    double viaV = neighbors[i].weight + neighbors[j].weight;
+                    if (witnessDist[w] > viaV) {
+                        shortcuts++;
+                        if (apply) {
+                            addOrUpdate(adj, u, w, viaV, v);
+                            addOrUpdate(adj, w, u, viaV, v);
+                        }
+                    }
+                }
+
+                for (size_t j = i + 1; j < neighbors.size(); j++) {
+                    isTarget[neighbors[j].to] = 0;
+                }
+                heap.clear();
+                for (int x : touched) {
+                    witnessDist[x] = INF;
+                }
+                touched.clear();
+            }
+
+            return make_pair(shortcuts, static_cast<int>(neighbors.size()));
+        };
+
+        auto importance = [&](int v) {
+            pair<int, int> sim = processVertex(v, false);
+            // Разность рёбер важнее: вершины, после которых граф становится
+            // плотнее, должны оказаться наверху иерархии
+            return 2 * (sim.first - sim.second) + deletedNeighbors[v];
+        };
+
+        // Очередь вершин по важности (min-куча)
+        typedef pair<int, int> Item;  // (важность, вершина)
+        priority_queue<Item, vector<Item>, greater<Item>> queue;
+        for (int v = 0; v < count; v++) {
+            queue.push({importance(v), v});
+        }
+
+        int nextRank = 0;
+        while (!queue.empty()) {
+            if (cancelled && (nextRank & 255) == 0 && cancelled()) {
+                return false;
+            }
+
+            Item top = queue.top();
+            queue.pop();
+            int v = top.second;
+
+            // Ленивое обновление: важность могла вырасти после сжатия соседей
+            int current = importance(v);
+            if (!queue.empty() && current > queue.top().first) {
+                queue.push({current, v});
+                continue;
+            }
+
+            // Рёбра к ещё не сжатым вершинам станут рёбрами "вверх"
+            for (const Arc& arc : adj[v]) {
+                if (!contracted[arc.to]) {
+                    upward[v].push_back(arc);
+                    deletedNeighbors[arc.to]++;
+                }
+            }
+            processVertex(v, true);
+            contracted[v] = 1;
+            order[v] = nextRank++;
+
+            // Убираем v из списков соседей, чтобы поиски свидетелей
+            // не просматривали рёбра к уже сжатым вершинам
+            for (const Arc& arc : adj[v]) {
+                vector<Arc>& back = adj[arc.to];
+                for (size_t k = 0; k < back.size(); k++) {
+                    if (back[k].to == v) {
+                        back[k] = back.back();
+                        back.pop_back();
+                        break;
+                    }
+                }
+            }
+            vector<Arc>().swap(adj[v]);
+        }
+
+        n = count;
+        rank.swap(order);
+        up.swap(upward);
+        return true;
+    }
+
+    // Поиск кратчайшего пути (два поиска вверх по иерархии)
+    // Возвращает длину пути и сам путь (как Dijkstra::findPath)
+    pair<double, vector<int>> findPath(int start, int end, SearchStats* stats = nullptr) const {
+        SearchStats localStats;
+        SearchStats& st = stats ? *stats : localStats;
+
+        // Прямой и обратный поиск - в двух рабочих памятях потока
+        SearchWorkspace* ws[2] = {&SearchWorkspace::local(0), &SearchWorkspace::local(1)};
+        ws[0]->begin(n);
+        ws[1]->begin(n);
+        DaryHeap<4>* heaps[2] = {&ws[0]->dary, &ws[1]->dary};
+
+        ws[0]->set(start, 0, -1);
+        ws[1]->set(end, 0, -1);
+        heaps[0]->pushOrDecrease(start, 0);
+        heaps[1]->pushOrDecrease(end, 0);
+
+        double best = INF;
+        int meeting = -1;
+
+        while (!heaps[0]->empty() || !heaps[1]->empty()) {
+            // Выбираем направление с меньшим ключом
+            int side;
+            if (heaps[0]->empty()) {
+                side = 1;
+            } else if (heaps[1]->empty()) {
+                side = 0;
+            } else {
+                side = heaps[0]->minKey() <= heaps[1]->minKey() ? 0 : 1;
+            }
+
+            // Дальше расстояния только растут - лучше уже не будет
+            if (heaps[side]->minKey() >= best) {
+                heaps[side]->clear();
+                continue;
+            }
+
+            int u = heaps[side]->pop();
+            st.settled++;
+
+            double through = ws[0]->getDist(u) + ws[1]->getDist(u);
+            if (through < best) {
+                best = through;
+                meeting = u;
+            }
+
+            for (const Arc& arc : up[u]) {
+                double candidate = ws[side]->dist[u] + arc.weight;
+                if (candidate < ws[side]->getDist(arc.to)) {
+                    ws[side]->set(arc.to, candidate, u);
+                    heaps[side]->pushOrDecrease(arc.to, candidate);
+                }
+            }
+        }
+
+        vector<int> path;
+        if (meeting < 0) {
+            return {INF, path};
+        }
+
+        // Путь в иерархии: start ... meeting ... end
+        vector<int> hierarchyPath;
+        for (int v = meeting; v != -1; v = ws[0]->getParent(v)) {
+            hierarchyPath.push_back(v);
+        }
+        reverse(hierarchyPath.begin(), hierarchyPath.end());
+        for (int v = ws[1]->getParent(meeting); v != -1; v = ws[1]->getParent(v)) {
+            hierarchyPath.push_back(v);
+        }
+
+        // Распаковываем ярлыки в исходные рёбра
+        path.push_back(hierarchyPath[0]);
+        for (size_t i = 0; i + 1 < hierarchyPath.size(); i++) {
+            unpack(hierarchyPath[i], hierarchyPath[i + 1], path);
+        }
+
+        return {best, path};
+    }
+};
+
+#endif // CONTRACTION_HIERARCHY_H
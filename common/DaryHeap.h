@@ -0,0 +1,137 @@
+#ifndef DARY_HEAP_H
+#define DARY_HEAP_H
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+// D-арная индексированная куча (по умолчанию 4-арная) для дробных весов
+
+// Принцип работы:
+
+// Обычная двоичная куча, только у каждого узла D детей, а не 2.
+// Дерево получается ниже (log_D n уровней), поэтому просеивание вверх
+// при уменьшении ключа (самая частая операция в Дейкстре) короче,
+// а дети узла лежат в памяти рядом - меньше промахов кэша.
+
+// "Индексированная" - для каждой вершины помним её позицию в куче,
+// поэтому ключ уже лежащей в куче вершины можно уменьшить на месте
+// (decrease-key), а не класть в кучу дубликат.
+
+template <int D = 4>
+class DaryHeap {
+private:
+    vector<int> heap;       // heap[i] = вершина на позиции i
+    vector<double> keys;    // keys[v] = текущий ключ вершины v
+    vector<int> position;   // position[v] = позиция v в heap (-1, если v нет в куче)
+
+    // Поднимает элемент с позиции i, пока родитель больше
+    void siftUp(size_t i) {
+        int v = heap[i];
+        while (i > 0) {
+            size_t parent = (i - 1) / D;
+            if (keys[heap[parent]] <= keys[v]) {
+                break;
+            }
+            heap[i] = heap[parent];
+            position[heap[i]] = static_cast<int>(i);
+            i = parent;
+        }
+        heap[i] = v;
+        position[v] = static_cast<int>(i);
+    }
+
+    // Опускает элемент с позиции i, пока есть ребёнок меньше
+    void siftDown(size_t i) {
+        int v = heap[i];
+        size_t n = heap.size();
+        while (true) {
+            size_t first = i * D + 1;
+            if (first >= n) {
+                break;
+            }
+            // Ищем минимального ребёнка среди D детей
+            size_t best = first;
+            size_t last = first + D < n ? first + D : n;
+            for (size_t c = first + 1; c < last; c++) {
+                if (keys[heap[c]] < keys[heap[best]]) {
+                    best = c;
+                }
+            }
+            if (keys[heap[best]] >= keys[v]) {
+                break;
+            }
+            heap[i] = heap[best];
+            position[heap[i]] = static_cast<int>(i);
+            i = best;
+        }
+        heap[i] = v;
+        position[v] = static_cast<int>(i);
+    }
+
+public:
+    // n Количество вершин (номера 0..n-1)
+    explicit DaryHeap(int n = 0) : keys(n), position(n, -1) {}
+
+    // Меняет количество вершин и очищает кучу
+    void reset(int n) {
+        heap.clear();
+        keys.assign(n, 0.0);
+        position.assign(n, -1);
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    // Очищает кучу за O(размер кучи), а не O(n) - для многократных коротких поисков
+    void clear() {
+        for (int v : heap) {
+            position[v] = -1;
+        }
+        heap.clear();
+    }
+
+    // Минимальный ключ (куча не пуста)
+    double minKey() const {
+        return keys[heap[0]];
+    }
+
+    bool contains(int v) const {
+        return position[v] >= 0;
+    }
+
+    // Добавляет вершину или уменьшает её ключ, если она уже в куче
+    void pushOrDecrease(int v, double key) {
+        if (position[v] < 0) {
+            keys[v] = key;
+            heap.push_back(v);
+            siftUp(heap.size() - 1);
+        } else if (key < keys[v]) {
+            keys[v] = key;
+            siftUp(position[v]);
+        }
+    }
+
+    // Извлекает вершину с минимальным ключом
+    int pop() {
+        int top = heap[0];
+        position[top] = -1;
+
+        int lastVertex = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = lastVertex;
+            siftDown(0);
+        }
+        return top;
+    }
+
+    // Ключ вершины
+    double key(int v) const {
+        return keys[v];
+    }
+};
+
+#endif // DARY_HEAP_H
@@ -2,10 +2,14 @@
 #define DIJKSTRA_H
 
 #include <vector>
-#include <queue>
 #include <limits>
 #include <utility>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "../common/RadixHeap.h"
+#include "../common/DaryHeap.h"
 
 using namespace std;
 
@@ -14,127 +18,318 @@ using namespace std;
 // Начинаем с точки старта.
 // Считаем, что путь от старта до себя = 0, а до всех остальных = бесконечность.
 
-// Используем обычную очередь (не приоритетную), так как все рёбра имеют вес 1.
-// Обрабатываем вершины в порядке их удалённости от старта.
+// Каждый раз берём ещё не обработанную вершину с наименьшим расстоянием
+// и пробуем улучшить через неё расстояния до соседей:
+// dist[v] = min(dist[v], dist[u] + вес(u, v)).
+
+// Повторяем, пока есть необработанные вершины.
 
-// Для каждой вершины проверяем её соседей:
-// если сосед ещё не посещён — его расстояние = текущее расстояние + 1.
+// Какая очередь используется, зависит от весов рёбер:
 
-// Помечаем вершину как посещённую и добавляем её соседей в очередь.
+// 1. Все веса равны 1 - обычная очередь (поиск в ширину).
+//    Вершины и так извлекаются в порядке удалённости, O(V+E).
+// 2. Все веса целые неотрицательные - радикс-куча (RadixHeap.h).
+//    Никаких сравнений между элементами, каждый ключ перекладывается
+//    не больше 64 раз.
+// 3. Дробные веса - 4-арная индексированная куча (DaryHeap.h)
+//    с уменьшением ключа на месте, O((V+E) log V).
 
-// Повторяем, пока очередь не опустеет.
+// Массивы расстояний и очереди берутся из рабочей памяти потока
+// (SearchWorkspace), поэтому запрос стоит столько, сколько вершин он посетил,
+// а не сколько их в графе.
 
 // Главное, что нужно запомнить:
 
 // Для графов с единичными весами достаточно обычного поиска в ширину.
-// Каждая вершина посещается ровно один раз.
-// Алгоритм работает быстрее, чем классический Дейкстра (O(V+E) вместо O((V+E)logV)).
+// Отрицательные веса алгоритм Дейкстры не поддерживает - сервер их отклоняет.
 
 // Константа для представления бесконечности
-const int INF = numeric_limits<int>::max();
+const double INF = numeric_limits<double>::infinity();
+
+// Статистика одного поиска
+struct SearchStats {
+    int settled = 0;  // Сколько вершин извлечено из очереди (окончательно обработано)
+};
+
+// Рабочая память поиска, общая для всех запросов одного потока
+
+// Каждый поиск раньше выделял dist и parent размером n и заполнял их INF
+// и -1 - это O(n) даже для запроса, который посетил десяток вершин.
+// Здесь массивы живут между запросами, а "очистка" - это увеличение номера
+// поколения (epoch): значение в ячейке действительно, только если её метка
+// stamp[v] равна текущему поколению. Остальные ячейки считаются INF / -1.
+// Очереди (обычная, радикс-куча, 4-арная куча) тоже переиспользуются.
+
+// Поток получает свою рабочую память через SearchWorkspace::local(),
+// поэтому блокировки не нужны. Один поиск - одна рабочая память:
+// двусторонние поиски берут две разные (slot 0 и 1).
+struct SearchWorkspace {
+    vector<double> dist;      // Расстояния (действительны при stamp[v] == epoch)
+    vector<uint64_t> intDist; // Целые расстояния для радикс-кучи
+    vector<int> parent;       // Откуда пришли в вершину
+    vector<uint32_t> stamp;   // Поколение, в котором ячейка v последний раз записана
+    uint32_t epoch = 0;       // Текущее поколение
+
+    vector<int> fifo;         // Очередь поиска в ширину (читается с индекса fifoHead)
+    size_t fifoHead = 0;
+    RadixHeap radix;
+    DaryHeap<4> dary;
+
+    // Готовит память к новому поиску по графу из n вершин
+    // Время O(1), кроме первого поиска по графу большего размера
+    void begin(int n) {
+        size_t size = static_cast<size_t>(n);
+        if (stamp.size() < size) {
+            dist.resize(size);
+            intDist.resize(size);
+            parent.resize(size);
+            stamp.resize(size, 0);
+            dary.reset(n);
+        } else {
+            dary.clear();  // Поиск мог остановиться, не опустошив кучу
+        }
+        radix.clear();
+        fifo.clear();
+        fifoHead = 0;
+
+        epoch++;
+        if (epoch == 0) {
+            // Счётчик переполнился - старые метки могли совпасть с новыми
+            fill(stamp.begin(), stamp.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    // Посещена ли вершина в текущем поиске
+    bool visited(int v) const {
+        return stamp[v] == epoch;
+    }
+
+    // Расстояние до вершины (INF, если не посещена)
+    double getDist(int v) const {
+        return visited(v) ? dist[v] : INF;
+    }
+
+    // Целое расстояние (максимум uint64_t, если не посещена)
+    uint64_t getIntDist(int v) const {
+        return visited(v) ? intDist[v] : numeric_limits<uint64_t>::max();
+    }
+
+    // Родитель вершины (-1, если не посещена или это старт)
+    int getParent(int v) const {
+        return visited(v) ? parent[v] : -1;
+    }
+
+    // Записывает расстояние и родителя, отмечая вершину текущим поколением
+    void set(int v, double d, int p) {
+        stamp[v] = epoch;
+        dist[v] = d;
+        parent[v] = p;
+    }
+    void setInt(int v, uint64_t d, int p) {
+        stamp[v] = epoch;
+        intDist[v] = d;
+        dist[v] = static_cast<double>(d);
+        parent[v] = p;
+    }
+
+    // Рабочая память текущего потока
+    static SearchWorkspace& local(int slot = 0) {
+        thread_local SearchWorkspace workspaces[2];
+        return workspaces[slot];
+    }
+};
 
 class Dijkstra {
 private:
     int n;  // Количество вершин
-    vector<vector<int>> graph;  // Список смежности
-    
+    vector<vector<int>> graph;        // Список смежности
+    vector<vector<double>> weights;   // weights[u][i] - вес ребра graph[u][i]
+
+    bool unitWeights = true;     // Все веса равны 1 (можно искать в ширину)
+    bool integerWeights = true;  // Все веса целые (можно использовать радикс-кучу)
+
+    // Максимальный вес, при котором считаем вес "целым" для радикс-кучи:
+    // сумма весов любого пути должна точно помещаться и в uint64_t, и в double
+    static constexpr double MAX_INTEGER_WEIGHT = 4294967296.0;  // 2^32
+
+    // Поиск в ширину (все веса = 1)
+    // end = -1 - считаем расстояния до всех вершин
+    void runBFS(int start, int end, SearchWorkspace& ws, SearchStats& stats) const {
+        // Очередь - обычный вектор, из которого читаем по индексу fifoHead:
+        // память остаётся от прошлых запросов, в отличие от std::queue
+        vector<int>& q = ws.fifo;
+        q.push_back(start); // Добавление стартовой вершины в очередь
+
+        while (ws.fifoHead < q.size()) {
+            int u = q[ws.fifoHead++]; // Берём первый необработанный элемент
+            stats.settled++;
+
+            // Если достигли конечной вершины, можем завершить
+            if (u == end) {
+                break;
+            }
+
+            // Проходим по всем соседям u
+            double next = ws.dist[u] + 1;
+            for (int v : graph[u]) {
+                if (!ws.visited(v)) {       // Если сосед не посещен
+                    ws.set(v, next, u);     // Расстояние = предыдущее + 1, запоминаем, откуда пришли
+                    q.push_back(v);         // Добавляем в очередь
+                }
+            }
+        }
+    }
+
+    // Дейкстра на радикс-куче (целые веса)
+    // В куче могут оказаться устаревшие копии вершины - пропускаем их при извлечении
+    void runRadix(int start, int end, SearchWorkspace& ws, SearchStats& stats) const {
+        ws.setInt(start, 0, -1);
+
+        RadixHeap& heap = ws.radix;
+        heap.push(0, start);
+
+        while (!heap.empty()) {
+            pair<uint64_t, int> top = heap.pop();
+            int u = top.second;
+            if (top.first != ws.intDist[u]) {
+                continue;  // Устаревшая копия - расстояние уже улучшили
+            }
+            stats.settled++;
+            if (u == end) {
+                break;
+            }
+
+            for (size_t i = 0; i < graph[u].size(); i++) {
+                int v = graph[u][i];
+                uint64_t candidate = ws.intDist[u] + static_cast<uint64_t>(weights[u][i]);
+                if (candidate < ws.getIntDist(v)) {
+                    ws.setInt(v, candidate, u);
+                    heap.push(candidate, v);
+                }
+            }
+        }
+    }
+
+    // Дейкстра на 4-арной куче (дробные веса)
+    void runDary(int start, int end, SearchWorkspace& ws, SearchStats& stats) const {
+        DaryHeap<4>& heap = ws.dary;
+        heap.pushOrDecrease(start, 0);
+
+        while (!heap.empty()) {
+            int u = heap.pop();
+            stats.settled++;
+            if (u == end) {
+                break;
+            }
+
+            for (size_t i = 0; i < graph[u].size(); i++) {
+                int v = graph[u][i];
+                double candidate = ws.dist[u] + weights[u][i];
+                if (candidate < ws.getDist(v)) {
+                    ws.set(v, candidate, u);
+                    heap.pushOrDecrease(v, candidate);
+                }
+            }
+        }
+    }
+
+    // Выбирает очередь по весам и заполняет расстояния и родителей в рабочей памяти
+    void run(int start, int end, SearchWorkspace& ws, SearchStats& stats) const {
+        ws.begin(n);
+        ws.set(start, 0, -1);
+        if (unitWeights) {
+            runBFS(start, end, ws, stats);
+        } else if (integerWeights) {
+            runRadix(start, end, ws, stats);
+        } else {
+            runDary(start, end, ws, stats);
+        }
+    }
+
 public:
     // Конструктор, пример использования: Dijkstra dijkstra(10)
     Dijkstra(int vertices) : n(vertices) {
         graph.resize(n);
+        weights.resize(n);
     }
-    
-    // Добавление ребра в граф (вес всегда равен 1)
-    void addEdge(int from, int to) {
-        graph[from].push_back(to); 
+
+    // Добавление ребра в граф (по умолчанию вес равен 1)
+    void addEdge(int from, int to, double weight = 1.0) {
+        graph[from].push_back(to);
         // graph[from] - обращаемся к списку смежности вершины from
         // .push_back(to) - добавляем вершину to в этот список
+        weights[from].push_back(weight);
+
+        if (weight != 1.0) {
+            unitWeights = false;
+        }
+        if (weight != floor(weight) || weight > MAX_INTEGER_WEIGHT) {
+            integerWeights = false;
+        }
+    }
+
+    // Количество вершин
+    int getVertexCount() const {
+        return n;
     }
-    
+
+    // Соседи вершины u и веса рёбер к ним (только чтение, для других алгоритмов поиска)
+    const vector<int>& getNeighbors(int u) const {
+        return graph[u];
+    }
+    const vector<double>& getWeights(int u) const {
+        return weights[u];
+    }
+
     // Основная функция поиска кратчайших путей
-    // Возвращает вектор кратчайших расстояний от start до всех вершин
-    vector<int> findShortestPaths(int start) {
-        // Создает вектор из n элементов, каждый равен INF
-        vector<int> dist(n, INF);
-        dist[start] = 0;
-        
-        // Обычная очередь
-        queue<int> q; // Создание пустой очереди целых чисел
-        q.push(start); // Добавление стартовой вершины в очередь
-        // push() - это метод добавления элемента в конец контейнера
-        
-        while (!q.empty()) {
-            int u = q.front(); // front() - просмотр первого элемента
-            q.pop(); // pop() - удаление первого элемента
-            
-            // Проходим по всем соседям вершины u
-            for (int v : graph[u]) {
-                // Если вершина ещё не посещена
-                if (dist[v] == INF) {
-                    dist[v] = dist[u] + 1;
-                    q.push(v);
-                }
-            }
+    // Возвращает вектор кратчайших расстояний от start до всех вершин (INF - недостижима)
+    vector<double> findShortestPaths(int start) const {
+        SearchWorkspace& ws = SearchWorkspace::local();
+        SearchStats stats;
+        run(start, -1, ws, stats);
+
+        // Создает вектор из n элементов и копирует расстояния (INF - не посещена)
+        vector<double> dist(n);
+        for (int v = 0; v < n; v++) {
+            dist[v] = ws.getDist(v);
         }
-        
         return dist;
     }
-    
+
     // Нахождение кратчайшего пути от start до end
-    // Возвращает длину пути и сам путь
-    pair<int, vector<int>> findPath(int start, int end) {
-        // Вектор расстояний и родителей
-        // Создает вектор размера n, все элементы = INF
-        vector<int> dist(n, INF);
-        // Создает вектор размера n, все элементы = -1
-        vector<int> parent(n, -1);
-        dist[start] = 0;
-        
+    // Возвращает длину пути (сумму весов) и сам путь
+    // stats (необязательно) - сколько вершин пришлось обработать
+    pair<double, vector<int>> findPath(int start, int end, SearchStats* stats = nullptr) const {
+        // Расстояния и родители лежат в рабочей памяти потока:
+        // выделять и заполнять массивы размера n на каждый запрос не нужно
+        SearchWorkspace& ws = SearchWorkspace::local();
+
         // parent[i] = откуда пришли в i
+        SearchStats localStats;
+        run(start, end, ws, stats ? *stats : localStats);
 
-        // Обычная очередь
-        queue<int> q;
-        q.push(start);
-        
-        while (!q.empty()) {
-            int u = q.front();
-            q.pop();
-            
-            // Если достигли конечной вершины, можем завершить
-            if (u == end) {
-                break;
-            }
-            
-            // Проходим по всем соседям u
-            for (int v : graph[u]) {      
-                if (dist[v] == INF) {       // Если сосед не посещен
-                    dist[v] = dist[u] + 1;  // Расстояние = предыдущее + 1
-                    parent[v] = u;          // Запоминаем, откуда пришли
-                    q.push(v);              // Добавляем в очередь
-                }
-            }
-        }
-        
         // Восстанавливаем путь
         vector<int> path;
-        
+
         // Если путь не существует
-        if (dist[end] == INF) {
+        double length = ws.getDist(end);
+        if (length == INF) {
             return {INF, path};
         }
-        
+
         // Восстанавливаем путь от end к start
-        for (int v = end; v != -1; v = parent[v]) {
+        for (int v = end; v != -1; v = ws.getParent(v)) {
             // push_back() - это метод добавления элемента в конец вектора (динамического массива)
             path.push_back(v);
         }
-        
+
         // Разворачиваем путь (чтобы был от start к end)
         reverse(path.begin(), path.end());
-        
-        return {dist[end], path}; // длина кратчайшего пути и сам путь в виде вектора вершин
+
+        return {length, path}; // длина кратчайшего пути и сам путь в виде вектора вершин
     }
-    
+
     // Очистка графа
     // Цикл проходит по каждому элементу graph:
     // auto& adj - ссылка на внутренний вектор (список смежности для одной вершины)
@@ -143,11 +338,16 @@ public:
         for (auto& adj : graph) {
             adj.clear();
         }
+        for (auto& w : weights) {
+            w.clear();
+        }
+        unitWeights = true;
+        integerWeights = true;
     }
     // До очистки:
         // graph = [
         //     [1, 2, 3],     // adj для вершины 0
-        //     [0, 2],        // adj для вершины 1  
+        //     [0, 2],        // adj для вершины 1
         //     [0, 1],        // adj для вершины 2
         //     [0]            // adj для вершины 3
         // ]
@@ -0,0 +1,110 @@
+#ifndef DISJOINT_SET_H
+#define DISJOINT_SET_H
+
+#include <vector>
+#include <utility>
+#include <memory_resource>
+
+using namespace std;
+
+// Система непересекающихся множеств (union-find)
+
+// Принцип работы:
+
+// Каждая вершина сначала - отдельное множество (сама себе родитель).
+// Ребро (from, to) объединяет множества своих концов.
+// После обработки всех рёбер две вершины лежат в одном множестве
+// тогда и только тогда, когда между ними есть путь.
+
+// Две оптимизации:
+// - сжатие путей: при поиске корня перевешиваем вершины прямо на корень
+// - объединение по рангу: меньшее дерево подвешиваем к большему
+// Вместе они дают почти O(1) на операцию.
+
+// Зачем серверу: если start и end в разных компонентах связности,
+// ответ NO_PATH известен сразу, без обхода графа.
+
+class DisjointSet {
+private:
+    pmr::vector<int> parent;  // parent[v] = родитель v (корень - сам себе родитель)
+    pmr::vector<int> rank;    // Оценка высоты дерева (только для корней)
+
+public:
+    // Вершины добавляются по мере появления в рёбрах
+    // memory Откуда брать память (на сервере - арена текущего запроса)
+    explicit DisjointSet(pmr::memory_resource* memory = pmr::get_default_resource())
+        : parent(memory), rank(memory) {}
+
+    // Гарантирует, что вершины 0..n-1 существуют
+    void ensure(int n) {
+        int old = static_cast<int>(parent.size());
+        if (n <= old) {
+            return;
+        }
+        parent.resize(n);
+        rank.resize(n, 0);
+        for (int v = old; v < n; v++) {
+            parent[v] = v;
+        }
+    }
+
+    // Находит корень множества вершины v (со сжатием путей)
+    int find(int v) {
+        int root = v;
+        while (parent[root] != root) {
+            root = parent[root];
+        }
+        // Второй проход: перевешиваем все вершины пути прямо на корень
+        while (parent[v] != root) {
+            int next = parent[v];
+            parent[v] = root;
+            v = next;
+        }
+        return root;
+    }
+
+    // Объединяет множества вершин a и b (по рангу)
+    // Память выделяется по наибольшему номеру: вызывающий проверяет диапазон
+    void unite(int a, int b) {
+        ensure(max(a, b) + 1);
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return;
+        }
+        if (rank[a] < rank[b]) {
+            swap(a, b);
+        }
+        parent[b] = a;
+        if (rank[a] == rank[b]) {
+            rank[a]++;
+        }
+    }
+
+    // Лежат ли вершины a и b в одной компоненте
+    bool connected(int a, int b) {
+        int n = static_cast<int>(parent.size());
+        if (a < 0 || b < 0 || a >= n || b >= n) {
+            return false;
+        }
+        return find(a) == find(b);
+    }
+
+    // Количество вершин
+    int size() const {
+        return static_cast<int>(parent.size());
+    }
+
+    // Метки компонент: labels[v] = корень множества v
+    // Метки не меняются после построения, поэтому их можно читать
+    // из нескольких потоков без блокировок
+    vector<int> componentLabels() {
+        vector<int> labels(parent.size());
+        for (int v = 0; v < size(); v++) {
+            labels[v] = find(v);
+        }
+        return labels;
+    }
+};
+
+#endif // DISJOINT_SET_H
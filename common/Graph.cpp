@@ -1,10 +1,12 @@
 #include "../common/Graph.h"
 
-// Добавить ребро в неориентированный граф (вес всегда 1)
-void Graph::addEdge(int from, int to) {
+// Добавить ребро в неориентированный граф (по умолчанию вес 1)
+void Graph::addEdge(int from, int to, double weight) {
     // Неориентированный граф - добавляем в обе стороны
     graph[from].push_back(to);
     graph[to].push_back(from);
+    weights[from].push_back(weight);
+    weights[to].push_back(weight);
     // graph[1].push_back(2);  // к узлу 1 добавляем соседа 2
     // graph[2].push_back(1);  // к узлу 2 добавляем соседа 1
     // graph = {
@@ -27,6 +29,19 @@ void Graph::addEdges(const vector<vector<int>>& edges) {
     }
 }
 
+// Добавить несколько взвешенных рёбер
+void Graph::addEdges(const vector<Edge>& edges) {
+    for (const auto& edge : edges) {
+        addEdge(edge.from, edge.to, edge.weight);
+    }
+}
+
+void Graph::addEdges(const pmr::vector<Edge>& edges) {
+    for (const auto& edge : edges) {
+        addEdge(edge.from, edge.to, edge.weight);
+    }
+}
+
 // Проверить существование узла
 bool Graph::hasNode(int node) const {
     // graph.find(node) - ищет узел в словаре
@@ -44,6 +59,14 @@ vector<int> Graph::getNeighbors(int node) const {
     return {};
 }
 
+// Получить веса рёбер к соседям узла
+vector<double> Graph::getWeights(int node) const {
+    if (weights.count(node)) {
+        return weights.at(node);
+    }
+    return {};
+}
+
 // Количество узлов
 int Graph::getNodeCount() const {
     return graph.size();
@@ -77,6 +100,19 @@ bool Graph::isEmpty() const {
     return graph.empty();
 }
 
+// Проверить, что все веса конечные и неотрицательные
+bool Graph::hasValidWeights() const {
+    for (const auto& node : weights) {
+        for (double weight : node.second) {
+            // isfinite отсекает бесконечность и NaN
+            if (!isfinite(weight) || weight < 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 // Проверить существование обеих вершин в графе
 bool Graph::containsVertices(int start, int end) const {
     return hasNode(start) && hasNode(end);
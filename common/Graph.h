@@ -4,19 +4,27 @@
 #include <vector>
 #include <unordered_map>
 #include <stdexcept>
+#include <cmath>
+
+#include "../common/Protocol.h"
 
 using namespace std;
 
 class Graph {
 public:
     // Основные методы
-    void addEdge(int from, int to);
+    void addEdge(int from, int to, double weight = 1.0);
     // Функция принимает список списков, "таблицу" с рёбрами [[from, to], ...]
     void addEdges(const vector<vector<int>>& edges); 
+    // Взвешенные рёбра (из файла и из сетевого протокола, где они лежат в арене запроса)
+    void addEdges(const vector<Edge>& edges);
+    void addEdges(const pmr::vector<Edge>& edges);
     
     // Получение информации о графе
     bool hasNode(int node) const;
     vector<int> getNeighbors(int node) const;
+    // Веса рёбер к соседям (в том же порядке, что и getNeighbors)
+    vector<double> getWeights(int node) const;
     int getNodeCount() const;
     int getEdgeCount() const;
     
@@ -24,6 +32,8 @@ public:
     bool hasMinimumSize() const; // не менее 6 вершин и 6 рёбер
     bool hasMaximumSize() const; // не более 20 вершин и 20 рёбер
     bool isEmpty() const;
+    // Все веса конечные и неотрицательные (алгоритм Дейкстры не работает с отрицательными)
+    bool hasValidWeights() const;
     
     // Проверка существования вершин
     bool containsVertices(int start, int end) const;
@@ -35,6 +45,8 @@ private:
     // Значение = список соседей
     // vector<int> - это список соседей для каждого узла
     unordered_map<int, vector<int>> graph;
+    // Веса рёбер: weights[node][i] - вес ребра к соседу graph[node][i]
+    unordered_map<int, vector<double>> weights;
 };
 
 #endif
\ No newline at end of file
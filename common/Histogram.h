@@ -0,0 +1,145 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+using namespace std;
+
+// Лог-линейная гистограмма (для задержек в микросекундах)
+
+// Принцип работы:
+
+// Значения 0..3 получают по своей корзине. Дальше каждый диапазон
+// [2^p, 2^(p+1)) делится на SUB_BUCKETS равных корзин. Получается
+// относительная точность ~25% на всём диапазоне uint64_t при
+// фиксированных 256 корзинах - не нужно заранее знать, будут задержки
+// микросекунды или секунды.
+
+// Запись - это вычисление номера корзины (одна инструкция clz)
+// и увеличение счётчика. Перцентили считаются по корзинам,
+// результат - верхняя граница корзины (оценка сверху).
+
+// Используется сервером (метрики) и генератором нагрузки.
+class Histogram {
+public:
+    static const int SUB_BUCKET_BITS = 2;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;  // Корзин на степень двойки
+    static const int BUCKET_COUNT = 256;
+
+    // Номер корзины для значения
+    static int bucketIndex(uint64_t value) {
+        if (value < static_cast<uint64_t>(SUB_BUCKETS)) {
+            return static_cast<int>(value);
+        }
+        int power = 63 - __builtin_clzll(value);  // Номер старшего бита
+        int shift = power - SUB_BUCKET_BITS;
+        int sub = static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+        return SUB_BUCKETS + shift * SUB_BUCKETS + sub;
+    }
+
+    // Наибольшее значение, попадающее в корзину
+    static uint64_t bucketUpperBound(int index) {
+        if (index < SUB_BUCKETS) {
+            return static_cast<uint64_t>(index);
+        }
+        int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+        uint64_t sub = static_cast<uint64_t>((index - SUB_BUCKETS) % SUB_BUCKETS);
+        uint64_t lower = (SUB_BUCKETS + sub) << shift;
+        return lower + ((uint64_t(1) << shift) - 1);
+    }
+
+    Histogram() {
+        counts.fill(0);
+    }
+
+    // Добавляет одно значение
+    void record(uint64_t value) {
+        counts[bucketIndex(value)]++;
+        total++;
+        sum += value;
+        if (value > maximum) {
+            maximum = value;
+        }
+    }
+
+    // Добавляет count значений в корзину index (при сборе из других счётчиков)
+    void addBucket(int index, uint64_t count) {
+        counts[index] += count;
+        total += count;
+    }
+
+    // Добавляет к сумме значений (вместе с addBucket)
+    void addSum(uint64_t value) {
+        sum += value;
+    }
+
+    // Объединяет с другой гистограммой
+    void merge(const Histogram& other) {
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sum += other.sum;
+        if (other.maximum > maximum) {
+            maximum = other.maximum;
+        }
+    }
+
+    // Количество значений
+    uint64_t count() const {
+        return total;
+    }
+
+    // Сумма значений
+    uint64_t getSum() const {
+        return sum;
+    }
+
+    // Максимальное значение (только для record/merge)
+    uint64_t max() const {
+        return maximum;
+    }
+
+    // Количество значений в корзине
+    uint64_t bucketCount(int index) const {
+        return counts[index];
+    }
+
+    // Значение, не больше которого доля quantile всех значений (0..1)
+    uint64_t percentile(double quantile) const {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(total));
+        if (rank >= total) {
+            rank = total - 1;
+        }
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            seen += counts[i];
+            if (seen > rank) {
+                uint64_t bound = bucketUpperBound(i);
+                return maximum != 0 && bound > maximum ? maximum : bound;
+            }
+        }
+        return maximum;
+    }
+
+    // Сбрасывает все значения
+    void clear() {
+        counts.fill(0);
+        total = 0;
+        sum = 0;
+        maximum = 0;
+    }
+
+private:
+    array<uint64_t, BUCKET_COUNT> counts;
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t maximum = 0;
+};
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,161 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+#include "../common/Dijkstra.h"
+#include "../common/DaryHeap.h"
+
+using namespace std;
+
+// ALT: A* + ориентиры (Landmarks) + неравенство треугольника
+
+// Принцип работы:
+
+// Заранее выбираем K вершин-ориентиров L и считаем расстояния d(L, v)
+// от каждого ориентира до всех вершин (граф неориентированный, поэтому
+// d(L, v) = d(v, L) и одного массива на ориентир достаточно).
+
+// По неравенству треугольника для любой вершины v и цели t:
+//   d(v, t) >= |d(L, t) - d(L, v)|
+// Максимум по всем ориентирам - нижняя оценка оставшегося пути h(v).
+
+// Поиск A* берёт из очереди вершину с минимальным g(v) + h(v), а не g(v),
+// как Дейкстра. Вершины "в сторону от цели" получают большую оценку
+// и до них дело часто вообще не доходит - обрабатывается гораздо меньше вершин.
+
+// Оценка согласованная (h(u) <= вес(u, v) + h(v)), поэтому каждая вершина
+// извлекается из очереди один раз и найденный путь - кратчайший.
+
+// Ориентиры выбираются "самыми дальними": следующий ориентир - вершина,
+// максимально удалённая от уже выбранных. Хорошие ориентиры лежат
+// "за" вершинами запроса, на краях графа.
+
+class Landmarks {
+private:
+    vector<int> landmarks;            // Номера вершин-ориентиров
+    vector<vector<double>> distances; // distances[i][v] = d(landmarks[i], v)
+
+public:
+    Landmarks() {}
+
+    // Выбирает count ориентиров и считает расстояния от них
+    // graph Граф (список смежности)
+    // count Количество ориентиров K
+    void build(const Dijkstra& graph, int count) {
+        landmarks.clear();
+        distances.clear();
+
+        int n = graph.getVertexCount();
+
+        // Ближайшее расстояние от вершины до уже выбранных ориентиров
+        // (INF - вершина ещё не покрыта ни одним ориентиром, например,
+        // лежит в другой компоненте связности)
+        vector<double> nearest(n, INF);
+
+        for (int k = 0; k < count; k++) {
+            // Следующий ориентир - самая удалённая вершина с рёбрами
+            int best = -1;
+            for (int v = 0; v < n; v++) {
+                if (graph.getNeighbors(v).empty()) {
+                    continue;
+                }
+                bool isLandmark = find(landmarks.begin(), landmarks.end(), v) != landmarks.end();
+                if (isLandmark) {
+                    continue;
+                }
+                if (best < 0 || nearest[v] > nearest[best]) {
+                    best = v;
+                }
+            }
+            if (best < 0) {
+                break;  // Вершины закончились
+            }
+
+            landmarks.push_back(best);
+            distances.push_back(graph.findShortestPaths(best));
+
+            const vector<double>& dist = distances.back();
+            for (int v = 0; v < n; v++) {
+                nearest[v] = min(nearest[v], dist[v]);
+            }
+        }
+    }
+
+    // Построены ли ориентиры
+    bool empty() const {
+        return landmarks.empty();
+    }
+
+    // Количество ориентиров
+    int size() const {
+        return static_cast<int>(landmarks.size());
+    }
+
+    // Нижняя оценка расстояния от v до target
+    double lowerBound(int v, int target) const {
+        double bound = 0;
+        for (const auto& dist : distances) {
+            // Ориентир из другой компоненты ничего не говорит об этой паре
+            if (dist[v] == INF || dist[target] == INF) {
+                continue;
+            }
+            bound = max(bound, fabs(dist[target] - dist[v]));
+        }
+        return bound;
+    }
+
+    // Поиск A* с оценками по ориентирам
+    // Возвращает длину пути и сам путь (как Dijkstra::findPath)
+    pair<double, vector<int>> findPath(const Dijkstra& graph, int start, int end,
+                                       SearchStats* stats = nullptr) const {
+        // g(v) - найденное расстояние от start - и родители в рабочей памяти потока
+        SearchWorkspace& ws = SearchWorkspace::local();
+        ws.begin(graph.getVertexCount());
+        SearchStats localStats;
+        SearchStats& st = stats ? *stats : localStats;
+
+        // Ключ в куче - g(v) + h(v)
+        DaryHeap<4>& heap = ws.dary;
+        ws.set(start, 0, -1);
+        heap.pushOrDecrease(start, lowerBound(start, end));
+
+        while (!heap.empty()) {
+            int u = heap.pop();
+            st.settled++;
+            if (u == end) {
+                break;
+            }
+
+            const vector<int>& neighbors = graph.getNeighbors(u);
+            const vector<double>& weights = graph.getWeights(u);
+            for (size_t i = 0; i < neighbors.size(); i++) {
+                int v = neighbors[i];
+                double candidate = ws.dist[u] + weights[i];
+                if (candidate < ws.getDist(v)) {
+                    ws.set(v, candidate, u);
+                    heap.pushOrDecrease(v, candidate + lowerBound(v, end));
+                }
+            }
+        }
+
+        vector<int> path;
+        double length = ws.getDist(end);
+        if (length == INF) {
+            return {INF, path};
+        }
+
+        // Восстанавливаем путь от end к start и разворачиваем
+        for (int v = end; v != -1; v = ws.getParent(v)) {
+            path.push_back(v);
+        }
+        reverse(path.begin(), path.end());
+
+        return {length, path};
+    }
+};
+
+#endif // LANDMARKS_H
@@ -5,13 +5,16 @@
 
 using namespace std;
 
+// Знаков после запятой в выводе длины пути (лишние нули отбрасываются)
+const int PATH_LENGTH_DECIMALS = 9;
+
 // функция преобразует структуру с двумя целыми числами в плоский массив байтов
 // для передачи по сети или сохранения в файл.
 vector<char> requestToBytes(const ClientRequest& request) {
     vector<char> data;
     
-    // Цель заранее выделить память для двух целых чисел
-    for (size_t i = 0; i < sizeof(int) * 2; i++) {
+    // Цель заранее выделить память для двух целых чисел и срока
+    for (size_t i = 0; i < REQUEST_SIZE; i++) {
         data.push_back(0);
     }
     
@@ -34,7 +37,10 @@ vector<char> requestToBytes(const ClientRequest& request) {
         data[sizeof(int) + i] = end_bytes[i];
     }
     // После второго числа:
-    // Вектор data: [0x12, 0x34, 0x56, 0x78, 0xAB, 0xCD, 0xEF, 0x99]
+    // Вектор data: [0x12, 0x34, 0x56, 0x78, 0xAB, 0xCD, 0xEF, 0x99, 0, 0, 0, 0]
+
+    // Срок ответа - последние 4 байта
+    memcpy(data.data() + 2 * sizeof(int), &request.deadline_ms, sizeof(uint32_t));
         
     return data;
 }
@@ -65,6 +71,11 @@ ClientRequest bytesToRequest(const vector<char>& data) {
     }
     // Память end_node после восстановления: [0xAB, 0xCD, 0xEF, 0x99]
     // Число end_node = 0xABCDEF99
+
+    // Срока может не быть (запрос из 8 байт) - тогда остаётся 0
+    if (data.size() >= REQUEST_SIZE) {
+        memcpy(&request.deadline_ms, data.data() + 2 * sizeof(int), sizeof(uint32_t));
+    }
     
     return request;
 }
@@ -75,7 +86,7 @@ vector<char> responseToBytes(const ServerResponse& response) {
     vector<char> data;
     // Вычисляем количество элементов в пути и общий размер данных
     int path_size = static_cast<int>(response.path.size());
-    int total_size = sizeof(int) + sizeof(int) + sizeof(int) + (path_size * sizeof(int));
+    int total_size = sizeof(int) + sizeof(double) + sizeof(int) + (path_size * sizeof(int));
     
     // Заранее выделяем память для всего блока данных
     // total_size = error_code + path_length + path_size + path_data
@@ -97,10 +108,10 @@ vector<char> responseToBytes(const ServerResponse& response) {
     
     // Копируем path_length (число с плавающей точкой double)
     const char* length_bytes = reinterpret_cast<const char*>(&response.path_length);
-    for (size_t i = 0; i < sizeof(int); i++) {
+    for (size_t i = 0; i < sizeof(double); i++) {
         data[offset + i] = length_bytes[i];
     }
-    offset += sizeof(int); // Сдвигаем позицию на размер double
+    offset += sizeof(double); // Сдвигаем позицию на размер double
     // После копирования path_length:
     // data: [error_code(4b), path_length_byte0, path_length_byte1, ..., path_length_byte7, ...]
     
@@ -146,10 +157,10 @@ ServerResponse bytesToResponse(const vector<char>& data) {
     
     // Восстанавливаем path_length (число с плавающей точкой double)
     char* length_bytes = reinterpret_cast<char*>(&response.path_length);
-    for (size_t i = 0; i < sizeof(int); i++) {
+    for (size_t i = 0; i < sizeof(double); i++) {
         length_bytes[i] = data[offset + i];
     }
-    offset += sizeof(int); // Сдвигаем позицию на размер double
+    offset += sizeof(double); // Сдвигаем позицию на размер double
     // После восстановления path_length:
     // response.path_length = число double, восстановленное из следующих 8 байтов
     
@@ -181,3 +192,185 @@ ServerResponse bytesToResponse(const vector<char>& data) {
     
     return response;
 }
+
+
+// Перемешивание битов 64-битного числа (финализатор splitmix64)
+// Нужен, чтобы близкие рёбра (1 2) и (1 3) давали совершенно разные хэши
+static uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Хэш графа из суммы хэшей рёбер и их количества
+static uint64_t finishGraphHash(uint64_t sum, size_t edgeCount) {
+    return mix64(sum ^ mix64(edgeCount));
+}
+
+// Хэш одного неориентированного ребра с учётом веса
+uint64_t hashEdge(const Edge& edge) {
+    // Нормализуем ребро: (5, 2) и (2, 5) должны давать один и тот же хэш
+    uint32_t a = static_cast<uint32_t>(min(edge.from, edge.to));
+    uint32_t b = static_cast<uint32_t>(max(edge.from, edge.to));
+
+    // Вес учитываем по его битовому представлению (-0.0 и 0.0 - один вес)
+    double weight = edge.weight == 0.0 ? 0.0 : edge.weight;
+    uint64_t weightBits;
+    memcpy(&weightBits, &weight, sizeof(weightBits));
+
+    return mix64(mix64((static_cast<uint64_t>(a) << 32) | b) ^ weightBits);
+}
+
+// функция упаковывает рёбра в блок байтов:
+// [numEdges(4b)][from(4b), to(4b), weight(8b)][from, to, weight]...
+vector<char> edgesToBytes(const vector<Edge>& edges) {
+    vector<char> data(edgesByteSize(edges.size()));
+    writeEdges(edges, data.data());
+    return data;
+}
+
+// Размер блока рёбер
+size_t edgesByteSize(size_t edgeCount) {
+    const size_t edgeSize = 2 * sizeof(int) + sizeof(double);
+    return sizeof(int) + edgeCount * edgeSize;
+}
+
+// Упаковывает рёбра в готовый буфер
+void writeEdges(const vector<Edge>& edges, char* out) {
+    int numEdges = static_cast<int>(edges.size());
+    memcpy(out, &numEdges, sizeof(int));
+
+    size_t offset = sizeof(int);
+    for (const auto& edge : edges) {
+        memcpy(out + offset, &edge.from, sizeof(int));
+        offset += sizeof(int);
+        memcpy(out + offset, &edge.to, sizeof(int));
+        offset += sizeof(int);
+        memcpy(out + offset, &edge.weight, sizeof(double));
+        offset += sizeof(double);
+    }
+}
+
+// Сравнивает рёбра с блоком рёбер
+bool edgesEqual(const vector<Edge>& edges, const char* data, size_t size) {
+    if (size != edgesByteSize(edges.size())) {
+        return false;
+    }
+    int numEdges;
+    memcpy(&numEdges, data, sizeof(int));
+    if (numEdges != static_cast<int>(edges.size())) {
+        return false;
+    }
+
+    size_t offset = sizeof(int);
+    for (const auto& edge : edges) {
+        Edge stored;
+        memcpy(&stored.from, data + offset, sizeof(int));
+        memcpy(&stored.to, data + offset + sizeof(int), sizeof(int));
+        memcpy(&stored.weight, data + offset + 2 * sizeof(int), sizeof(double));
+        offset += 2 * sizeof(int) + sizeof(double);
+        // Вес сравниваем побитно: так же его записал writeEdges
+        if (stored.from != edge.from || stored.to != edge.to ||
+            memcmp(&stored.weight, &edge.weight, sizeof(double)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// функция разбирает блок рёбер и считает хэш графа
+// Хэш графа = сумма хэшей рёбер (сложение коммутативно, поэтому порядок рёбер не важен),
+// затем перемешанная вместе с количеством рёбер
+bool bytesToEdges(const vector<char>& data, pmr::vector<Edge>& edges, uint64_t& graphHash,
+                  DisjointSet& components) {
+    return bytesToEdges(data.data(), data.size(), edges, graphHash, components);
+}
+
+// То же для блока по указателю
+bool bytesToEdges(const char* data, size_t size, pmr::vector<Edge>& edges, uint64_t& graphHash,
+                  DisjointSet& components) {
+    edges.clear();
+    graphHash = 0;
+
+    if (size < sizeof(int)) {
+        return false;
+    }
+
+    const size_t edgeSize = 2 * sizeof(int) + sizeof(double);
+    int numEdges;
+    memcpy(&numEdges, data, sizeof(int));
+
+    uint64_t sum = 0;
+    size_t offset = sizeof(int);
+
+    // Одно выделение памяти на все рёбра (сколько их помещается в блок)
+    if (numEdges > 0) {
+        size_t available = (size - offset) / edgeSize;
+        edges.reserve(min(static_cast<size_t>(numEdges), available));
+    }
+
+    for (int i = 0; i < numEdges && offset + edgeSize <= size; i++) {
+        Edge edge;
+        memcpy(&edge.from, data + offset, sizeof(int));
+        offset += sizeof(int);
+        memcpy(&edge.to, data + offset, sizeof(int));
+        offset += sizeof(int);
+        memcpy(&edge.weight, data + offset, sizeof(double));
+        offset += sizeof(double);
+
+        edges.push_back(edge);
+        sum += hashEdge(edge);
+
+        // Номера вне диапазона сервер всё равно отклонит, а union-find
+        // выделил бы под них память по самому большому номеру
+        if (edge.from >= 0 && edge.to >= 0 && edge.from < MAX_GRAPH_VERTICES && edge.to < MAX_GRAPH_VERTICES) {
+            components.unite(edge.from, edge.to);
+        }
+    }
+
+    graphHash = finishGraphHash(sum, edges.size());
+    return true;
+}
+
+// Хэш графа без разбора блока
+uint64_t hashGraph(const vector<Edge>& edges) {
+    uint64_t sum = 0;
+    for (const auto& edge : edges) {
+        sum += hashEdge(edge);
+    }
+    return finishGraphHash(sum, edges.size());
+}
+
+// Точный вид графа
+GraphSignature graphSignature(const pmr::vector<Edge>& edges) {
+    GraphSignature signature;
+    signature.reserve(edges.size());
+    for (const auto& edge : edges) {
+        uint32_t a = static_cast<uint32_t>(min(edge.from, edge.to));
+        uint32_t b = static_cast<uint32_t>(max(edge.from, edge.to));
+        double weight = edge.weight == 0.0 ? 0.0 : edge.weight;
+        uint64_t weightBits;
+        memcpy(&weightBits, &weight, sizeof(weightBits));
+        signature.emplace_back((static_cast<uint64_t>(a) << 32) | b, weightBits);
+    }
+    sort(signature.begin(), signature.end());
+    return signature;
+}
+
+// Длина пути для вывода
+string formatPathLength(double length) {
+    // По умолчанию поток выводит 6 значащих цифр (1234567.5 - "1.23457e+06"),
+    // поэтому число выводится с фиксированной точностью, а нули в конце
+    // дробной части (и сама точка у целых длин) отбрасываются
+    ostringstream out;
+    out << fixed << setprecision(PATH_LENGTH_DECIMALS) << length;
+    string text = out.str();
+    if (text.find('.') != string::npos) {
+        text.erase(text.find_last_not_of('0') + 1);
+        if (text.back() == '.') {
+            text.pop_back();
+        }
+    }
+    return text;
+}
@@ -2,6 +2,15 @@
 #define PROTOCOL_H
 
 #include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <memory_resource>
+
+#include "../common/DisjointSet.h"
 
 using namespace std;
 
@@ -16,26 +25,41 @@ enum MessageType {
 enum ErrorCode {
     SUCCESS = 0,           // Успех
     INVALID_REQUEST = 1,   // Неправильный запрос
-    NO_PATH = 2           // Путь не найден
+    NO_PATH = 2,           // Путь не найден
+    OVERLOADED = 3,        // Сервер перегружен, запрос не принят (можно повторить позже)
+    DEADLINE_EXCEEDED = 4  // Срок запроса истёк раньше, чем до него дошла очередь
 };
 
 // Структура для ребра графа
 struct Edge {
     int from;
     int to;
-    // double weight;
+    double weight;   // Вес ребра (в невзвешенном графе все веса = 1)
 };
 
+// Номера вершин - индексы от 0 до MAX_GRAPH_VERTICES - 1: клиент нумерует
+// вершины подряд, а в графе их не больше MAX_GRAPH_VERTICES. Сервер
+// отклоняет большие номера до того, как под них выделяется память
+const int MAX_GRAPH_VERTICES = 20;
+
 // Запрос от клиента
 struct ClientRequest { // Клиент будет отправлять это
     int start_node;
     int end_node;
+    // Сколько миллисекунд клиент готов ждать ответ (отсчёт - от получения
+    // запроса сервером: часы клиента и сервера не синхронизированы).
+    // 0 - срок по умолчанию сервера
+    uint32_t deadline_ms = 0;
 };
 
+// Размер запроса в байтах: start_node, end_node, deadline_ms
+// (по TCP запрос из 8 байт без срока тоже принимается - срок по умолчанию)
+const size_t REQUEST_SIZE = 2 * sizeof(int) + sizeof(uint32_t);
+
 // Ответ от сервера
 struct ServerResponse { // Сервер будет отвечать этим
     int error_code;
-    int path_length;
+    double path_length; // Сумма весов рёбер пути (для невзвешенного графа = число рёбер)
     vector<int> path;  // Список узлов пути
 };
 
@@ -57,4 +81,55 @@ vector<char> responseToBytes(const ServerResponse& response);
 // Клиент - Сервер: преобразуем байты обратно в ответ
 ServerResponse bytesToResponse(const vector<char>& data);
 
+// Преобразование рёбер:
+
+// Клиент - Сервер: упаковывает рёбра в блок [numEdges][from, to, weight][from, to, weight]...
+vector<char> edgesToBytes(const vector<Edge>& edges);
+
+// Размер блока рёбер в байтах
+size_t edgesByteSize(size_t edgeCount);
+
+// Упаковывает рёбра прямо в out (edgesByteSize(edges.size()) байт) -
+// например, в общую память без промежуточного вектора
+void writeEdges(const vector<Edge>& edges, char* out);
+
+// Совпадает ли блок рёбер (data, size) с рёбрами edges - без распаковки
+// и без копий (клиент общей памяти так проверяет уже выгруженный граф)
+bool edgesEqual(const vector<Edge>& edges, const char* data, size_t size);
+
+// Сервер: разбирает блок рёбер [numEdges][from, to, weight][from, to, weight]...
+// Одновременно считает хэш графа (graphHash), не зависящий от порядка рёбер
+// и от направления записи ребра (A B и B A - одно и то же ребро)
+// Попутно объединяет концы рёбер в components (union-find), так что после разбора
+// сразу известно, какие вершины связаны между собой
+// Память для edges берётся из их аллокатора (на сервере - арена запроса)
+// false, если блок слишком короткий
+bool bytesToEdges(const vector<char>& data, pmr::vector<Edge>& edges, uint64_t& graphHash,
+                  DisjointSet& components);
+
+// То же для блока по указателю (рёбра в общей памяти разбираются без копирования)
+bool bytesToEdges(const char* data, size_t size, pmr::vector<Edge>& edges, uint64_t& graphHash,
+                  DisjointSet& components);
+
+// Хэш одного неориентированного ребра с учётом веса
+// (сначала нормализуем: меньшая вершина первой)
+uint64_t hashEdge(const Edge& edge);
+
+// Хэш графа - тот же, что считает bytesToEdges на сервере: клиент по нему
+// выбирает сервер, у которого ответы на этот граф уже в кэше
+uint64_t hashGraph(const vector<Edge>& edges);
+
+// Точный вид графа для сравнения: рёбра нормализованы, как в hashEdge
+// (меньшая вершина первой, -0.0 как 0.0), и отсортированы. Хэш графа
+// аддитивный, и совпадение хэшей можно подобрать намеренно, поэтому
+// сервер при попадании по хэшу сравнивает ещё и вид графа
+// Элемент - (вершины: меньшая в старших 32 битах, биты веса)
+using GraphSignature = vector<pair<uint64_t, uint64_t>>;
+
+GraphSignature graphSignature(const pmr::vector<Edge>& edges);
+
+// Длина пути для вывода: целые длины без дробной части ("3", а не "3.000000"),
+// дробные - без экспоненты и округления до 6 значащих цифр ("1234567.5")
+string formatPathLength(double length);
+
 #endif
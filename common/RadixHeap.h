@@ -0,0 +1,97 @@
+#ifndef RADIX_HEAP_H
+#define RADIX_HEAP_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// Радикс-куча (radix heap) для алгоритма Дейкстры с целыми весами
+
+// Принцип работы:
+
+// В Дейкстре извлекаемые расстояния не убывают ("монотонная" очередь).
+// Запоминаем последний извлечённый ключ last. Элемент с ключом key кладём
+// в корзину номер = номер старшего бита, в котором key отличается от last.
+// В корзине 0 лежат ключи, равные last - их можно отдавать сразу.
+
+// Когда корзина 0 пуста, берём первую непустую корзину, находим в ней
+// минимум, делаем его новым last и раскладываем корзину заново.
+// Каждый элемент переезжает в корзину с меньшим номером, поэтому
+// за всё время он перекладывается не больше 64 раз.
+
+// Итог: push - O(1), pop - амортизированно O(log C), где C - максимальный вес,
+// и никаких сравнений элементов между собой, как в бинарной куче.
+
+class RadixHeap {
+private:
+    static const int BUCKETS = 65;  // Корзина 0 + по одной на каждый бит uint64_t
+
+    vector<pair<uint64_t, int>> buckets[BUCKETS];  // (ключ, вершина)
+    uint64_t last = 0;   // Последний извлечённый ключ
+    size_t count = 0;    // Количество элементов
+
+    // Номер корзины: позиция старшего бита, в котором x отличается от last
+    static int bucketIndex(uint64_t x) {
+        return x == 0 ? 0 : 64 - __builtin_clzll(x);
+    }
+
+public:
+    // Добавляет вершину с ключом key (key не меньше последнего извлечённого)
+    void push(uint64_t key, int value) {
+        buckets[bucketIndex(key ^ last)].emplace_back(key, value);
+        count++;
+    }
+
+    // Извлекает элемент с минимальным ключом
+    pair<uint64_t, int> pop() {
+        if (buckets[0].empty()) {
+            // Ищем первую непустую корзину
+            int i = 1;
+            while (buckets[i].empty()) {
+                i++;
+            }
+
+            // Её минимум становится новым last
+            uint64_t newLast = buckets[i][0].first;
+            for (const auto& item : buckets[i]) {
+                if (item.first < newLast) {
+                    newLast = item.first;
+                }
+            }
+            last = newLast;
+
+            // Раскладываем корзину заново относительно нового last
+            for (const auto& item : buckets[i]) {
+                buckets[bucketIndex(item.first ^ last)].push_back(item);
+            }
+            buckets[i].clear();
+        }
+
+        pair<uint64_t, int> top = buckets[0].back();
+        buckets[0].pop_back();
+        count--;
+        return top;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    // Очищает кучу (память корзин сохраняется для повторного использования)
+    void clear() {
+        for (auto& bucket : buckets) {
+            bucket.clear();
+        }
+        last = 0;
+        count = 0;
+    }
+};
+
+#endif // RADIX_HEAP_H
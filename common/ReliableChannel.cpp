@@ -0,0 +1,344 @@
+#include "../common/ReliableChannel.h"
+
+using namespace std;
+
+// Сколько сегментов с опережением принимает получатель
+const uint32_t RECEIVE_WINDOW = 1024;
+// Сколько SACK должны показать сегмент пропущенным для быстрого повтора
+const int DUP_THRESHOLD = 3;
+// Сегмент отправляется не меньше MIN_SENDS раз (требование 2.9.4), а
+// связь считается потерянной, когда без подтверждения прошло GIVE_UP
+const int MIN_SENDS = 3;
+const auto GIVE_UP = chrono::milliseconds(9000);
+// Окно перегрузки: начальное (RFC 6928), наименьшее после потери и во
+// сколько раз оно сжимается при потере (0.7 - как в CUBIC, RFC 8312:
+// случайные потери в сети не так сильно режут скорость, как при 0.5)
+const double INITIAL_CWND = 10;
+const double MIN_CWND = 2;
+const double CWND_DECREASE = 0.7;
+// Темп: с каким запасом к cwnd / SRTT отправлять (в медленном старте
+// окно удваивается за RTT - темп тоже нужен вдвое выше)
+const double PACING_GAIN = 1.25;
+const double SLOW_START_PACING_GAIN = 2.0;
+// Сегменты, чьё время отправки наступит в пределах этого срока, уходят сразу
+const auto PACING_SLACK = chrono::milliseconds(1);
+
+// Конструктор
+ReliableChannel::ReliableChannel(uint32_t id, shared_ptr<RttEstimator> rtt, size_t window)
+    : channelId(id), rtt(move(rtt)), window(max<size_t>(1, window)), broken(false),
+      sendBase(0), nextToSend(0), nextSeq(0), cwnd(INITIAL_CWND), ssthresh(static_cast<double>(this->window)),
+      recoverSeq(0), expected(0) {
+}
+
+// Новый ID канала
+uint32_t ReliableChannel::newId() {
+    static mt19937 rng(random_device{}());
+    uint32_t id = 0;
+    while (id == 0) {
+        id = static_cast<uint32_t>(rng());
+    }
+    return id;
+}
+
+// ID канала из данных пакета
+uint32_t ReliableChannel::idOf(const vector<char>& payload) {
+    uint32_t id = 0;
+    if (payload.size() >= sizeof(id)) {
+        memcpy(&id, payload.data(), sizeof(id));
+    }
+    return id;
+}
+
+uint32_t ReliableChannel::id() const {
+    return channelId;
+}
+
+// Ставит сообщение в канал
+uint32_t ReliableChannel::send(const vector<char>& message, const Sender& sender) {
+    uint32_t seq = nextSeq++;
+    Segment segment;
+    segment.packet = UDPProtocol::createSegmentPacket(seq, channelId, message);
+    segments.push_back(move(segment));
+    transmitNew(sender);
+    return seq;
+}
+
+// Разбирает пакет канала
+bool ReliableChannel::receive(const UDPPacketHeader& header, const vector<char>& payload,
+                              const Sender& sender, const Deliver& deliver) {
+    if (idOf(payload) != channelId) {
+        return false;
+    }
+    if (header.type == PACKET_SEGMENT) {
+        handleSegment(header.packet_id, vector<char>(payload.begin() + sizeof(uint32_t), payload.end()),
+                      sender, deliver);
+    } else if (header.type == PACKET_SACK) {
+        handleSack(header.packet_id, payload, sender);
+    }
+    return true;
+}
+
+// Повторяет сегменты с истёкшим таймером
+void ReliableChannel::onTimer(const Sender& sender) {
+    auto now = Clock::now();
+    size_t limit = min(window, segments.size());
+    for (size_t i = 0; i < limit; i++) {
+        Segment& segment = segments[i];
+        if (segment.sends == 0 || segment.acked || now < segment.expiresAt) {
+            continue;
+        }
+        if (segment.sends >= MIN_SENDS && now - segment.firstSentAt >= GIVE_UP) {
+            broken = true;
+            return;
+        }
+        onLoss(sendBase + static_cast<uint32_t>(i), true);
+        transmit(segment, sender, now);
+    }
+    // Таймер мог быть и таймером темпа
+    transmitNew(sender);
+}
+
+// Ближайший таймер
+ReliableChannel::Clock::time_point ReliableChannel::nextDeadline() const {
+    auto nearest = Clock::time_point::max();
+    size_t limit = min(window, segments.size());
+    for (size_t i = 0; i < limit; i++) {
+        const Segment& segment = segments[i];
+        if (segment.sends > 0 && !segment.acked) {
+            nearest = min(nearest, segment.expiresAt);
+        }
+    }
+    // Новый сегмент ждёт только темпа (окно перегрузки позволяет)
+    bool waiting = false;
+    for (size_t i = 0; i < limit && !waiting; i++) {
+        waiting = segments[i].sends == 0;
+    }
+    if (waiting && static_cast<double>(inFlight()) < max(1.0, floor(cwnd))) {
+        nearest = min(nearest, nextSendAt - PACING_SLACK);
+    }
+    return nearest;
+}
+
+bool ReliableChannel::failed() const {
+    return broken;
+}
+
+size_t ReliableChannel::unacked() const {
+    return segments.size();
+}
+
+// Подтверждён ли сегмент
+bool ReliableChannel::acknowledged(uint32_t seq) const {
+    // Номера сравниваются по модулю 2^32: канал переживает переполнение
+    uint32_t index = seq - sendBase;
+    if (static_cast<int32_t>(index) < 0) {
+        return true;
+    }
+    return index < segments.size() && segments[index].acked;
+}
+
+double ReliableChannel::congestionWindow() const {
+    return cwnd;
+}
+
+// Отправляет сегмент
+void ReliableChannel::transmit(Segment& segment, const Sender& sender, Clock::time_point now) {
+    // Ошибка отправки - то же, что потеря: сегмент повторит таймер
+    sender(segment.packet);
+    if (segment.sends == 0) {
+        segment.firstSentAt = now;
+    }
+    segment.sentAt = now;
+    segment.expiresAt = now + rtt->timeout(segment.sends);
+    segment.sends++;
+    if (segment.sends >= MIN_SENDS) {
+        segment.expiresAt = min(segment.expiresAt, segment.firstSentAt + GIVE_UP);
+    }
+    segment.missedBy = 0;
+}
+
+// Отправляет сегменты, попавшие в окно
+void ReliableChannel::transmitNew(const Sender& sender) {
+    auto now = Clock::now();
+    // Простой не копит права на пачку: отсчёт темпа - не раньше текущего момента
+    nextSendAt = max(nextSendAt, now);
+    auto interval = pacingInterval();
+    double allowed = max(1.0, floor(cwnd));
+    size_t sent = inFlight();
+    size_t limit = min(window, segments.size());
+    for (size_t i = 0; i < limit && static_cast<double>(sent) < allowed; i++) {
+        if (segments[i].sends != 0) {
+            continue;
+        }
+        if (nextSendAt > now + PACING_SLACK) {
+            break;
+        }
+        transmit(segments[i], sender, now);
+        nextToSend = sendBase + static_cast<uint32_t>(i) + 1;
+        nextSendAt += interval;
+        sent++;
+    }
+}
+
+// Сегментов в полёте
+size_t ReliableChannel::inFlight() const {
+    size_t count = 0;
+    size_t limit = min(window, segments.size());
+    for (size_t i = 0; i < limit; i++) {
+        if (segments[i].sends > 0 && !segments[i].acked) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Промежуток между новыми сегментами
+ReliableChannel::Clock::duration ReliableChannel::pacingInterval() const {
+    auto srtt = rtt->srtt();
+    if (srtt.count() == 0) {
+        return Clock::duration(0);
+    }
+    double gain = cwnd < ssthresh ? SLOW_START_PACING_GAIN : PACING_GAIN;
+    auto interval = chrono::duration_cast<Clock::duration>(srtt) / (cwnd * gain);
+    return chrono::duration_cast<Clock::duration>(interval);
+}
+
+// Сегмент подтверждён
+void ReliableChannel::onAcked() {
+    if (cwnd < ssthresh) {
+        cwnd += 1;
+    } else {
+        cwnd += 1 / cwnd;
+    }
+    // Дальше окна канала расти незачем
+    cwnd = min(cwnd, static_cast<double>(window));
+}
+
+// Сегмент потерян
+void ReliableChannel::onLoss(uint32_t seq, bool timeout) {
+    // Потери в уже сжатом окне - та же перегрузка
+    if (static_cast<int32_t>(seq - recoverSeq) < 0) {
+        return;
+    }
+    ssthresh = max(cwnd * CWND_DECREASE, MIN_CWND);
+    cwnd = timeout ? 1 : ssthresh;
+    recoverSeq = nextSeq;
+}
+
+// Получен сегмент
+void ReliableChannel::handleSegment(uint32_t seq, vector<char> message, const Sender& sender,
+                                    const Deliver& deliver) {
+    uint32_t offset = seq - expected;
+    // Повтор уже выданного сегмента (потерялся наш SACK) - только подтверждаем
+    if (static_cast<int32_t>(offset) < 0) {
+        sendSack(sender);
+        return;
+    }
+    // Слишком далеко впереди: буфер не растёт без предела, отправитель повторит
+    if (offset >= RECEIVE_WINDOW) {
+        return;
+    }
+
+    vector<pair<uint32_t, vector<char>>> ready;
+    if (offset == 0) {
+        ready.emplace_back(seq, move(message));
+        expected++;
+        // Сегменты, ждавшие этого, тоже выдаются
+        for (auto it = outOfOrder.find(expected); it != outOfOrder.end(); it = outOfOrder.find(expected)) {
+            ready.emplace_back(expected, move(it->second));
+            outOfOrder.erase(it);
+            expected++;
+        }
+    } else {
+        outOfOrder.emplace(seq, move(message));
+    }
+
+    // Сначала подтверждение: отправитель не ждёт, пока мы обработаем сообщения
+    sendSack(sender);
+    for (auto& [readySeq, readyMessage] : ready) {
+        deliver(readySeq, readyMessage);
+    }
+}
+
+// Получено подтверждение
+void ReliableChannel::handleSack(uint32_t nextExpected, const vector<char>& payload, const Sender& sender) {
+    auto now = Clock::now();
+    // Замер RTT - по последнему отправленному из впервые подтверждённых
+    // и только по сегменту, отправленному один раз (алгоритм Карна)
+    Clock::time_point sampleSentAt;
+    bool haveSample = false;
+    auto acknowledge = [&](Segment& segment) {
+        if (segment.acked) {
+            return;
+        }
+        if (segment.sends == 1 && (!haveSample || segment.sentAt > sampleSentAt)) {
+            sampleSentAt = segment.sentAt;
+            haveSample = true;
+        }
+        segment.acked = true;
+        onAcked();
+    };
+
+    // Всё до nextExpected получено. Номер дальше отправленного - мусор или
+    // чужая подделка: неотправленные сегменты не могут быть подтверждены
+    uint32_t cumulative = nextExpected - sendBase;
+    if (cumulative <= nextToSend - sendBase) {
+        for (uint32_t i = 0; i < cumulative; i++) {
+            acknowledge(segments.front());
+            segments.pop_front();
+            sendBase++;
+        }
+    }
+
+    // Выборочно подтверждённые: бит i - сегмент nextExpected + 1 + i
+    long highest = -1;
+    for (size_t byte = sizeof(uint32_t); byte < payload.size(); byte++) {
+        uint8_t bits = static_cast<uint8_t>(payload[byte]);
+        for (int bit = 0; bit < 8 && bits != 0; bit++) {
+            if (!(bits & (1 << bit))) {
+                continue;
+            }
+            uint32_t seq = nextExpected + 1 + static_cast<uint32_t>((byte - sizeof(uint32_t)) * 8 + bit);
+            uint32_t index = seq - sendBase;
+            if (index < segments.size() && segments[index].sends > 0) {
+                acknowledge(segments[index]);
+                highest = max(highest, static_cast<long>(index));
+            }
+        }
+    }
+
+    // Сегменты до выборочно подтверждённого, скорее всего, потеряны
+    for (long i = 0; i < highest; i++) {
+        Segment& segment = segments[i];
+        if (segment.sends > 0 && !segment.acked && ++segment.missedBy >= DUP_THRESHOLD) {
+            onLoss(sendBase + static_cast<uint32_t>(i), false);
+            transmit(segment, sender, now);
+        }
+    }
+
+    // Начало окна могло подтвердиться выборочно раньше накопленного номера
+    while (!segments.empty() && segments.front().acked) {
+        segments.pop_front();
+        sendBase++;
+    }
+
+    if (haveSample) {
+        rtt->addSample(chrono::duration_cast<RttEstimator::Duration>(now - sampleSentAt));
+    }
+    transmitNew(sender);
+}
+
+// Отправляет подтверждение
+void ReliableChannel::sendSack(const Sender& sender) {
+    // Карта - до самого дальнего сегмента с опережением
+    uint32_t farthest = 0;
+    for (const auto& entry : outOfOrder) {
+        farthest = max(farthest, entry.first - expected);
+    }
+    vector<uint8_t> bitmap(farthest == 0 ? 0 : (farthest - 1) / 8 + 1, 0);
+    for (const auto& entry : outOfOrder) {
+        uint32_t bit = entry.first - expected - 1;
+        bitmap[bit / 8] |= static_cast<uint8_t>(1 << (bit % 8));
+    }
+    sender(UDPProtocol::createSackPacket(expected, channelId, bitmap));
+}
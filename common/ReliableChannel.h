@@ -0,0 +1,171 @@
+#ifndef RELIABLE_CHANNEL_H
+#define RELIABLE_CHANNEL_H
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "../common/UDPProtocol.h"
+#include "../common/RttEstimator.h"
+
+using namespace std;
+
+// Надёжный канал поверх UDP с окном и выборочным повтором
+
+// Раньше каждый пакет ждал своего ACK (stop-and-wait), а ответ сервера
+// не подтверждался вовсе. Канал связывает две стороны (клиента и сервер)
+// и в обе стороны даёт одно и то же:
+//   - сообщения нумеруются (номер сегмента), в полёте до window сегментов
+//     сразу - пропускная способность растёт с окном, а не упирается в RTT;
+//   - получатель на каждый сегмент отвечает PACKET_SACK: номер первого
+//     недостающего сегмента (всё до него получено) и битовая карта
+//     полученных после него;
+//   - у каждого сегмента свой таймер повтора (RTO по RttEstimator);
+//     сегмент, который карта показала пропущенным DUP_THRESHOLD раз
+//     подряд, повторяется сразу, не дожидаясь таймера;
+//   - сообщения выдаются получателю строго по порядку номеров, сегменты
+//     с опережением ждут в буфере.
+
+// Окно перегрузки (AIMD, как в TCP): в полёте не больше cwnd сегментов
+// (и не больше window). Каждый подтверждённый сегмент увеличивает cwnd на
+// 1 (медленный старт, пока cwnd < ssthresh) или на 1/cwnd; потеря
+// уменьшает cwnd в CWND_DECREASE раз (таймаут - до одного сегмента), но
+// не чаще раза на окно: следующие потери того же окна - следствие той же
+// перегрузки. Так отправитель не забивает буфер сокета получателя и сам
+// не вызывает потери.
+
+// Темп (pacing): новые сегменты уходят не пачкой, а через SRTT / cwnd
+// друг за другом (с запасом PACING_GAIN). Сегменты, чьё время наступит в
+// пределах PACING_SLACK, уходят сразу - таймер не нужен на каждый сегмент.
+
+// Сообщение - один сегмент (одна датаграмма), сообщения не дробятся.
+// У канала есть ID: он передаётся в каждом пакете, и сегменты прошлого
+// канала с того же адреса (клиент перезапущен) не смешиваются с новыми.
+
+// Канал не создаёт сокетов и потоков: пакеты отправляет переданная ему
+// функция (Sender), а полученные пакеты и таймеры передаёт вызывающий.
+// Объект не потокобезопасный.
+
+// Окно по умолчанию (сегментов в полёте)
+const size_t DEFAULT_CHANNEL_WINDOW = 64;
+
+class ReliableChannel {
+public:
+    using Clock = chrono::steady_clock;
+    // Отправка пакета другой стороне
+    using Sender = function<bool(const vector<char>& packet)>;
+    // Очередное по порядку сообщение: seq - его номер в канале
+    using Deliver = function<void(uint32_t seq, vector<char>& message)>;
+
+    // id ID канала (одинаковый у обеих сторон)
+    // rtt Оценка RTT до другой стороны
+    // window Наибольшее число сегментов в полёте
+    ReliableChannel(uint32_t id, shared_ptr<RttEstimator> rtt, size_t window = DEFAULT_CHANNEL_WINDOW);
+
+    // Новый случайный ID канала (не 0)
+    static uint32_t newId();
+
+    // ID канала из данных пакета PACKET_SEGMENT или PACKET_SACK (0, если данных нет)
+    static uint32_t idOf(const vector<char>& payload);
+
+    uint32_t id() const;
+
+    // Ставит сообщение в канал; отправляет сразу, если окно не заполнено
+    // Номер сегмента сообщения
+    uint32_t send(const vector<char>& message, const Sender& sender);
+
+    // Разбирает пакет канала (PACKET_SEGMENT или PACKET_SACK)
+    // false, если пакет другого канала (ID не совпал)
+    bool receive(const UDPPacketHeader& header, const vector<char>& payload,
+                 const Sender& sender, const Deliver& deliver);
+
+    // Повторяет сегменты, чей таймер истёк
+    void onTimer(const Sender& sender);
+
+    // Ближайший таймер (Clock::time_point::max(), если ждать нечего)
+    Clock::time_point nextDeadline() const;
+
+    // Связь потеряна: сегмент не подтверждён за отведённое время
+    bool failed() const;
+
+    // Сообщений отправлено или ждёт окна, но ещё не подтверждено
+    size_t unacked() const;
+
+    // Подтверждён ли сегмент seq
+    bool acknowledged(uint32_t seq) const;
+
+    // Окно перегрузки (сегментов)
+    double congestionWindow() const;
+
+private:
+    struct Segment {
+        vector<char> packet;            // Пакет целиком
+        Clock::time_point firstSentAt;  // Первая отправка
+        Clock::time_point sentAt;       // Последняя отправка
+        Clock::time_point expiresAt;    // Таймер повтора
+        int sends = 0;                  // Отправок (0 - ждёт окна)
+        int missedBy = 0;               // Сколько SACK показали его пропущенным
+        bool acked = false;             // Подтверждён выборочно
+    };
+
+    uint32_t channelId;
+    shared_ptr<RttEstimator> rtt;
+    size_t window;
+    bool broken;
+
+    // Отправитель: segments[i] - сегмент sendBase + i; сегменты уходят по
+    // порядку, и nextToSend - первый ещё ни разу не отправленный
+    uint32_t sendBase;
+    uint32_t nextToSend;
+    uint32_t nextSeq;
+    deque<Segment> segments;
+
+    // Управление перегрузкой: окно, порог медленного старта и номер, с
+    // которого начинается следующее окно (потери до него уже учтены)
+    double cwnd;
+    double ssthresh;
+    uint32_t recoverSeq;
+    // Когда можно отправить следующий новый сегмент (темп)
+    Clock::time_point nextSendAt;
+
+    // Получатель: следующий по порядку номер и сегменты с опережением
+    uint32_t expected;
+    unordered_map<uint32_t, vector<char>> outOfOrder;
+
+    // Отправляет (или повторяет) сегмент
+    void transmit(Segment& segment, const Sender& sender, Clock::time_point now);
+
+    // Отправляет сегменты, для которых освободилось окно (с учётом темпа)
+    void transmitNew(const Sender& sender);
+
+    // Сегментов отправлено и не подтверждено
+    size_t inFlight() const;
+
+    // Промежуток между новыми сегментами (0 - RTT ещё не известен)
+    Clock::duration pacingInterval() const;
+
+    // Сегмент подтверждён: окно перегрузки растёт
+    void onAcked();
+
+    // Сегмент seq потерян (timeout - по таймеру): окно перегрузки сжимается
+    void onLoss(uint32_t seq, bool timeout);
+
+    // Получен сегмент другой стороны
+    void handleSegment(uint32_t seq, vector<char> message, const Sender& sender, const Deliver& deliver);
+
+    // Получено подтверждение другой стороны
+    void handleSack(uint32_t nextExpected, const vector<char>& payload, const Sender& sender);
+
+    // Отправляет подтверждение полученных сегментов
+    void sendSack(const Sender& sender);
+};
+
+#endif
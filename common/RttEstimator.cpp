@@ -0,0 +1,65 @@
+#include "../common/RttEstimator.h"
+
+using namespace std;
+
+// Наибольшая случайная добавка к таймауту - доля от него
+const int JITTER_DIVISOR = 4;
+
+// Конструктор
+RttEstimator::RttEstimator()
+    : hasSample(false), smoothed(0), variation(0), current(INITIAL_RTO),
+      rng(random_device{}()) {
+}
+
+// Оценка для адреса сервера
+shared_ptr<RttEstimator> RttEstimator::forDestination(const string& destination) {
+    static mutex tableLock;
+    static map<string, shared_ptr<RttEstimator>> table;
+
+    lock_guard<mutex> guard(tableLock);
+    shared_ptr<RttEstimator>& estimator = table[destination];
+    if (!estimator) {
+        estimator = make_shared<RttEstimator>();
+    }
+    return estimator;
+}
+
+// Учитывает замер RTT
+void RttEstimator::addSample(Duration rtt) {
+    lock_guard<mutex> guard(lock);
+    if (!hasSample) {
+        smoothed = rtt;
+        variation = rtt / 2;
+        hasSample = true;
+    } else {
+        Duration error = smoothed > rtt ? smoothed - rtt : rtt - smoothed;
+        variation = (variation * 3 + error) / 4;
+        smoothed = (smoothed * 7 + rtt) / 8;
+    }
+    current = clamp(smoothed + max(CLOCK_GRANULARITY, variation * 4), MIN_RTO, MAX_RTO);
+}
+
+// Текущий RTO
+RttEstimator::Duration RttEstimator::rto() {
+    lock_guard<mutex> guard(lock);
+    return current;
+}
+
+// Таймаут попытки
+RttEstimator::Duration RttEstimator::timeout(int attempt) {
+    lock_guard<mutex> guard(lock);
+    // Сдвиг ограничен: дальше всё равно упрёмся в MAX_RTO
+    Duration base = min(Duration(current.count() << min(attempt, 16)), MAX_RTO);
+    uniform_int_distribution<Duration::rep> jitter(0, base.count() / JITTER_DIVISOR);
+    return min(base + Duration(jitter(rng)), MAX_RTO);
+}
+
+RttEstimator::Duration RttEstimator::srtt() {
+    lock_guard<mutex> guard(lock);
+    return smoothed;
+}
+
+RttEstimator::Duration RttEstimator::rttvar() {
+    lock_guard<mutex> guard(lock);
+    return variation;
+}
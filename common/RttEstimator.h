@@ -0,0 +1,75 @@
+#ifndef RTT_ESTIMATOR_H
+#define RTT_ESTIMATOR_H
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+// Оценка времени приема-передачи (RTT) и таймаут повторной отправки (RTO)
+
+// Алгоритм Джекобсона/Карелса (как в TCP, RFC 6298):
+//   первый замер R:  SRTT = R, RTTVAR = R / 2
+//   следующие:       RTTVAR = 3/4 * RTTVAR + 1/4 * |SRTT - R|
+//                    SRTT   = 7/8 * SRTT   + 1/8 * R
+//   RTO = SRTT + max(G, 4 * RTTVAR), в пределах [MIN_RTO, MAX_RTO]
+// До первого замера RTO = INITIAL_RTO.
+
+// Замер - время от отправки пакета до его подтверждения. Повторённые
+// пакеты не замеряются (алгоритм Карна): непонятно, на какую отправку
+// пришло подтверждение.
+
+// Таймаут попытки attempt (с нуля) - RTO * 2^attempt (экспоненциальная
+// отсрочка) плюс случайная добавка до четверти: клиенты, потерявшие пакеты
+// одновременно, не повторяют их одновременно.
+
+// Оценка своя для каждого адреса сервера и общая для всех клиентов
+// процесса (forDestination): новое подключение сразу получает таймаут по
+// уже известному RTT, а не начальные секунды. Методы потокобезопасны.
+class RttEstimator {
+public:
+    using Duration = chrono::microseconds;
+
+    // RTO до первого замера (RFC 6298)
+    static constexpr Duration INITIAL_RTO = chrono::milliseconds(1000);
+    // Пределы RTO: снизу - чтобы редкая задержка потока ввода-вывода
+    // сервера не вызывала лишних повторов; сверху - таймаут ACK из
+    // требования 2.9.3
+    static constexpr Duration MIN_RTO = chrono::milliseconds(5);
+    static constexpr Duration MAX_RTO = chrono::milliseconds(3000);
+    // Точность часов (G)
+    static constexpr Duration CLOCK_GRANULARITY = chrono::milliseconds(1);
+
+    RttEstimator();
+
+    // Оценка для адреса сервера (создаётся при первом обращении)
+    static shared_ptr<RttEstimator> forDestination(const string& destination);
+
+    // Учитывает замер RTT
+    void addSample(Duration rtt);
+
+    // Текущий RTO
+    Duration rto();
+
+    // Таймаут попытки attempt (с нуля): отсрочка и случайная добавка
+    Duration timeout(int attempt);
+
+    // Сглаженный RTT и его отклонение (0 до первого замера)
+    Duration srtt();
+    Duration rttvar();
+
+private:
+    mutex lock;
+    bool hasSample;
+    Duration smoothed;
+    Duration variation;
+    Duration current;
+    mt19937 rng;
+};
+
+#endif
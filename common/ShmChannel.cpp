@@ -0,0 +1,301 @@
+#include "../common/ShmChannel.h"
+
+using namespace std;
+
+// Формат области: "GSHM" и версия
+const uint32_t SHM_MAGIC = 0x4D485347;
+const uint32_t SHM_VERSION = 1;
+// Сколько проверок кольца до сна (порядка сотни микросекунд)
+const int SHM_SPIN_ITERATIONS = 4000;
+// Дескрипторы, передаваемые серверу: область, eventfd запросов, eventfd ответов
+const int SHM_DESCRIPTORS = 3;
+// Печати размера области: без них сервер её не отображает
+const int SHM_REQUIRED_SEALS = F_SEAL_SHRINK | F_SEAL_GROW;
+
+// Пауза в цикле ожидания: процессор не забивает конвейер проверками
+static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    this_thread::yield();
+#endif
+}
+
+// Конструктор
+ShmChannel::ShmChannel()
+    : layout(nullptr), mappedSize(0), edgesOffset(0), edgesSize(0), memoryFd(-1), requestEvent(-1), responseEvent(-1),
+      spinLimit(thread::hardware_concurrency() > 1 ? SHM_SPIN_ITERATIONS : 0) {
+}
+
+// Деструктор
+ShmChannel::~ShmChannel() {
+    if (layout != nullptr) {
+        munmap(layout, mappedSize);
+    }
+    for (int fd : {memoryFd, requestEvent, responseEvent}) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+// Клиент: создаёт область и eventfd
+bool ShmChannel::create(size_t edgeBytes) {
+    memoryFd = memfd_create("graph-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memoryFd < 0) {
+        return false;
+    }
+    requestEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    responseEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (requestEvent < 0 || responseEvent < 0) {
+        return false;
+    }
+    return map(memoryFd, true, edgeBytes);
+}
+
+// Отображает область (и размечает её, если это клиент)
+bool ShmChannel::map(int fd, bool initialize, size_t edgeBytes) {
+    // Область рёбер - сразу после заголовка и колец, с выравниванием
+    size_t areaOffset = (sizeof(ShmLayout) + 63) / 64 * 64;
+    size_t totalSize;
+    if (initialize) {
+        totalSize = areaOffset + edgeBytes;
+        if (ftruncate(fd, static_cast<off_t>(totalSize)) < 0 ||
+            fcntl(fd, F_ADD_SEALS, SHM_REQUIRED_SEALS) < 0) {
+            return false;
+        }
+    } else {
+        // Размер незапечатанной области клиент может уменьшить в любой момент
+        int seals = fcntl(fd, F_GET_SEALS);
+        if (seals < 0 || (seals & SHM_REQUIRED_SEALS) != SHM_REQUIRED_SEALS) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) < 0 || static_cast<size_t>(info.st_size) < areaOffset) {
+            return false;
+        }
+        totalSize = static_cast<size_t>(info.st_size);
+    }
+
+    void* memory = mmap(nullptr, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+    layout = static_cast<ShmLayout*>(memory);
+    mappedSize = totalSize;
+
+    if (initialize) {
+        new (memory) ShmLayout();
+        layout->magic = SHM_MAGIC;
+        layout->version = SHM_VERSION;
+        layout->totalSize = totalSize;
+        layout->edgesOffset = areaOffset;
+        layout->edgesSize = edgeBytes;
+        edgesOffset = areaOffset;
+        edgesSize = edgeBytes;
+        return true;
+    }
+
+    // Сервер не доверяет разметке клиента: область рёбер должна лежать в
+    // области, и дальше используются только проверенные здесь границы
+    uint64_t claimedSize = layout->edgesSize;
+    if (layout->magic != SHM_MAGIC || layout->version != SHM_VERSION || layout->totalSize != totalSize ||
+        layout->edgesOffset != areaOffset || claimedSize > totalSize - areaOffset) {
+        return false;
+    }
+    edgesOffset = areaOffset;
+    edgesSize = static_cast<size_t>(claimedSize);
+    return true;
+}
+
+// Клиент: передаёт дескрипторы серверу
+bool ShmChannel::sendDescriptors(int socket) {
+    int descriptors[SHM_DESCRIPTORS] = {memoryFd, requestEvent, responseEvent};
+    char control[CMSG_SPACE(sizeof(descriptors))];
+    memset(control, 0, sizeof(control));
+
+    // Вместе с дескрипторами должен уйти хотя бы один байт данных
+    char marker = 'S';
+    iovec iov = {&marker, sizeof(marker)};
+    msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(descriptors));
+    memcpy(CMSG_DATA(header), descriptors, sizeof(descriptors));
+
+    return sendmsg(socket, &message, MSG_NOSIGNAL) == sizeof(marker);
+}
+
+// Сервер: получает дескрипторы и отображает область
+bool ShmChannel::receiveDescriptors(int socket) {
+    int descriptors[SHM_DESCRIPTORS];
+    char control[CMSG_SPACE(sizeof(descriptors))];
+    char marker;
+    iovec iov = {&marker, sizeof(marker)};
+    msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    if (recvmsg(socket, &message, MSG_CMSG_CLOEXEC) != sizeof(marker)) {
+        return false;
+    }
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    if (header == nullptr || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS ||
+        header->cmsg_len != CMSG_LEN(sizeof(descriptors))) {
+        return false;
+    }
+    memcpy(descriptors, CMSG_DATA(header), sizeof(descriptors));
+    memoryFd = descriptors[0];
+    requestEvent = descriptors[1];
+    responseEvent = descriptors[2];
+    return map(memoryFd, false, 0);
+}
+
+// Область рёбер
+char* ShmChannel::edgeArea() {
+    return reinterpret_cast<char*>(layout) + edgesOffset;
+}
+
+size_t ShmChannel::edgeAreaSize() const {
+    return edgesSize;
+}
+
+// Рёбра запроса
+const char* ShmChannel::edgesAt(uint64_t offset, uint64_t size) const {
+    if (offset > edgesSize || size > edgesSize - offset) {
+        return nullptr;
+    }
+    return reinterpret_cast<const char*>(layout) + edgesOffset + offset;
+}
+
+// Отдаёт ячейку читателю
+void ShmChannel::publish(ShmRingIndex& index, int eventFd) {
+    index.tail.store(index.tail.load(memory_order_relaxed) + 1, memory_order_release);
+    // Барьер между записью tail и чтением sleeping (пара к записи sleeping
+    // и чтению tail у читателя): иначе оба могут увидеть старые значения,
+    // и читатель уснёт, не получив сигнала
+    atomic_thread_fence(memory_order_seq_cst);
+    if (index.sleeping.load(memory_order_relaxed) != 0) {
+        uint64_t one = 1;
+        ssize_t written = write(eventFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+// Ждёт непустое кольцо
+bool ShmChannel::waitReadable(ShmRingIndex& index, int eventFd, int socket, int timeoutMs) {
+    auto readable = [&index] {
+        return index.head.load(memory_order_relaxed) != index.tail.load(memory_order_acquire);
+    };
+
+    // Быстрый путь: ответ или запрос вот-вот появится
+    for (int i = 0; i < spinLimit; i++) {
+        if (readable()) {
+            return true;
+        }
+        cpuRelax();
+    }
+
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+    while (true) {
+        index.sleeping.store(1, memory_order_seq_cst);
+        if (readable()) {
+            index.sleeping.store(0, memory_order_relaxed);
+            return true;
+        }
+
+        int wait = -1;
+        if (timeoutMs >= 0) {
+            auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+            wait = static_cast<int>(max<long long>(0, left.count()));
+        }
+        pollfd fds[2] = {{eventFd, POLLIN, 0}, {socket, POLLIN | POLLRDHUP, 0}};
+        int ready = poll(fds, 2, wait);
+        index.sleeping.store(0, memory_order_relaxed);
+        if (ready < 0 && errno != EINTR) {
+            return false;
+        }
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            uint64_t value;
+            ssize_t got = read(eventFd, &value, sizeof(value));
+            (void)got;
+        }
+        if (readable()) {
+            return true;
+        }
+        // После передачи дескрипторов по сокету ничего не приходит:
+        // событие на нём - закрытие другой стороной
+        if (ready > 0 && fds[1].revents != 0) {
+            return false;
+        }
+        if (ready == 0 || (timeoutMs >= 0 && chrono::steady_clock::now() >= deadline)) {
+            return false;
+        }
+    }
+}
+
+// Клиент: свободная ячейка запроса
+ShmRequestSlot* ShmChannel::requestSlot() {
+    ShmRingIndex& index = layout->requestIndex;
+    uint32_t tail = index.tail.load(memory_order_relaxed);
+    if (tail - index.head.load(memory_order_acquire) >= SHM_RING_SLOTS) {
+        return nullptr;
+    }
+    return &layout->requests[tail & (SHM_RING_SLOTS - 1)];
+}
+
+void ShmChannel::publishRequest() {
+    publish(layout->requestIndex, requestEvent);
+}
+
+// Сервер: ждёт запрос
+ShmRequestSlot* ShmChannel::waitRequest(int socket) {
+    ShmRingIndex& index = layout->requestIndex;
+    if (!waitReadable(index, requestEvent, socket, -1)) {
+        return nullptr;
+    }
+    return &layout->requests[index.head.load(memory_order_relaxed) & (SHM_RING_SLOTS - 1)];
+}
+
+void ShmChannel::releaseRequest() {
+    ShmRingIndex& index = layout->requestIndex;
+    index.head.store(index.head.load(memory_order_relaxed) + 1, memory_order_release);
+}
+
+// Сервер: свободная ячейка ответа
+ShmResponseSlot* ShmChannel::responseSlot() {
+    ShmRingIndex& index = layout->responseIndex;
+    uint32_t tail = index.tail.load(memory_order_relaxed);
+    if (tail - index.head.load(memory_order_acquire) >= SHM_RING_SLOTS) {
+        return nullptr;
+    }
+    return &layout->responses[tail & (SHM_RING_SLOTS - 1)];
+}
+
+void ShmChannel::publishResponse() {
+    publish(layout->responseIndex, responseEvent);
+}
+
+// Клиент: ждёт ответ
+ShmResponseSlot* ShmChannel::waitResponse(int socket, int timeoutMs) {
+    ShmRingIndex& index = layout->responseIndex;
+    if (!waitReadable(index, responseEvent, socket, timeoutMs)) {
+        return nullptr;
+    }
+    return &layout->responses[index.head.load(memory_order_relaxed) & (SHM_RING_SLOTS - 1)];
+}
+
+void ShmChannel::releaseResponse() {
+    ShmRingIndex& index = layout->responseIndex;
+    index.head.store(index.head.load(memory_order_relaxed) + 1, memory_order_release);
+}
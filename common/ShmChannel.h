@@ -0,0 +1,168 @@
+#ifndef SHM_CHANNEL_H
+#define SHM_CHANNEL_H
+
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <new>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+
+#include "../common/Protocol.h"
+
+using namespace std;
+
+// Канал в общей памяти между клиентом и сервером на одной машине
+
+// Клиент создаёт область памяти (memfd) и два eventfd и передаёт их
+// серверу по Unix-сокету (SCM_RIGHTS). Дальше запросы и ответы идут
+// через память без системных вызовов на каждый запрос:
+//   - кольцо запросов (клиент пишет, сервер читает) и кольцо ответов
+//     (сервер пишет, клиент читает) - оба SPSC: у каждого ровно один
+//     писатель и один читатель, поэтому хватает атомарных head/tail;
+//   - рёбра графа клиент один раз записывает в область рёбер, а в
+//     запросе передаёт только смещение и размер: сервер разбирает рёбра
+//     прямо из общей памяти, а повторный запрос к тому же графу ничего
+//     не копирует вовсе.
+// Ожидание: сначала читатель крутится (spin) короткое время - ответ на
+// горячий запрос приходит быстрее, чем поток успел бы уснуть, - затем
+// ставит флаг "сплю" и блокируется в poll на eventfd. Писатель будит
+// eventfd, только если читатель спит: в быстром режиме системных вызовов нет.
+// Unix-сокет остаётся открытым всё время работы: по нему каждая сторона
+// узнаёт, что другая завершилась (poll ждёт и eventfd, и сокет).
+// Клиент может писать в область когда угодно, поэтому сервер не доверяет
+// ей после проверки: границы области рёбер он запоминает у себя, а размер
+// memfd запечатан (F_SEAL_SHRINK, F_SEAL_GROW) - клиент не может уменьшить
+// файл под отображением сервера (SIGBUS при чтении).
+
+// Формат области (общий для клиента и сервера)
+
+// Число ячеек в каждом кольце (степень двойки)
+const uint32_t SHM_RING_SLOTS = 64;
+// Наибольший ответ (как кадр TCP)
+const size_t SHM_RESPONSE_CAPACITY = 4096;
+// Область рёбер по умолчанию
+const size_t SHM_DEFAULT_EDGE_BYTES = 4 * 1024 * 1024;
+
+// Запрос в кольце: ClientRequest и ссылка на рёбра в области рёбер
+struct ShmRequestSlot {
+    uint64_t edgesOffset;
+    uint64_t edgesSize;
+    uint32_t requestSize;
+    char request[REQUEST_SIZE];
+};
+
+// Ответ в кольце: байты ServerResponse
+struct ShmResponseSlot {
+    uint32_t size;
+    char data[SHM_RESPONSE_CAPACITY];
+};
+
+// Индексы кольца. Поля на разных строках кэша: писатель и читатель
+// не мешают друг другу (нет ложного разделения)
+struct ShmRingIndex {
+    alignas(64) atomic<uint32_t> head;     // Следующая ячейка читателя
+    alignas(64) atomic<uint32_t> tail;     // Следующая ячейка писателя
+    alignas(64) atomic<uint32_t> sleeping; // Читатель заблокирован в poll
+};
+
+// Начало области
+struct ShmLayout {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t totalSize;
+    uint64_t edgesOffset;  // Начало области рёбер (от начала области)
+    uint64_t edgesSize;
+    ShmRingIndex requestIndex;
+    ShmRingIndex responseIndex;
+    ShmRequestSlot requests[SHM_RING_SLOTS];
+    ShmResponseSlot responses[SHM_RING_SLOTS];
+};
+
+static_assert(atomic<uint32_t>::is_always_lock_free, "атомарные операции в общей памяти должны быть без блокировок");
+
+class ShmChannel {
+public:
+    ShmChannel();
+
+    // Деструктор - снимает отображение и закрывает дескрипторы
+    ~ShmChannel();
+
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+
+    // Клиент: создаёт область с edgeBytes байт под рёбра и eventfd
+    bool create(size_t edgeBytes);
+
+    // Клиент: передаёт область и eventfd серверу по Unix-сокету
+    bool sendDescriptors(int socket);
+
+    // Сервер: получает область и eventfd от клиента и отображает её
+    bool receiveDescriptors(int socket);
+
+    // Область рёбер (клиент пишет рёбра сюда)
+    char* edgeArea();
+    size_t edgeAreaSize() const;
+
+    // Рёбра запроса в области рёбер; nullptr, если ссылка выходит за область
+    const char* edgesAt(uint64_t offset, uint64_t size) const;
+
+    // Клиент: свободная ячейка запроса (nullptr, если кольцо заполнено)
+    ShmRequestSlot* requestSlot();
+    // Клиент: отдаёт заполненную ячейку серверу
+    void publishRequest();
+
+    // Сервер: ждёт запрос; nullptr, если клиент закрыл сокет
+    ShmRequestSlot* waitRequest(int socket);
+    // Сервер: освобождает прочитанную ячейку запроса
+    void releaseRequest();
+
+    // Сервер: свободная ячейка ответа (nullptr, если кольцо заполнено)
+    ShmResponseSlot* responseSlot();
+    // Сервер: отдаёт заполненный ответ клиенту
+    void publishResponse();
+
+    // Клиент: ждёт ответ не дольше timeoutMs; nullptr при таймауте
+    // или если сервер закрыл сокет
+    ShmResponseSlot* waitResponse(int socket, int timeoutMs);
+    // Клиент: освобождает прочитанную ячейку ответа
+    void releaseResponse();
+
+private:
+    ShmLayout* layout;
+    size_t mappedSize;
+    // Область рёбер, проверенная при отображении (поля layout клиент
+    // может изменить позже)
+    size_t edgesOffset;
+    size_t edgesSize;
+    int memoryFd;
+    int requestEvent;   // Будит сервер (есть запрос)
+    int responseEvent;  // Будит клиента (есть ответ)
+    // Сколько раз читатель проверяет кольцо, прежде чем уснуть
+    // (0 на одном процессоре: пока читатель крутится, писатель не работает)
+    int spinLimit;
+
+    // Отображает область и проверяет её формат
+    bool map(int fd, bool initialize, size_t edgeBytes);
+
+    // Отдаёт ячейку читателю и будит его, если он спит
+    static void publish(ShmRingIndex& index, int eventFd);
+
+    // Ждёт непустое кольцо: spin, затем poll на eventfd и сокете
+    // false при таймауте или закрытом сокете
+    bool waitReadable(ShmRingIndex& index, int eventFd, int socket, int timeoutMs);
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef SOCKET_ADDRESS_H
+#define SOCKET_ADDRESS_H
+
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// Адрес сокета любого семейства (AF_INET или AF_UNIX) вместе с длиной
+
+// Длина нужна для AF_UNIX: у безымянного (абстрактного) адреса имя
+// ограничено длиной, а не нулевым байтом, и sendto с другой длиной
+// отправит пакет по другому адресу
+
+// Адрес Unix-сокета в командной строке - "unix:/путь/к/сокету"
+const std::string UNIX_ADDRESS_PREFIX = "unix:";
+
+struct SocketAddress {
+    sockaddr_storage storage;
+    socklen_t length;
+
+    SocketAddress() : length(sizeof(storage)) {
+        memset(&storage, 0, sizeof(storage));
+    }
+
+    sockaddr* get() {
+        return reinterpret_cast<sockaddr*>(&storage);
+    }
+
+    const sockaddr* get() const {
+        return reinterpret_cast<const sockaddr*>(&storage);
+    }
+
+    int family() const {
+        return storage.ss_family;
+    }
+
+    // Адрес IPv4
+    static SocketAddress inet(const sockaddr_in& addr) {
+        SocketAddress address;
+        memcpy(&address.storage, &addr, sizeof(addr));
+        address.length = sizeof(addr);
+        return address;
+    }
+
+    // Адрес Unix-сокета по пути файла
+    // false, если путь пустой или не помещается в sun_path
+    static bool unixPath(const std::string& path, SocketAddress& address) {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, path.data(), path.size());
+        address = SocketAddress();
+        memcpy(&address.storage, &addr, sizeof(addr));
+        address.length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() + 1);
+        return true;
+    }
+
+    // Строка для лога и ключей клиентов: "IP:порт", "unix:путь" или
+    // "unix:@имя" для абстрактного адреса
+    std::string toString() const {
+        if (family() == AF_INET) {
+            const sockaddr_in* addr = reinterpret_cast<const sockaddr_in*>(&storage);
+            char ip[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &addr->sin_addr, ip, INET_ADDRSTRLEN);
+            return std::string(ip) + ":" + std::to_string(ntohs(addr->sin_port));
+        }
+        if (family() == AF_UNIX) {
+            const sockaddr_un* addr = reinterpret_cast<const sockaddr_un*>(&storage);
+            size_t offset = offsetof(sockaddr_un, sun_path);
+            if (length <= offset) {
+                return UNIX_ADDRESS_PREFIX + "(без имени)";
+            }
+            size_t size = length - offset;
+            if (addr->sun_path[0] == '\0') {
+                return UNIX_ADDRESS_PREFIX + "@" + std::string(addr->sun_path + 1, size - 1);
+            }
+            return UNIX_ADDRESS_PREFIX + std::string(addr->sun_path, strnlen(addr->sun_path, size));
+        }
+        return "?";
+    }
+};
+
+// Задан ли адрес Unix-сокета ("unix:/путь")
+inline bool isUnixAddress(const std::string& text) {
+    return text.compare(0, UNIX_ADDRESS_PREFIX.size(), UNIX_ADDRESS_PREFIX) == 0;
+}
+
+// Путь из адреса "unix:/путь"
+inline std::string unixAddressPath(const std::string& text) {
+    return text.substr(UNIX_ADDRESS_PREFIX.size());
+}
+
+#endif
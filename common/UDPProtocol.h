@@ -8,7 +8,10 @@
 // Типы UDP-сообщений
 enum UDPPacketType : uint8_t {
     PACKET_DATA = 0,    // Полезная нагрузка (запрос/ответ)
-    PACKET_ACK = 1      // Подтверждение получения
+    PACKET_ACK = 1,     // Подтверждение получения
+    // Надёжный канал с окном (ReliableChannel)
+    PACKET_SEGMENT = 2, // Сегмент: packet_id - номер сегмента в канале
+    PACKET_SACK = 3     // Подтверждение: packet_id - следующий ожидаемый номер
 };
 
 // Структура заголовка UDP-пакета
@@ -43,8 +46,13 @@ namespace UDPProtocol {
         header.packet_id = packet_id;
         header.data_len = payload.size();
         
-        std::vector<char> packet = header.serialize();
-        packet.insert(packet.end(), payload.begin(), payload.end());
+        // Пакет собирается в буфере полного размера сразу (без insert:
+        // на -O3 GCC видит выход за границы в недостроенном векторе)
+        std::vector<char> packet(sizeof(header) + payload.size());
+        memcpy(packet.data(), &header, sizeof(header));
+        if (!payload.empty()) {
+            memcpy(packet.data() + sizeof(header), payload.data(), payload.size());
+        }
         return packet;
     }
     
@@ -57,6 +65,42 @@ namespace UDPProtocol {
         return header.serialize();
     }
     
+    // Создаёт сегмент канала: данные начинаются с ID канала
+    inline std::vector<char> createSegmentPacket(uint32_t seq, uint32_t channel_id,
+                                                 const std::vector<char>& message) {
+        UDPPacketHeader header;
+        header.type = PACKET_SEGMENT;
+        header.packet_id = seq;
+        header.data_len = sizeof(channel_id) + message.size();
+
+        std::vector<char> packet(sizeof(header) + header.data_len);
+        memcpy(packet.data(), &header, sizeof(header));
+        memcpy(packet.data() + sizeof(header), &channel_id, sizeof(channel_id));
+        if (!message.empty()) {
+            memcpy(packet.data() + sizeof(header) + sizeof(channel_id), message.data(), message.size());
+        }
+        return packet;
+    }
+
+    // Создаёт подтверждение канала: все сегменты до next_seq получены,
+    // бит i карты - получен сегмент next_seq + 1 + i
+    inline std::vector<char> createSackPacket(uint32_t next_seq, uint32_t channel_id,
+                                              const std::vector<uint8_t>& bitmap) {
+        UDPPacketHeader header;
+        header.type = PACKET_SACK;
+        header.packet_id = next_seq;
+        header.data_len = sizeof(channel_id) + bitmap.size();
+
+        std::vector<char> packet = header.serialize();
+        size_t offset = packet.size();
+        packet.resize(offset + header.data_len);
+        memcpy(packet.data() + offset, &channel_id, sizeof(channel_id));
+        if (!bitmap.empty()) {
+            memcpy(packet.data() + offset + sizeof(channel_id), bitmap.data(), bitmap.size());
+        }
+        return packet;
+    }
+
     // Парсит пакет и извлекает заголовок + данные
     inline std::pair<UDPPacketHeader, std::vector<char>> parsePacket(const std::vector<char>& packet) {
         if (packet.size() < sizeof(UDPPacketHeader)) {
@@ -0,0 +1,256 @@
+#include "../server/ChannelTable.h"
+
+using namespace std;
+
+// Канал без неподтверждённых сообщений удаляется после стольких секунд тишины
+const auto CHANNEL_IDLE_TIMEOUT = chrono::seconds(30);
+// Как часто искать молчащие каналы
+const auto IDLE_SWEEP_INTERVAL = chrono::seconds(1);
+// Колесо таймеров: шаг (точность таймеров, как PACING_SLACK канала) и
+// число слотов - оборот колеса покрывает обычные RTO без перестановок
+const auto TIMER_TICK = chrono::milliseconds(1);
+const size_t TIMER_WHEEL_SLOTS = 512;
+
+// Конструктор (поток таймеров запускает start)
+ChannelTable::ChannelTable()
+    : window(DEFAULT_CHANNEL_WINDOW), running(false), timerWakeAt(Clock::time_point::max()),
+      wheel(TIMER_WHEEL_SLOTS), wheelCursor(0) {
+}
+
+// Деструктор
+ChannelTable::~ChannelTable() {
+    stop();
+}
+
+// Запускает поток таймеров
+void ChannelTable::start(size_t channelWindow) {
+    lock_guard<mutex> lock(tableMutex);
+    if (running) {
+        return;
+    }
+    window = channelWindow;
+    running = true;
+    wheelTime = Clock::now();
+    nextSweep = wheelTime + IDLE_SWEEP_INTERVAL;
+    timerThread = thread(&ChannelTable::timerLoop, this);
+}
+
+// Останавливает поток таймеров
+void ChannelTable::stop() {
+    {
+        lock_guard<mutex> lock(tableMutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    timerWake.notify_all();
+    if (timerThread.joinable()) {
+        timerThread.join();
+    }
+    lock_guard<mutex> lock(tableMutex);
+    channels.clear();
+    for (auto& slot : wheel) {
+        slot.clear();
+    }
+}
+
+// Пакет канала от клиента
+void ChannelTable::receive(const string& clientKey, const UDPPacketHeader& header, const vector<char>& payload,
+                           const Sender& send, const Deliver& deliver) {
+    uint32_t channelId = ReliableChannel::idOf(payload);
+    if (channelId == 0) {
+        return;
+    }
+
+    // Сообщения выдаются и пакеты отправляются после мьютекса: deliver
+    // ставит запрос в очередь
+    vector<pair<uint32_t, vector<char>>> ready;
+    Outbox outbox;
+    {
+        lock_guard<mutex> lock(tableMutex);
+        Entry& entry = channels[clientKey];
+        if (!entry.channel || entry.channel->id() != channelId) {
+            // Подтверждение чужого канала - остаток прошлого подключения
+            if (header.type != PACKET_SEGMENT) {
+                if (!entry.channel) {
+                    channels.erase(clientKey);
+                }
+                return;
+            }
+            if (entry.channel) {
+                LOG_INFO("Клиент ", clientKey, " открыл новый канал");
+            }
+            entry.channel = make_unique<ReliableChannel>(channelId, make_shared<RttEstimator>(), window);
+        }
+        entry.send = send;
+        entry.lastActivity = Clock::now();
+        run(entry, outbox, [&](const ReliableChannel::Sender& sender) {
+            entry.channel->receive(header, payload, sender, [&ready](uint32_t seq, vector<char>& message) {
+                ready.emplace_back(seq, move(message));
+            });
+        });
+        // Подтверждение могло освободить окно, и новые сегменты ушли с таймерами
+        schedule(clientKey, entry);
+    }
+
+    flush(outbox);
+    for (auto& [seq, message] : ready) {
+        deliver(channelId, seq, message);
+    }
+}
+
+// Отправляет сообщение клиенту
+bool ChannelTable::send(const string& clientKey, uint32_t channelId, const vector<char>& message) {
+    Outbox outbox;
+    {
+        lock_guard<mutex> lock(tableMutex);
+        auto found = channels.find(clientKey);
+        if (found == channels.end() || found->second.channel->id() != channelId) {
+            return false;
+        }
+        Entry& entry = found->second;
+        run(entry, outbox, [&](const ReliableChannel::Sender& sender) {
+            entry.channel->send(message, sender);
+        });
+        schedule(clientKey, entry);
+    }
+    flush(outbox);
+    return true;
+}
+
+// Сколько каналов открыто
+size_t ChannelTable::size() {
+    lock_guard<mutex> lock(tableMutex);
+    return channels.size();
+}
+
+// Вызывает метод канала, собирая отправленные пакеты в пачку
+template <typename Action>
+void ChannelTable::run(Entry& entry, Outbox& outbox, Action action) {
+    vector<vector<char>> packets;
+    action([&packets](const vector<char>& packet) {
+        packets.push_back(packet);
+        return true;
+    });
+    if (!packets.empty()) {
+        outbox.emplace_back(entry.send, move(packets));
+    }
+}
+
+// Отправляет собранные пачки
+void ChannelTable::flush(Outbox& outbox) {
+    // Ошибка отправки - то же, что потеря: пакеты повторят таймеры каналов
+    for (auto& [send, packets] : outbox) {
+        send(packets);
+    }
+    outbox.clear();
+}
+
+// Ставит таймер канала в колесо
+void ChannelTable::schedule(const string& clientKey, Entry& entry) {
+    auto deadline = entry.channel->nextDeadline();
+    if (deadline == Clock::time_point::max()) {
+        return;
+    }
+    // Слот - первый, наступающий не раньше таймера (слоты позади уже
+    // пройдены - таймер сработает в текущем)
+    auto ticks = deadline > wheelTime ? (deadline - wheelTime + TIMER_TICK - Clock::duration(1)) / TIMER_TICK : 0;
+    size_t offset = static_cast<size_t>(min<decltype(ticks)>(ticks, TIMER_WHEEL_SLOTS - 1));
+    auto slotTime = wheelTime + TIMER_TICK * static_cast<int64_t>(offset);
+    // Канал уже ждёт в слоте не позже - сработает там и переставится
+    if (entry.scheduledFor <= slotTime) {
+        return;
+    }
+    entry.scheduledFor = slotTime;
+    wheel[(wheelCursor + offset) % TIMER_WHEEL_SLOTS].push_back(clientKey);
+    if (slotTime < timerWakeAt) {
+        timerWake.notify_one();
+    }
+}
+
+// Срабатывают таймеры канала
+void ChannelTable::fire(const string& clientKey, Outbox& outbox) {
+    auto found = channels.find(clientKey);
+    if (found == channels.end()) {
+        return;
+    }
+    Entry& entry = found->second;
+    run(entry, outbox, [&](const ReliableChannel::Sender& sender) {
+        entry.channel->onTimer(sender);
+    });
+    if (entry.channel->failed()) {
+        Logger::warning("Потеряна связь с клиентом " + clientKey + " (канал UDP)");
+        channels.erase(found);
+        return;
+    }
+    schedule(clientKey, entry);
+}
+
+// Удаляет молчащие каналы
+void ChannelTable::sweepIdle(Clock::time_point now) {
+    for (auto it = channels.begin(); it != channels.end(); ) {
+        Entry& entry = it->second;
+        if (entry.channel->unacked() == 0 && now - entry.lastActivity > CHANNEL_IDLE_TIMEOUT) {
+            it = channels.erase(it);
+            continue;
+        }
+        ++it;
+    }
+}
+
+// Ближайший непустой слот
+ChannelTable::Clock::time_point ChannelTable::nextWake() const {
+    for (size_t offset = 0; offset < TIMER_WHEEL_SLOTS; offset++) {
+        auto slotTime = wheelTime + TIMER_TICK * static_cast<int64_t>(offset);
+        if (slotTime >= nextSweep) {
+            break;
+        }
+        if (!wheel[(wheelCursor + offset) % TIMER_WHEEL_SLOTS].empty()) {
+            return slotTime;
+        }
+    }
+    return nextSweep;
+}
+
+// Поток таймеров
+void ChannelTable::timerLoop() {
+    unique_lock<mutex> lock(tableMutex);
+    Outbox outbox;
+    while (running) {
+        auto now = Clock::now();
+        // Наступившие слоты по порядку. Слот забирается до обработки и
+        // колесо сдвигается: таймер, снова наступивший сразу, попадёт в
+        // следующий слот, а не в обрабатываемый
+        while (wheelTime <= now) {
+            vector<string> due;
+            due.swap(wheel[wheelCursor]);
+            wheelCursor = (wheelCursor + 1) % TIMER_WHEEL_SLOTS;
+            auto slotTime = wheelTime;
+            wheelTime += TIMER_TICK;
+            for (const string& clientKey : due) {
+                auto found = channels.find(clientKey);
+                // Запись устарела: канал переставлен в другой слот или удалён
+                if (found == channels.end() || found->second.scheduledFor != slotTime) {
+                    continue;
+                }
+                found->second.scheduledFor = Clock::time_point::max();
+                fire(clientKey, outbox);
+            }
+        }
+        if (now >= nextSweep) {
+            sweepIdle(now);
+            nextSweep = now + IDLE_SWEEP_INTERVAL;
+        }
+        // Повторы уходят без мьютекса; пока они отправлялись, могли
+        // наступить новые слоты - колесо проверяется снова
+        if (!outbox.empty()) {
+            lock.unlock();
+            flush(outbox);
+            lock.lock();
+            continue;
+        }
+        timerWakeAt = nextWake();
+        timerWake.wait_until(lock, timerWakeAt);
+    }
+}
@@ -0,0 +1,133 @@
+#ifndef CHANNEL_TABLE_H
+#define CHANNEL_TABLE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+#include "../common/ReliableChannel.h"
+#include "../common/RttEstimator.h"
+#include "../utils/Logger.h"
+
+using namespace std;
+
+// Надёжные каналы UDP-клиентов сервера (ReliableChannel)
+
+// У каждого клиента (адреса) свой канал: запросы приходят по нему
+// сегментами, ответы уходят сегментами с повтором до подтверждения.
+// Пакеты приходят в цикле приёма UDP (recvfrom или io_uring), ответы
+// отправляют обработчики очереди запросов, а таймеры повтора ведёт
+// отдельный поток - поэтому все каналы под одним мьютексом.
+
+// Канал клиента заменяется новым, если с того же адреса пришёл сегмент
+// с другим ID (клиент перезапущен), и удаляется, если связь потеряна или
+// клиент долго молчит и ничего не ждёт подтверждения.
+
+// Таймеры каналов (повторы и темп отправки) - в колесе таймеров: слот на
+// каждые TIMER_TICK, поток таймеров обходит только наступившие слоты, а не
+// все каналы. Таймер дальше оборота колеса ставится в последний слот и
+// переставляется, когда тот наступит. Канал может оказаться в нескольких
+// слотах (таймер стал ближе) - срабатывает только запись с его текущим
+// временем (scheduledFor), остальные пропускаются.
+
+// Пакеты, которые канал отправил за один вызов (SACK, повторы, новые
+// сегменты), уходят клиенту пачкой - одним системным вызовом (sendmmsg).
+// Пачки собираются под мьютексом, а отправляются после него: медленная
+// отправка одному клиенту не задерживает пакеты и таймеры остальных.
+class ChannelTable {
+public:
+    // Отправка пачки пакетов клиенту
+    using Sender = function<bool(const vector<vector<char>>& packets)>;
+    // Очередное сообщение клиента: ID канала и номер сегмента нужны,
+    // чтобы отправить ответ (send) в тот же канал
+    using Deliver = function<void(uint32_t channelId, uint32_t seq, vector<char>& message)>;
+
+    ChannelTable();
+
+    // Деструктор: останавливает поток таймеров
+    ~ChannelTable();
+
+    // Запускает поток таймеров; window - окно каналов
+    void start(size_t window);
+
+    // Останавливает поток таймеров и удаляет каналы
+    void stop();
+
+    // Пакет канала от клиента (PACKET_SEGMENT или PACKET_SACK)
+    // clientKey Адрес клиента ("IP:порт")
+    // send Отправка пакетов этому клиенту (сохраняется для повторов и темпа)
+    // deliver Вызывается для каждого нового по порядку сообщения (вне мьютекса)
+    void receive(const string& clientKey, const UDPPacketHeader& header, const vector<char>& payload,
+                 const Sender& send, const Deliver& deliver);
+
+    // Отправляет сообщение клиенту
+    // false, если канала уже нет (клиент перезапущен или связь потеряна)
+    bool send(const string& clientKey, uint32_t channelId, const vector<char>& message);
+
+    // Сколько каналов открыто
+    size_t size();
+
+private:
+    using Clock = chrono::steady_clock;
+
+    struct Entry {
+        unique_ptr<ReliableChannel> channel;
+        Sender send;
+        Clock::time_point lastActivity;
+        // Время слота колеса, в котором ждёт канал (max() - ни в каком)
+        Clock::time_point scheduledFor = Clock::time_point::max();
+    };
+
+    mutex tableMutex;
+    condition_variable timerWake;
+    map<string, Entry> channels;
+    size_t window;
+    bool running;
+    thread timerThread;
+    // Когда проснётся поток таймеров: будим раньше, только если таймер
+    // канала стал ближе
+    Clock::time_point timerWakeAt;
+
+    // Колесо таймеров: wheel[wheelCursor] - слот времени wheelTime,
+    // следующий - wheelTime + TIMER_TICK и так по кругу
+    vector<vector<string>> wheel;
+    size_t wheelCursor;
+    Clock::time_point wheelTime;
+    // Когда искать молчащие каналы
+    Clock::time_point nextSweep;
+
+    // Пачки пакетов, ждущие отправки после мьютекса
+    using Outbox = vector<pair<Sender, vector<vector<char>>>>;
+
+    // Вызывает метод канала и кладёт всё, что он отправил, пачкой в outbox
+    template <typename Action>
+    void run(Entry& entry, Outbox& outbox, Action action);
+
+    // Отправляет собранные пачки (вне мьютекса)
+    static void flush(Outbox& outbox);
+
+    // Ставит таймер канала в колесо (под мьютексом); будит поток таймеров,
+    // если таймер ближе, чем тот собирался проснуться
+    void schedule(const string& clientKey, Entry& entry);
+
+    // Срабатывают таймеры канала: повторы и отложенные темпом сегменты
+    void fire(const string& clientKey, Outbox& outbox);
+
+    // Удаляет молчащие каналы
+    void sweepIdle(Clock::time_point now);
+
+    // Время ближайшего непустого слота (или поиска молчащих каналов)
+    Clock::time_point nextWake() const;
+
+    // Повторы по таймерам и удаление потерянных и молчащих каналов
+    void timerLoop();
+};
+
+#endif
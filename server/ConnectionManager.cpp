@@ -0,0 +1,183 @@
+#include "../server/ConnectionManager.h"
+
+using namespace std;
+
+// Добавляет слот в начало списка
+void ConnectionManager::SlotList::push(Slot* slot) {
+    slot->prev = nullptr;
+    slot->next = head;
+    if (head != nullptr) {
+        head->prev = slot;
+    }
+    head = slot;
+    size++;
+}
+
+// Убирает слот из списка (слот должен в нём быть)
+void ConnectionManager::SlotList::remove(Slot* slot) {
+    if (slot->prev != nullptr) {
+        slot->prev->next = slot->next;
+    } else {
+        head = slot->next;
+    }
+    if (slot->next != nullptr) {
+        slot->next->prev = slot->prev;
+    }
+    slot->prev = nullptr;
+    slot->next = nullptr;
+    size--;
+}
+
+// Забирает первый слот списка (nullptr, если список пуст)
+ConnectionManager::Slot* ConnectionManager::SlotList::pop() {
+    Slot* slot = head;
+    if (slot != nullptr) {
+        remove(slot);
+    }
+    return slot;
+}
+
+// Конструктор менеджера
+ConnectionManager::ConnectionManager(Handler handler)
+    : handler(move(handler)), maxConnections(SIZE_MAX), pooledThreads(0),
+      stopping(false), reused(0), started(0) {
+}
+
+// Деструктор
+ConnectionManager::~ConnectionManager() {
+    stop();
+}
+
+// Задаёт ограничения
+void ConnectionManager::configure(size_t maxConnections, size_t pooledThreads) {
+    lock_guard<mutex> lock(managerMutex);
+    this->maxConnections = maxConnections;
+    this->pooledThreads = pooledThreads;
+}
+
+// Передаёт подключение потоку
+bool ConnectionManager::admit(int socket) {
+    lock_guard<mutex> lock(managerMutex);
+    if (stopping || busy.size >= maxConnections) {
+        return false;
+    }
+    reapFinished();
+
+    // Есть поток, ждущий подключения, - отдаём подключение ему
+    Slot* slot = idle.pop();
+    if (slot != nullptr) {
+        slot->socket = socket;
+        busy.push(slot);
+        slot->wake.notify_one();
+        reused++;
+        return true;
+    }
+
+    // Иначе новый поток в освободившемся (или новом) слоте
+    slot = freeSlots.pop();
+    if (slot == nullptr) {
+        storage.push_back(make_unique<Slot>());
+        slot = storage.back().get();
+    }
+    slot->socket = socket;
+    busy.push(slot);
+    try {
+        slot->worker = thread(&ConnectionManager::workerLoop, this, slot);
+    } catch (const system_error&) {
+        // Система не даёт создать поток - подключение не принимается
+        busy.remove(slot);
+        slot->socket = -1;
+        freeSlots.push(slot);
+        return false;
+    }
+    started++;
+    return true;
+}
+
+// Закрывает все подключения и дожидается всех потоков
+void ConnectionManager::stop() {
+    {
+        lock_guard<mutex> lock(managerMutex);
+        if (stopping) {
+            return;
+        }
+        stopping = true;
+
+        // Потоки подключений заблокированы в recv - shutdown их будит
+        // (сокеты ещё открыты: менеджер закрывает их только под этим мьютексом)
+        for (Slot* slot = busy.head; slot != nullptr; slot = slot->next) {
+            shutdown(slot->socket, SHUT_RDWR);
+        }
+        for (Slot* slot = idle.head; slot != nullptr; slot = slot->next) {
+            slot->wake.notify_one();
+        }
+    }
+
+    // Новые слоты после stopping не появляются - storage больше не меняется
+    for (auto& slot : storage) {
+        if (slot->worker.joinable()) {
+            slot->worker.join();
+        }
+    }
+}
+
+// Живых подключений
+size_t ConnectionManager::active() {
+    lock_guard<mutex> lock(managerMutex);
+    return busy.size;
+}
+
+// Потоков (занятых и ждущих)
+size_t ConnectionManager::threads() {
+    lock_guard<mutex> lock(managerMutex);
+    return busy.size + idle.size;
+}
+
+// Сколько подключений получили уже работающий поток
+uint64_t ConnectionManager::getReused() const {
+    return reused.load();
+}
+
+// Сколько потоков создано
+uint64_t ConnectionManager::getStarted() const {
+    return started.load();
+}
+
+// Главный цикл потока слота
+void ConnectionManager::workerLoop(Slot* slot) {
+    unique_lock<mutex> lock(managerMutex);
+    while (true) {
+        slot->wake.wait(lock, [this, slot] { return slot->socket >= 0 || stopping; });
+        if (slot->socket < 0) {
+            // Сервер останавливается, а поток ждал подключения
+            idle.remove(slot);
+            finished.push(slot);
+            return;
+        }
+
+        int socket = slot->socket;
+        lock.unlock();
+        handler(socket);
+        lock.lock();
+
+        slot->socket = -1;
+        close(socket);
+        busy.remove(slot);
+
+        // Поток остаётся ждать следующего подключения, если ждущих ещё мало
+        if (!stopping && idle.size < pooledThreads) {
+            idle.push(slot);
+            continue;
+        }
+        finished.push(slot);
+        return;
+    }
+}
+
+// Присоединяет завершившиеся потоки
+void ConnectionManager::reapFinished() {
+    while (Slot* slot = finished.pop()) {
+        slot->worker.join();
+        freeSlots.push(slot);
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef CONNECTION_MANAGER_H
+#define CONNECTION_MANAGER_H
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <system_error>
+#include <cstdint>
+#include <cstddef>
+#include <unistd.h>
+#include <sys/socket.h>
+
+using namespace std;
+
+// Потоки TCP-подключений сервера
+
+// Каждое подключение обслуживает свой поток (handler читает запросы до
+// закрытия соединения). Поток и его данные - это "слот". Слоты лежат в
+// интрусивных списках (указатели prev/next внутри самого слота, без
+// выделения памяти на узлы):
+//   busy     - слоты с живым подключением (их не больше maxConnections);
+//   idle     - потоки, которые закончили подключение и ждут следующего;
+//   finished - потоки, которые завершились и ещё не присоединены (join);
+//   free     - слоты без потока, готовые к повторному использованию.
+// Завершившиеся потоки присоединяются при следующем подключении, так что
+// ни потоки, ни объекты thread не копятся, сколько бы подключений ни было.
+
+// Гибридный режим: до pooledThreads потоков после конца подключения не
+// завершаются, а ждут следующего - короткие подключения обслуживаются
+// готовым потоком без создания нового. Если свободных потоков нет,
+// подключение получает новый поток (пока не достигнут maxConnections),
+// а лишние потоки после конца подключения завершаются.
+// pooledThreads = 0 - новый поток на каждое подключение.
+
+// Сокет подключения закрывает менеджер (после возврата из handler):
+// так stop() может разбудить потоки, заблокированные в recv, через
+// shutdown, не рискуя задеть чужой сокет с тем же номером.
+
+class ConnectionManager {
+public:
+    // Обработчик подключения: работает, пока соединение нужно, сокет не закрывает
+    using Handler = function<void(int socket)>;
+
+    explicit ConnectionManager(Handler handler);
+
+    // Деструктор: останавливает все потоки
+    ~ConnectionManager();
+
+    // Задаёт ограничения (вызывать до первого admit)
+    // maxConnections Наибольшее число одновременных подключений
+    // pooledThreads Сколько потоков ждёт следующего подключения
+    void configure(size_t maxConnections, size_t pooledThreads);
+
+    // Передаёт подключение потоку
+    // false, если подключений уже maxConnections (сокет остаётся у вызывающего)
+    bool admit(int socket);
+
+    // Закрывает все подключения и дожидается всех потоков
+    void stop();
+
+    // Живых подключений
+    size_t active();
+
+    // Потоков (занятых и ждущих подключения)
+    size_t threads();
+
+    // Сколько раз подключение получил уже работающий поток
+    uint64_t getReused() const;
+
+    // Сколько потоков создано
+    uint64_t getStarted() const;
+
+private:
+    struct Slot {
+        thread worker;
+        int socket = -1;           // Сокет текущего подключения (-1 - нет)
+        condition_variable wake;   // Сигнал ждущему потоку: есть подключение или остановка
+        Slot* prev = nullptr;
+        Slot* next = nullptr;
+    };
+
+    // Интрусивный двусвязный список слотов
+    struct SlotList {
+        Slot* head = nullptr;
+        size_t size = 0;
+
+        void push(Slot* slot);
+        void remove(Slot* slot);
+        Slot* pop();
+    };
+
+    Handler handler;
+    size_t maxConnections;
+    size_t pooledThreads;
+
+    mutex managerMutex;
+    bool stopping;
+    SlotList busy;
+    SlotList idle;
+    SlotList finished;
+    SlotList freeSlots;
+    // Владение слотами; их число ограничено наибольшим числом потоков за всё время
+    vector<unique_ptr<Slot>> storage;
+
+    atomic<uint64_t> reused;
+    atomic<uint64_t> started;
+
+    // Главный цикл потока слота
+    void workerLoop(Slot* slot);
+
+    // Присоединяет завершившиеся потоки и возвращает их слоты в free
+    // (вызывается под managerMutex; join быстрый - потоки уже вышли из цикла)
+    void reapFinished();
+};
+
+#endif
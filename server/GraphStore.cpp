@@ -0,0 +1,220 @@
+#include "../server/GraphStore.h"
+
+using namespace std;
+
+// Сколько ориентиров ALT выбирать для каждого графа
+const int ALT_LANDMARK_COUNT = 4;
+// После скольких запросов к графу строить для него иерархию сжатий
+const int CH_BUILD_THRESHOLD = 2;
+
+// Лежат ли вершины в одной компоненте связности
+bool StoredGraph::connected(int a, int b) const {
+    int n = static_cast<int>(components.size());
+    if (a < 0 || b < 0 || a >= n || b >= n) {
+        return false;
+    }
+    return components[a] == components[b];
+}
+
+// Готовая иерархия сжатий или nullptr
+shared_ptr<const ContractionHierarchy> StoredGraph::getHierarchy() const {
+    return atomic_load(&hierarchy);
+}
+
+// Строит и проверяет граф по рёбрам
+shared_ptr<StoredGraph> StoredGraph::build(uint64_t hash, GraphSignature signature,
+                                           const pmr::vector<Edge>& edges,
+                                           DisjointSet& dsu) {
+    auto stored = make_shared<StoredGraph>();
+    stored->hash = hash;
+    stored->signature = move(signature);
+
+    try {
+        stored->graph.addEdges(edges);
+    } catch (const std::exception& e) {
+        stored->errorCode = INVALID_REQUEST;
+        stored->errorMessage = string("Ошибка при построении графа: ") + e.what();
+        return stored;
+    }
+
+    if (!stored->graph.hasMinimumSize()) {
+        stored->errorCode = INVALID_REQUEST;
+        stored->errorMessage = "Граф не соответствует минимальному размеру";
+        return stored;
+    }
+
+    if (!stored->graph.hasMaximumSize()) {
+        stored->errorCode = INVALID_REQUEST;
+        stored->errorMessage = "Граф превышает максимальный размер";
+        return stored;
+    }
+
+    if (!stored->graph.hasValidWeights()) {
+        stored->errorCode = INVALID_REQUEST;
+        stored->errorMessage = "Веса рёбер должны быть неотрицательными числами";
+        return stored;
+    }
+
+    int maxNode = 0;
+    for (const auto& edge : edges) {
+        if (edge.from < 0 || edge.to < 0) {
+            stored->errorCode = INVALID_REQUEST;
+            stored->errorMessage = "Номера вершин должны быть неотрицательными";
+            return stored;
+        }
+        // Поиск выделяет память по наибольшему номеру вершины
+        if (edge.from >= MAX_GRAPH_VERTICES || edge.to >= MAX_GRAPH_VERTICES) {
+            stored->errorCode = INVALID_REQUEST;
+            stored->errorMessage = "Номера вершин должны быть меньше " + to_string(MAX_GRAPH_VERTICES);
+            return stored;
+        }
+        maxNode = max(maxNode, max(edge.from, edge.to));
+    }
+
+    stored->search = Dijkstra(maxNode + 1);
+    for (const auto& edge : edges) {
+        stored->search.addEdge(edge.from, edge.to, edge.weight);
+        stored->search.addEdge(edge.to, edge.from, edge.weight);
+    }
+
+    // Union-find уже заполнен при разборе рёбер, осталось снять метки
+    stored->components = dsu.componentLabels();
+
+    // Ориентиры для A*: граф хранится и переиспользуется, поэтому
+    // K обходов при построении окупаются на следующих запросах
+    stored->landmarks.build(stored->search, ALT_LANDMARK_COUNT);
+    return stored;
+}
+
+// Конструктор хранилища
+GraphStore::GraphStore(size_t capacity)
+    : capacity(capacity), builderRunning(true), hierarchiesBuilt(0) {
+    builderThread = thread(&GraphStore::builderLoop, this);
+}
+
+// Деструктор: останавливаем фоновый поток
+GraphStore::~GraphStore() {
+    {
+        lock_guard<mutex> lock(builderMutex);
+        builderRunning = false;
+    }
+    builderCondition.notify_all();
+    if (builderThread.joinable()) {
+        builderThread.join();
+    }
+}
+
+// Ищет граф по хэшу
+shared_ptr<const StoredGraph> GraphStore::find(uint64_t hash, const GraphSignature& signature) {
+    lock_guard<mutex> lock(storeMutex);
+
+    auto it = index.find(hash);
+    if (it == index.end() || (*it->second)->signature != signature) {
+        return nullptr;
+    }
+
+    // Граф снова понадобился - переносим в начало списка
+    lru.splice(lru.begin(), lru, it->second);
+    return *it->second;
+}
+
+// Сохраняет граф
+shared_ptr<const StoredGraph> GraphStore::insert(shared_ptr<const StoredGraph> stored) {
+    lock_guard<mutex> lock(storeMutex);
+
+    auto it = index.find(stored->hash);
+    if (it != index.end()) {
+        // Тот же хэш у другого графа - ответ строится по своему графу
+        if ((*it->second)->signature != stored->signature) {
+            return stored;
+        }
+        return *it->second;
+    }
+
+    lru.push_front(stored);
+    index[stored->hash] = lru.begin();
+
+    // Вытесняем самые старые графы. Потоки, которые ещё работают с ними,
+    // держат свои shared_ptr, так что граф удалится после их завершения
+    while (lru.size() > capacity) {
+        index.erase(lru.back()->hash);
+        lru.pop_back();
+    }
+
+    return stored;
+}
+
+// Текущее количество графов
+size_t GraphStore::size() {
+    lock_guard<mutex> lock(storeMutex);
+    return lru.size();
+}
+
+// Учитывает запрос к графу
+void GraphStore::noteQuery(const shared_ptr<const StoredGraph>& stored) {
+    if (stored->errorCode != SUCCESS) {
+        return;
+    }
+
+    int count = stored->queryCount.fetch_add(1) + 1;
+    if (count < CH_BUILD_THRESHOLD) {
+        return;
+    }
+
+    // Ставим в очередь только один раз
+    bool expected = false;
+    if (!stored->hierarchyQueued.compare_exchange_strong(expected, true)) {
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(builderMutex);
+        builderQueue.push_back(stored);
+    }
+    builderCondition.notify_one();
+}
+
+// Сколько иерархий сжатий построено
+size_t GraphStore::getHierarchiesBuilt() const {
+    return hierarchiesBuilt;
+}
+
+// Сколько графов ждёт построения иерархии
+size_t GraphStore::getBuilderQueueDepth() {
+    lock_guard<mutex> lock(builderMutex);
+    return builderQueue.size();
+}
+
+// Главный цикл фонового потока: берёт графы из очереди и строит для них иерархии
+void GraphStore::builderLoop() {
+    while (true) {
+        weak_ptr<const StoredGraph> next;
+        {
+            unique_lock<mutex> lock(builderMutex);
+            builderCondition.wait(lock, [this] {
+                return !builderRunning || !builderQueue.empty();
+            });
+            if (!builderRunning) {
+                return;
+            }
+            next = builderQueue.front();
+            builderQueue.pop_front();
+        }
+
+        // Граф уже вытеснен и никем не используется
+        shared_ptr<const StoredGraph> stored = next.lock();
+        if (!stored) {
+            continue;
+        }
+
+        auto hierarchy = make_shared<ContractionHierarchy>();
+        bool built = hierarchy->build(stored->search, [this] { return !builderRunning; });
+        if (!built) {
+            return;  // Сервер останавливается
+        }
+
+        // С этого момента новые запросы к графу пойдут через иерархию
+        atomic_store(&stored->hierarchy, shared_ptr<const ContractionHierarchy>(hierarchy));
+        hierarchiesBuilt++;
+    }
+}
@@ -0,0 +1,131 @@
+#ifndef GRAPH_STORE_H
+#define GRAPH_STORE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <cstdint>
+#include <cstddef>
+
+#include "../common/Graph.h"
+#include "../common/Protocol.h"
+#include "../common/Dijkstra.h"
+#include "../common/DisjointSet.h"
+#include "../common/Landmarks.h"
+#include "../common/ContractionHierarchy.h"
+
+using namespace std;
+
+// Граф, сохранённый на сервере после первого запроса с ним
+
+// Всё, что зависит только от рёбер (проверка размера, список смежности,
+// компоненты связности), считается один раз. Следующие запросы с тем же
+// графом, но другими вершинами, сразу переходят к поиску пути.
+// После построения объект не меняется, поэтому его читают
+// из нескольких потоков без блокировок. Исключение - иерархия сжатий:
+// она строится в фоне и публикуется атомарной заменой указателя.
+struct StoredGraph {
+    uint64_t hash = 0;            // Хэш графа (см. bytesToEdges)
+    GraphSignature signature;     // Точный вид графа: сравнивается при совпадении хэша
+    int errorCode = SUCCESS;      // SUCCESS или INVALID_REQUEST, если граф не прошёл проверки
+    string errorMessage;          // Причина ошибки (для лога)
+    Graph graph;                  // Граф (для проверки существования вершин)
+    vector<int> components;       // components[v] = метка компоненты связности вершины v
+    Dijkstra search{0};           // Взвешенный список смежности для поиска пути
+    Landmarks landmarks;          // Ориентиры ALT: расстояния от них считаются один раз
+
+    // Иерархия сжатий (nullptr, пока не построена). Читается и записывается
+    // только через atomic_load/atomic_store
+    mutable shared_ptr<const ContractionHierarchy> hierarchy;
+    mutable atomic<int> queryCount{0};          // Сколько запросов дошло до поиска пути
+    mutable atomic<bool> hierarchyQueued{false}; // Построение иерархии уже запланировано
+
+    // Готовая иерархия сжатий или nullptr
+    shared_ptr<const ContractionHierarchy> getHierarchy() const;
+
+    // Лежат ли вершины a и b в одной компоненте связности
+    // Если нет - пути между ними точно нет, обход графа не нужен
+    bool connected(int a, int b) const;
+
+    // Строит и проверяет граф по рёбрам
+    // hash Хэш графа
+    // signature Точный вид графа (graphSignature)
+    // edges Рёбра из запроса
+    // dsu Union-find, заполненный при разборе рёбер
+    // Рёбра и union-find живут в арене запроса, поэтому всё, что нужно
+    // сохранить, копируется в обычную память
+    static shared_ptr<StoredGraph> build(uint64_t hash, GraphSignature signature,
+                                         const pmr::vector<Edge>& edges, DisjointSet& dsu);
+};
+
+// Хранилище графов, ключ - хэш графа
+
+// Ограничено по количеству графов: при переполнении выбрасывается граф,
+// к которому дольше всего не обращались (LRU).
+
+// Хэш графа можно подобрать, поэтому граф находится, только если совпал
+// и его точный вид. Для одного хэша хранится один граф: граф с тем же
+// хэшем, но другими рёбрами, строится заново на каждый запрос.
+
+// Для "горячих" графов (запрошенных несколько раз) фоновый поток строит
+// иерархию сжатий. Пока она не готова, запросы идут обычным поиском.
+class GraphStore {
+public:
+    // capacity Максимальное количество хранимых графов
+    // Запускает фоновый поток построения иерархий
+    explicit GraphStore(size_t capacity);
+
+    // Останавливает фоновый поток (незаконченное построение прерывается)
+    ~GraphStore();
+
+    // Ищет граф по хэшу и точному виду
+    // nullptr, если граф ещё не встречался (или уже вытеснен)
+    shared_ptr<const StoredGraph> find(uint64_t hash, const GraphSignature& signature);
+
+    // Сохраняет граф
+    // Если такой граф уже успел сохранить другой поток, возвращается сохранённый ранее;
+    // если под этим хэшем хранится другой граф, новый не сохраняется
+    shared_ptr<const StoredGraph> insert(shared_ptr<const StoredGraph> stored);
+
+    // Текущее количество графов
+    size_t size();
+
+    // Учитывает запрос к графу; когда граф становится "горячим",
+    // ставит построение иерархии сжатий в очередь фонового потока
+    void noteQuery(const shared_ptr<const StoredGraph>& stored);
+
+    // Сколько иерархий сжатий построено
+    size_t getHierarchiesBuilt() const;
+
+    // Сколько графов ждёт построения иерархии
+    size_t getBuilderQueueDepth();
+
+private:
+    size_t capacity;
+    mutex storeMutex;
+
+    // Очередь построения иерархий. Хранятся weak_ptr: вытесненный
+    // из хранилища граф не нужно ни держать в памяти, ни обрабатывать
+    mutex builderMutex;
+    condition_variable builderCondition;
+    deque<weak_ptr<const StoredGraph>> builderQueue;
+    atomic<bool> builderRunning;
+    atomic<size_t> hierarchiesBuilt;
+    thread builderThread;
+
+    // Главный цикл фонового потока
+    void builderLoop();
+
+    // Начало списка - самые свежие графы
+    list<shared_ptr<const StoredGraph>> lru;
+    unordered_map<uint64_t, list<shared_ptr<const StoredGraph>>::iterator> index;
+};
+
+#endif
@@ -0,0 +1,325 @@
+#include "../server/Metrics.h"
+
+using namespace std;
+
+// Префикс имён всех метрик сервера
+const string METRIC_PREFIX = "graph_server_";
+// Сколько ждать запрос от сборщика метрик (секунды)
+const int METRICS_READ_TIMEOUT_SEC = 2;
+
+// Имена и описания счётчиков (в порядке enum Counter)
+static const char* const COUNTER_NAMES[Metrics::COUNTER_COUNT] = {
+    "requests_total",
+    "responses_total{code=\"success\"}",
+    "responses_total{code=\"invalid_request\"}",
+    "responses_total{code=\"no_path\"}",
+    "responses_total{code=\"overloaded\"}",
+    "responses_total{code=\"deadline_exceeded\"}",
+    "malformed_requests_total",
+    "bytes_received_total",
+    "bytes_sent_total"
+};
+
+// Описания счётчиков (у responses_total одно описание на все code)
+static const char* const COUNTER_HELP[Metrics::COUNTER_COUNT] = {
+    "Обработано запросов",
+    "Отправлено ответов по кодам ошибок",
+    "",
+    "",
+    "",
+    "",
+    "Запросов с некорректными данными (без ответа)",
+    "Получено байт от клиентов",
+    "Отправлено байт клиентам"
+};
+
+// Названия этапов (в порядке enum Stage)
+static const char* const STAGE_NAMES[Metrics::STAGE_COUNT] = {
+    "queue",
+    "decode",
+    "graph_build",
+    "search",
+    "encode",
+    "send"
+};
+
+mutex Metrics::registryMutex;
+vector<Metrics::ThreadBlock*> Metrics::blocks;
+Metrics::ThreadBlock Metrics::retired;
+vector<Metrics::Value> Metrics::values;
+
+// Блок со всеми значениями, равными нулю
+Metrics::ThreadBlock::ThreadBlock() {
+    for (auto& counter : counters) {
+        counter.store(0, memory_order_relaxed);
+    }
+    for (auto& stage : buckets) {
+        for (auto& bucket : stage) {
+            bucket.store(0, memory_order_relaxed);
+        }
+    }
+    for (auto& sum : sums) {
+        sum.store(0, memory_order_relaxed);
+    }
+}
+
+// Прибавляет значения other к этому блоку
+void Metrics::ThreadBlock::absorb(const ThreadBlock& other) {
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        bump(counters[i], other.counters[i].load(memory_order_relaxed));
+    }
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        for (int b = 0; b < Histogram::BUCKET_COUNT; b++) {
+            bump(buckets[s][b], other.buckets[s][b].load(memory_order_relaxed));
+        }
+        bump(sums[s], other.sums[s].load(memory_order_relaxed));
+    }
+}
+
+// Новый поток регистрирует свой блок
+Metrics::BlockHolder::BlockHolder() : block(new ThreadBlock()) {
+    lock_guard<mutex> lock(registryMutex);
+    blocks.push_back(block);
+}
+
+// Поток завершается: переносим его значения в retired
+Metrics::BlockHolder::~BlockHolder() {
+    lock_guard<mutex> lock(registryMutex);
+    retired.absorb(*block);
+    for (size_t i = 0; i < blocks.size(); i++) {
+        if (blocks[i] == block) {
+            blocks[i] = blocks.back();
+            blocks.pop_back();
+            break;
+        }
+    }
+    delete block;
+}
+
+// Блок текущего потока
+Metrics::ThreadBlock& Metrics::local() {
+    thread_local BlockHolder holder;
+    return *holder.block;
+}
+
+// Увеличивает счётчик текущего потока
+void Metrics::add(Counter counter, uint64_t value) {
+    bump(local().counters[counter], value);
+}
+
+// Учитывает ответ с кодом ошибки
+void Metrics::countResponse(int errorCode) {
+    switch (errorCode) {
+        case 0:
+            add(RESPONSES_SUCCESS);
+            break;
+        case 1:
+            add(RESPONSES_INVALID_REQUEST);
+            break;
+        case 2:
+            add(RESPONSES_NO_PATH);
+            break;
+        case 3:
+            add(RESPONSES_OVERLOADED);
+            break;
+        case 4:
+            add(RESPONSES_DEADLINE_EXCEEDED);
+            break;
+        default:
+            break;
+    }
+}
+
+// Добавляет длительность этапа
+void Metrics::observe(Stage stage, uint64_t microseconds) {
+    ThreadBlock& block = local();
+    bump(block.buckets[stage][Histogram::bucketIndex(microseconds)], 1);
+    bump(block.sums[stage], microseconds);
+}
+
+// Название этапа
+const char* Metrics::stageName(Stage stage) {
+    return STAGE_NAMES[stage];
+}
+
+// Регистрирует значение, которое считается при запросе /metrics
+void Metrics::registerValue(const string& name, const string& help,
+                            const string& type, function<double()> value) {
+    lock_guard<mutex> lock(registryMutex);
+    values.push_back({name, help, type, move(value)});
+}
+
+// Удаляет все зарегистрированные функции
+void Metrics::clearValues() {
+    lock_guard<mutex> lock(registryMutex);
+    values.clear();
+}
+
+// Все метрики в текстовом формате Prometheus
+string Metrics::renderPrometheus() {
+    // Суммируем блоки всех потоков и копируем список функций.
+    // Сами функции вызываем уже без блокировки: они могут брать
+    // мьютексы сервера, а те не должны зависеть от registryMutex
+    ThreadBlock total;
+    vector<Value> snapshot;
+    {
+        lock_guard<mutex> lock(registryMutex);
+        total.absorb(retired);
+        for (ThreadBlock* block : blocks) {
+            total.absorb(*block);
+        }
+        snapshot = values;
+    }
+
+    ostringstream out;
+
+    // Счётчики; responses_total с разными code - одна метрика
+    string lastFamily;
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        string name = COUNTER_NAMES[i];
+        string family = name.substr(0, name.find('{'));
+        if (family != lastFamily) {
+            out << "# HELP " << METRIC_PREFIX << family << " " << COUNTER_HELP[i] << "\n";
+            out << "# TYPE " << METRIC_PREFIX << family << " counter\n";
+            lastFamily = family;
+        }
+        out << METRIC_PREFIX << name << " " << total.counters[i].load(memory_order_relaxed) << "\n";
+    }
+
+    // Гистограммы этапов: корзины накопительные, границы в секундах
+    string histogram = METRIC_PREFIX + "stage_duration_seconds";
+    out << "# HELP " << histogram << " Длительность этапов обработки запроса\n";
+    out << "# TYPE " << histogram << " histogram\n";
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        uint64_t cumulative = 0;
+        for (int b = 0; b < Histogram::BUCKET_COUNT; b++) {
+            uint64_t count = total.buckets[s][b].load(memory_order_relaxed);
+            if (count == 0) {
+                continue;  // Пустые корзины не выводим - границы от этого не меняются
+            }
+            cumulative += count;
+            double bound = static_cast<double>(Histogram::bucketUpperBound(b)) / 1e6;
+            out << histogram << "_bucket{stage=\"" << STAGE_NAMES[s] << "\",le=\""
+                << bound << "\"} " << cumulative << "\n";
+        }
+        out << histogram << "_bucket{stage=\"" << STAGE_NAMES[s] << "\",le=\"+Inf\"} "
+            << cumulative << "\n";
+        out << histogram << "_sum{stage=\"" << STAGE_NAMES[s] << "\"} "
+            << static_cast<double>(total.sums[s].load(memory_order_relaxed)) / 1e6 << "\n";
+        out << histogram << "_count{stage=\"" << STAGE_NAMES[s] << "\"} " << cumulative << "\n";
+    }
+
+    // Значения, которые считаются по запросу
+    for (const Value& value : snapshot) {
+        out << "# HELP " << METRIC_PREFIX << value.name << " " << value.help << "\n";
+        out << "# TYPE " << METRIC_PREFIX << value.name << " " << value.type << "\n";
+        out << METRIC_PREFIX << value.name << " " << value.read() << "\n";
+    }
+
+    return out.str();
+}
+
+// Конструктор точки метрик
+MetricsEndpoint::MetricsEndpoint() : listenSocket(-1), running(false) {
+}
+
+// Деструктор
+MetricsEndpoint::~MetricsEndpoint() {
+    stop();
+}
+
+// Открывает порт и запускает поток
+bool MetricsEndpoint::start(int port) {
+    listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0) {
+        return false;
+    }
+
+    int opt = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    // Только локальный адрес: метрики читает агент на этой же машине
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+
+    if (bind(listenSocket, (sockaddr*)&address, sizeof(address)) < 0 ||
+        listen(listenSocket, 5) < 0) {
+        close(listenSocket);
+        listenSocket = -1;
+        return false;
+    }
+
+    running = true;
+    acceptThread = thread(&MetricsEndpoint::serve, this);
+    return true;
+}
+
+// Закрывает порт и дожидается потока
+void MetricsEndpoint::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    // shutdown прерывает ожидание в accept
+    shutdown(listenSocket, SHUT_RDWR);
+    close(listenSocket);
+    listenSocket = -1;
+    if (acceptThread.joinable()) {
+        acceptThread.join();
+    }
+}
+
+// Цикл приёма подключений
+void MetricsEndpoint::serve() {
+    while (running) {
+        int socket = accept(listenSocket, nullptr, nullptr);
+        if (socket < 0) {
+            continue;
+        }
+        handleConnection(socket);
+        close(socket);
+    }
+}
+
+// Отвечает одному подключению (HTTP/1.0: один запрос - один ответ)
+void MetricsEndpoint::handleConnection(int socket) {
+    // Сборщик, который подключился и молчит, не должен держать поток
+    timeval timeout;
+    timeout.tv_sec = METRICS_READ_TIMEOUT_SEC;
+    timeout.tv_usec = 0;
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char buffer[1024];
+    ssize_t bytesRead = recv(socket, buffer, sizeof(buffer) - 1, 0);
+    if (bytesRead <= 0) {
+        return;
+    }
+    buffer[bytesRead] = '\0';
+
+    string request(buffer);
+    string body;
+    string status;
+    if (request.compare(0, 12, "GET /metrics") == 0 || request.compare(0, 6, "GET / ") == 0) {
+        status = "200 OK";
+        body = Metrics::renderPrometheus();
+    } else {
+        status = "404 Not Found";
+        body = "Метрики доступны по адресу /metrics\n";
+    }
+
+    string response = "HTTP/1.0 " + status + "\r\n"
+                      "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                      "Content-Length: " + to_string(body.size()) + "\r\n"
+                      "Connection: close\r\n\r\n" + body;
+
+    size_t offset = 0;
+    while (offset < response.size()) {
+        ssize_t sent = send(socket, response.data() + offset, response.size() - offset, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return;
+        }
+        offset += static_cast<size_t>(sent);
+    }
+}
@@ -0,0 +1,186 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "../common/Histogram.h"
+#include "../server/Tracer.h"
+
+using namespace std;
+
+// Метрики сервера: счётчики, гистограммы задержек и их вывод
+// в текстовом формате Prometheus
+
+// Счётчики и гистограммы пишутся на каждом запросе, поэтому у каждого
+// потока свой блок счётчиков: поток только увеличивает свои значения
+// (атомарные load/store без блокировок и без борьбы за кэш-линии),
+// а при запросе /metrics блоки всех потоков суммируются.
+// Когда поток завершается, его значения переносятся в общий блок
+// завершённых потоков - счётчики не уменьшаются.
+
+// Значения, которые и так где-то хранятся (размер кэша, число
+// подключений и т.п.), регистрируются как функции и считаются
+// только при запросе /metrics.
+
+class Metrics {
+public:
+    // Счётчики (растут на каждом запросе)
+    enum Counter {
+        REQUESTS,                   // Запросов обработано
+        RESPONSES_SUCCESS,          // Ответов SUCCESS
+        RESPONSES_INVALID_REQUEST,  // Ответов INVALID_REQUEST
+        RESPONSES_NO_PATH,          // Ответов NO_PATH
+        RESPONSES_OVERLOADED,       // Ответов OVERLOADED (запрос не принят)
+        RESPONSES_DEADLINE_EXCEEDED, // Ответов DEADLINE_EXCEEDED (срок истёк до обработки)
+        MALFORMED_REQUESTS,         // Запросов, на которые нечего ответить (битые данные)
+        BYTES_RECEIVED,             // Байт получено от клиентов
+        BYTES_SENT,                 // Байт отправлено клиентам
+        COUNTER_COUNT
+    };
+
+    // Этапы обработки запроса, для каждого - гистограмма длительности
+    enum Stage {
+        STAGE_QUEUE,        // Ожидание в очереди запросов
+        STAGE_DECODE,       // Разбор запроса и рёбер
+        STAGE_GRAPH_BUILD,  // Построение графа (если его нет в хранилище)
+        STAGE_SEARCH,       // Поиск пути
+        STAGE_ENCODE,       // Сериализация ответа
+        STAGE_SEND,         // Отправка ответа
+        STAGE_COUNT
+    };
+
+    // Увеличивает счётчик текущего потока
+    static void add(Counter counter, uint64_t value = 1);
+
+    // Учитывает ответ с кодом ошибки errorCode (ErrorCode)
+    static void countResponse(int errorCode);
+
+    // Добавляет длительность этапа (микросекунды)
+    static void observe(Stage stage, uint64_t microseconds);
+
+    // Название этапа (как в метках метрик и в трассе)
+    static const char* stageName(Stage stage);
+
+    // Регистрирует значение, которое считается при запросе /metrics
+    // name Имя метрики (например, graph_server_active_tcp_connections)
+    // help Описание
+    // type "gauge" или "counter"
+    // value Функция, возвращающая текущее значение
+    static void registerValue(const string& name, const string& help,
+                              const string& type, function<double()> value);
+
+    // Удаляет все зарегистрированные функции (перед уничтожением их владельцев)
+    static void clearValues();
+
+    // Все метрики в текстовом формате Prometheus
+    static string renderPrometheus();
+
+    // Замер этапа: длительность от создания до уничтожения объекта
+    // (и событие трассы, если запрос попал в выборку Tracer)
+    // Пример: { Metrics::StageTimer timer(Metrics::STAGE_SEARCH); ... }
+    class StageTimer {
+    public:
+        explicit StageTimer(Stage stage)
+            : stage(stage), begin(chrono::steady_clock::now()) {}
+        // Этап, который начался раньше (например, ожидание в очереди)
+        StageTimer(Stage stage, chrono::steady_clock::time_point begin)
+            : stage(stage), begin(begin) {}
+        ~StageTimer() {
+            auto end = chrono::steady_clock::now();
+            observe(stage, static_cast<uint64_t>(
+                chrono::duration_cast<chrono::microseconds>(end - begin).count()));
+            // Те же отметки времени попадают в трассу, если запрос в выборке
+            if (Tracer::sampled()) {
+                Tracer::record(stageName(stage), begin, end);
+            }
+        }
+    private:
+        Stage stage;
+        chrono::steady_clock::time_point begin;
+    };
+
+private:
+    // Блок счётчиков одного потока
+    struct ThreadBlock {
+        atomic<uint64_t> counters[COUNTER_COUNT];
+        atomic<uint64_t> buckets[STAGE_COUNT][Histogram::BUCKET_COUNT];
+        atomic<uint64_t> sums[STAGE_COUNT];
+
+        ThreadBlock();
+        // Прибавляет значения other к этому блоку
+        void absorb(const ThreadBlock& other);
+    };
+
+    // Удерживает блок потока и переносит его значения при завершении потока
+    struct BlockHolder {
+        ThreadBlock* block;
+        BlockHolder();
+        ~BlockHolder();
+    };
+
+    // Функция, регистрируемая через registerValue
+    struct Value {
+        string name;
+        string help;
+        string type;
+        function<double()> read;
+    };
+
+    static mutex registryMutex;
+    static vector<ThreadBlock*> blocks;     // Блоки работающих потоков
+    static ThreadBlock retired;             // Сумма блоков завершённых потоков
+    static vector<Value> values;
+
+    // Блок текущего потока (создаётся при первом обращении)
+    static ThreadBlock& local();
+
+    // Увеличивает значение, которое пишет только один поток
+    static void bump(atomic<uint64_t>& cell, uint64_t value) {
+        cell.store(cell.load(memory_order_relaxed) + value, memory_order_relaxed);
+    }
+};
+
+// HTTP-точка для сборщика метрик
+
+// Слушает отдельный порт только на 127.0.0.1 и на любой GET /metrics
+// отвечает Metrics::renderPrometheus(). Работает в своём потоке и не
+// мешает обслуживанию клиентов.
+class MetricsEndpoint {
+public:
+    MetricsEndpoint();
+    ~MetricsEndpoint();
+
+    // Открывает порт и запускает поток
+    // true, если порт удалось открыть
+    bool start(int port);
+
+    // Закрывает порт и дожидается потока
+    void stop();
+
+private:
+    int listenSocket;
+    atomic<bool> running;
+    thread acceptThread;
+
+    // Цикл приёма подключений
+    void serve();
+
+    // Отвечает одному подключению
+    void handleConnection(int socket);
+};
+
+#endif
@@ -0,0 +1,29 @@
+#include "../server/RequestArena.h"
+
+using namespace std;
+
+// Размер начального буфера арены в каждом потоке (байты)
+// Обычный запрос (до 20 рёбер) целиком помещается в несколько килобайт
+const size_t ARENA_BUFFER_BYTES = 64 * 1024;
+
+// Начальный буфер текущего потока
+static char* threadBuffer() {
+    thread_local char buffer[ARENA_BUFFER_BYTES];
+    return buffer;
+}
+
+// Пул блоков текущего потока - на случай, если буфера не хватило
+static pmr::memory_resource* threadPool() {
+    thread_local pmr::unsynchronized_pool_resource pool;
+    return &pool;
+}
+
+// Конструктор: арена начинает с буфера потока
+RequestArena::RequestArena()
+    : arena(threadBuffer(), ARENA_BUFFER_BYTES, threadPool()) {
+}
+
+// Источник памяти для pmr-контейнеров запроса
+pmr::memory_resource* RequestArena::resource() {
+    return &arena;
+}
@@ -0,0 +1,44 @@
+#ifndef REQUEST_ARENA_H
+#define REQUEST_ARENA_H
+
+#include <memory_resource>
+#include <cstddef>
+
+using namespace std;
+
+// Арена памяти для одного запроса сервера
+
+// Разбор запроса создаёт много короткоживущих объектов: вектор рёбер,
+// массивы union-find и т.д. Обычный new/delete для каждого из них - это
+// обращения к общему для всех потоков malloc, которые под нагрузкой
+// мешают друг другу.
+
+// Арена (monotonic_buffer_resource) выделяет память простым сдвигом
+// указателя по буферу потока и ничего не освобождает по отдельности:
+// всё возвращается разом, когда арена уничтожается в конце запроса.
+// Если буфера не хватило, следующие блоки берутся из пула потока
+// (unsynchronized_pool_resource) - тоже без общих блокировок, и после
+// первых запросов блоки в пуле уже есть.
+
+// Буфер общий для всех арен потока, поэтому в одном потоке
+// одновременно может существовать только одна арена.
+
+// Пример:
+//   RequestArena arena;
+//   pmr::vector<Edge> edges(arena.resource());
+//   ... // в конце блока память арены возвращается целиком
+class RequestArena {
+public:
+    RequestArena();
+
+    // Источник памяти для pmr-контейнеров запроса
+    pmr::memory_resource* resource();
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+private:
+    pmr::monotonic_buffer_resource arena;   // Выделение сдвигом указателя по буферу потока
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include "../server/RequestQueue.h"
+
+using namespace std;
+
+// Конструктор очереди (обработчики запускает start)
+RequestQueue::RequestQueue()
+    : capacity(0), running(false), rejected(0), expired(0) {
+}
+
+// Деструктор
+RequestQueue::~RequestQueue() {
+    stop();
+}
+
+// Запускает обработчики
+void RequestQueue::start(size_t workerCount, size_t queueCapacity) {
+    lock_guard<mutex> lock(queueMutex);
+    if (running) {
+        return;
+    }
+    capacity = queueCapacity;
+    running = true;
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(&RequestQueue::workerLoop, this);
+    }
+}
+
+// Останавливает обработчики
+void RequestQueue::stop() {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    queueCondition.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+
+    // Ожидающие ответа потоки не должны зависнуть - отдаём им задачи как просроченные
+    deque<Task> rest;
+    {
+        lock_guard<mutex> lock(queueMutex);
+        rest.swap(tasks);
+    }
+    for (Task& task : rest) {
+        task.job(true);
+    }
+}
+
+// Ставит задачу в очередь
+bool RequestQueue::submit(Clock::time_point deadline, Job job) {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (!running || tasks.size() >= capacity) {
+            rejected++;
+            return false;
+        }
+        tasks.push_back({deadline, move(job)});
+    }
+    queueCondition.notify_one();
+    return true;
+}
+
+// Сколько задач ждёт в очереди
+size_t RequestQueue::depth() {
+    lock_guard<mutex> lock(queueMutex);
+    return tasks.size();
+}
+
+// Сколько задач не принято
+uint64_t RequestQueue::getRejected() const {
+    return rejected.load();
+}
+
+// Сколько задач просрочено в очереди
+uint64_t RequestQueue::getExpired() const {
+    return expired.load();
+}
+
+// Главный цикл обработчика: берёт задачи по порядку поступления
+void RequestQueue::workerLoop() {
+    while (true) {
+        Task task;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this] {
+                return !running || !tasks.empty();
+            });
+            if (!running) {
+                return;
+            }
+            task = move(tasks.front());
+            tasks.pop_front();
+        }
+
+        // Срок проверяется при выдаче задачи: запрос, простоявший в очереди
+        // дольше срока, не занимает обработчик поиском пути
+        bool late = Clock::now() > task.deadline;
+        if (late) {
+            expired++;
+        }
+        task.job(late);
+    }
+}
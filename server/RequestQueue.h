@@ -0,0 +1,82 @@
+#ifndef REQUEST_QUEUE_H
+#define REQUEST_QUEUE_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// Ограниченная очередь запросов с пулом обработчиков
+
+// Запросы TCP и UDP не обрабатываются в потоке, который их принял, а
+// ставятся сюда. Поиск пути одновременно выполняют не больше workers
+// потоков, остальные запросы ждут в очереди. Когда очередь заполнена,
+// новый запрос не принимается (submit возвращает false) - сервер сразу
+// отвечает OVERLOADED, а не копит работу, которую всё равно не успеет
+// сделать.
+
+// У каждого запроса есть срок (deadline). Если запрос дождался своей
+// очереди слишком поздно, обработчик получает expired = true и должен
+// ответить DEADLINE_EXCEEDED без вычислений: клиент этот ответ уже
+// не ждёт, а время обработчика нужнее запросам, которые ещё успевают.
+
+class RequestQueue {
+public:
+    using Clock = chrono::steady_clock;
+
+    // Задача: expired - срок истёк, пока запрос ждал в очереди
+    using Job = function<void(bool expired)>;
+
+    RequestQueue();
+
+    // Деструктор: останавливает обработчики
+    ~RequestQueue();
+
+    // Запускает workers обработчиков; в очереди ждут не больше capacity задач
+    void start(size_t workers, size_t capacity);
+
+    // Останавливает обработчики; задачи, оставшиеся в очереди, получают expired = true
+    void stop();
+
+    // Ставит задачу в очередь
+    // false, если очередь заполнена (задача не будет выполнена)
+    bool submit(Clock::time_point deadline, Job job);
+
+    // Сколько задач ждёт в очереди
+    size_t depth();
+
+    // Сколько задач не принято из-за заполненной очереди
+    uint64_t getRejected() const;
+
+    // Сколько задач дождались очереди после своего срока
+    uint64_t getExpired() const;
+
+private:
+    struct Task {
+        Clock::time_point deadline;
+        Job job;
+    };
+
+    mutex queueMutex;
+    condition_variable queueCondition;
+    deque<Task> tasks;
+    size_t capacity;
+    bool running;
+    vector<thread> workers;
+
+    atomic<uint64_t> rejected;
+    atomic<uint64_t> expired;
+
+    // Главный цикл обработчика
+    void workerLoop();
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "../server/ResultCache.h"
+
+using namespace std;
+
+// Конструктор кэша
+ResultCache::ResultCache(size_t capacityBytes, size_t shardCount)
+    : hits(0), misses(0) {
+    if (shardCount == 0) {
+        shardCount = 1;
+    }
+    capacityPerShard = capacityBytes / shardCount;
+
+    for (size_t i = 0; i < shardCount; i++) {
+        shards.push_back(make_unique<Shard>());
+    }
+}
+
+// Хэш ключа: хэш графа уже хорошо перемешан, добавляем к нему вершины
+// (вид графа сравнивает operator==)
+size_t ResultCache::KeyHash::operator()(const CacheKey& key) const {
+    uint64_t h = key.graphHash;
+    h ^= (static_cast<uint64_t>(static_cast<uint32_t>(key.start)) << 32) |
+         static_cast<uint32_t>(key.end);
+    h *= 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(h ^ (h >> 29));
+}
+
+// Выбирает шард по ключу
+ResultCache::Shard& ResultCache::shardFor(const CacheKey& key) {
+    return *shards[KeyHash()(key) % shards.size()];
+}
+
+// Ищет ответ в кэше
+bool ResultCache::get(const CacheKey& key, vector<char>& out) {
+    Shard& shard = shardFor(key);
+    lock_guard<mutex> lock(shard.shardMutex);
+
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        misses.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    // Переносим запись в начало списка - она стала самой свежей
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    out = it->second->second;
+
+    hits.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+// Сохраняет ответ в кэш
+void ResultCache::put(const CacheKey& key, const vector<char>& data) {
+    if (data.size() + key.bytes() > capacityPerShard) {
+        return;
+    }
+
+    Shard& shard = shardFor(key);
+    lock_guard<mutex> lock(shard.shardMutex);
+
+    // Ответ уже есть (два клиента посчитали его одновременно) - просто обновляем
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        shard.bytes -= it->second->second.size();
+        it->second->second = data;
+        shard.bytes += data.size();
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+
+    shard.lru.emplace_front(key, data);
+    shard.index[key] = shard.lru.begin();
+    shard.bytes += data.size() + key.bytes();
+
+    // Выбрасываем самые старые записи, пока не уложимся в лимит
+    while (shard.bytes > capacityPerShard && !shard.lru.empty()) {
+        Entry& oldest = shard.lru.back();
+        shard.bytes -= oldest.second.size() + oldest.first.bytes();
+        shard.index.erase(oldest.first);
+        shard.lru.pop_back();
+    }
+}
+
+// Количество попаданий
+uint64_t ResultCache::getHits() const {
+    return hits.load(memory_order_relaxed);
+}
+
+// Количество промахов
+uint64_t ResultCache::getMisses() const {
+    return misses.load(memory_order_relaxed);
+}
+
+// Количество записей во всех шардах
+size_t ResultCache::size() {
+    size_t total = 0;
+    for (auto& shard : shards) {
+        lock_guard<mutex> lock(shard->shardMutex);
+        total += shard->lru.size();
+    }
+    return total;
+}
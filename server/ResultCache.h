@@ -0,0 +1,98 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "../common/Protocol.h"
+
+using namespace std;
+
+// Кэш готовых ответов сервера
+
+// Клиенты часто присылают один и тот же граф (например, graph.txt) с теми же вершинами.
+// Ключ кэша = (хэш графа, начальная вершина, конечная вершина),
+// значение = уже сериализованный ServerResponse (байты, готовые к отправке).
+// Хэш выбирает ячейку, а совпадение проверяется по точному виду графа:
+// граф с подобранным тем же хэшем не получит чужой ответ.
+// При попадании в кэш граф не строится и поиск пути не выполняется.
+
+// Кэш разбит на шарды (shard), у каждого свой мьютекс,
+// поэтому потоки разных клиентов почти не мешают друг другу.
+// Внутри шарда - LRU: при превышении лимита памяти выбрасываются
+// записи, к которым дольше всего не обращались.
+
+struct CacheKey {
+    uint64_t graphHash;  // Хэш графа (см. bytesToEdges)
+    int start;           // Начальная вершина
+    int end;             // Конечная вершина
+    GraphSignature graph; // Точный вид графа (см. graphSignature)
+
+    bool operator==(const CacheKey& other) const {
+        return graphHash == other.graphHash && start == other.start && end == other.end &&
+               graph == other.graph;
+    }
+
+    // Сколько памяти занимает вид графа
+    size_t bytes() const {
+        return graph.size() * sizeof(GraphSignature::value_type);
+    }
+};
+
+class ResultCache {
+public:
+    // Конструктор кэша
+    // capacityBytes Общий лимит памяти под ответы (делится поровну между шардами)
+    // shardCount Количество шардов
+    ResultCache(size_t capacityBytes, size_t shardCount);
+
+    // Ищет ответ в кэше
+    // true, если ответ найден (out заполняется байтами ответа)
+    bool get(const CacheKey& key, vector<char>& out);
+
+    // Сохраняет ответ в кэш
+    // Если ответ больше лимита шарда, он не кэшируется
+    void put(const CacheKey& key, const vector<char>& data);
+
+    // Счётчики попаданий и промахов
+    uint64_t getHits() const;
+    uint64_t getMisses() const;
+
+    // Текущее количество записей во всех шардах
+    size_t size();
+
+private:
+    // Хэш-функция для CacheKey (нужна для unordered_map)
+    struct KeyHash {
+        size_t operator()(const CacheKey& key) const;
+    };
+
+    // Элемент LRU-списка: ключ + байты ответа
+    typedef pair<CacheKey, vector<char>> Entry;
+
+    struct Shard {
+        mutex shardMutex;
+        // Начало списка - самые свежие записи, конец - самые старые
+        list<Entry> lru;
+        // Быстрый поиск записи в списке по ключу
+        unordered_map<CacheKey, list<Entry>::iterator, KeyHash> index;
+        size_t bytes = 0;    // Сколько памяти занимают ответы (и виды графов) в шарде
+    };
+
+    vector<unique_ptr<Shard>> shards;
+    size_t capacityPerShard;
+
+    atomic<uint64_t> hits;
+    atomic<uint64_t> misses;
+
+    // Выбирает шард по ключу
+    Shard& shardFor(const CacheKey& key);
+};
+
+#endif
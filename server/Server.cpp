@@ -6,11 +6,44 @@ using namespace std;
 const int BUFFER_SIZE = 4096;
 // Таймаут для потери связи с клиентом (секунды)
 const int CLIENT_TIMEOUT_SEC = 10;
+// Наибольшее ожидание пакета в цикле UDP (проверка остановки сервера)
+const int UDP_POLL_TIMEOUT_MS = 100;
+// Лимит памяти кэша ответов (байты) и количество шардов
+const size_t RESULT_CACHE_BYTES = 16 * 1024 * 1024;
+const size_t RESULT_CACHE_SHARDS = 16;
+// Сколько разных графов сервер держит в памяти
+const size_t GRAPH_STORE_CAPACITY = 1024;
+// Ограничения нагрузки по умолчанию (меняются через setLimits)
+const int DEFAULT_MAX_CONNECTIONS = 256;
+// Потоков подключений, которые ждут следующего подключения
+const size_t DEFAULT_POOLED_THREADS = 16;
+const size_t DEFAULT_QUEUE_CAPACITY = 256;
+// Срок ответа по умолчанию - меньше таймаута ожидания клиента (3 секунды)
+const int DEFAULT_DEADLINE_MS = 2000;
+
+// Ответ без пути с кодом ошибки (OVERLOADED, DEADLINE_EXCEEDED)
+static vector<char> errorResponseBytes(int errorCode) {
+    ServerResponse response;
+    response.error_code = errorCode;
+    response.path_length = 0;
+    return responseToBytes(response);
+}
 
 // Конструктор сервера
 Server::Server(int port, const string& protocol)
-    : port(port), protocol(protocol), serverSocket(-1), isRunning(false),
-      nextPacketId(1) {
+    : isRunning(false),
+      nextPacketId(1), resultCache(RESULT_CACHE_BYTES, RESULT_CACHE_SHARDS),
+      maxConnections(DEFAULT_MAX_CONNECTIONS), pooledThreads(DEFAULT_POOLED_THREADS),
+      queueCapacity(DEFAULT_QUEUE_CAPACITY), defaultDeadline(DEFAULT_DEADLINE_MS),
+      connections([this](int socket) {
+          if (isShmConnection(socket)) {
+              handleShmClient(socket);
+          } else {
+              handleTCPClient(socket);
+          }
+      }),
+      uringRequested(false), metricsPort(0), graphStore(GRAPH_STORE_CAPACITY) {
+    addListener(protocol, port, "");
 }
 
 // Деструктор
@@ -20,16 +53,194 @@ Server::~Server() {
 
 // Запускает сервер
 bool Server::start() {
-    // Создаём сокет
-    if (!createSocket()) {
-        return false;
+    for (auto& listener : listeners) {
+        // Общая память - только для клиентов на той же машине
+        if (listener->protocol == "shm" && listener->unixPath.empty()) {
+            Logger::error("Протокол shm работает только через Unix-сокет (unix:/путь)");
+            return false;
+        }
+    }
+
+    // Создаём сокеты; если хоть один не создан, закрываем уже созданные
+    for (auto& listener : listeners) {
+        if (!createSocket(*listener)) {
+            for (auto& created : listeners) {
+                if (created->socket >= 0) {
+                    close(created->socket);
+                    created->socket = -1;
+                }
+            }
+            return false;
+        }
     }
     
     isRunning = true;
-    Logger::info("Сервер запущен на порту " + to_string(port) + " (" + protocol + ")");
+    for (auto& listener : listeners) {
+        Logger::info("Сервер слушает " + listener->describe());
+    }
+
+    // io_uring - только если ядро поддерживает всё нужное, иначе обычный режим
+    if (uringRequested) {
+        string reason;
+        bool supported = UringBackend::supported(reason);
+        for (auto& listener : listeners) {
+            if (listener->protocol == "shm") {
+                // Запросы shm приходят не через сокет: кольцу io_uring нечего читать
+                Logger::warning("io_uring не используется с shm, ввод-вывод: потоки подключений");
+            } else if (supported) {
+                listener->uring = make_unique<UringBackend>();
+                Logger::info("Ввод-вывод (" + listener->describe() + "): io_uring");
+            } else {
+                Logger::warning("io_uring недоступен (" + reason + "), ввод-вывод: потоки подключений");
+            }
+        }
+    }
+
+    // Обработчиков столько, сколько ядер: больше одновременных поисков
+    // только делят процессор и увеличивают задержку каждого
+    size_t workers = max(1u, thread::hardware_concurrency());
+    requestQueue.start(workers, queueCapacity);
+    udpChannels.start(DEFAULT_CHANNEL_WINDOW);
+    connections.configure(static_cast<size_t>(maxConnections), pooledThreads);
+    LOG_INFO("Обработчиков запросов: ", workers, ", очередь: ", queueCapacity,
+             ", подключений не больше: ", maxConnections,
+             ", ждущих потоков подключений: ", pooledThreads,
+             ", срок ответа по умолчанию: ", defaultDeadline.count(), " мс");
+
+    if (metricsPort > 0) {
+        registerMetrics();
+        if (metricsEndpoint.start(metricsPort)) {
+            Logger::info("Метрики: http://127.0.0.1:" + to_string(metricsPort) + "/metrics");
+        } else {
+            Logger::warning("Не удалось открыть порт метрик " + to_string(metricsPort));
+        }
+    }
     return true;
 }
 
+// Слушать Unix-сокет вместо порта
+void Server::setUnixPath(const string& path) {
+    listeners.front()->unixPath = path;
+}
+
+// Добавляет слушающий сокет
+void Server::addListener(const string& protocol, int port, const string& unixPath) {
+    auto listener = make_unique<Listener>();
+    listener->protocol = protocol;
+    listener->port = port;
+    listener->unixPath = unixPath;
+    listeners.push_back(move(listener));
+}
+
+// Адрес сокета для лога
+string Server::Listener::describe() const {
+    if (unixPath.empty()) {
+        return "порт " + to_string(port) + " (" + protocol + ")";
+    }
+    return UNIX_ADDRESS_PREFIX + unixPath + " (" + protocol + ")";
+}
+
+// Подключение принято сокетом shm
+bool Server::isShmConnection(int clientSocket) const {
+    // У принятого Unix-сокета локальный адрес - путь слушающего сокета
+    SocketAddress local;
+    if (getsockname(clientSocket, local.get(), &local.length) < 0 || local.family() != AF_UNIX) {
+        return false;
+    }
+    string path = local.toString();
+    for (const auto& listener : listeners) {
+        if (listener->protocol == "shm" && path == UNIX_ADDRESS_PREFIX + listener->unixPath) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Включает HTTP-точку метрик
+void Server::enableMetrics(int port) {
+    metricsPort = port;
+}
+
+// Задаёт ограничения нагрузки
+void Server::setLimits(int maxConnections, size_t queueCapacity, int deadlineMs) {
+    if (maxConnections > 0) {
+        this->maxConnections = maxConnections;
+    }
+    if (queueCapacity > 0) {
+        this->queueCapacity = queueCapacity;
+    }
+    if (deadlineMs > 0) {
+        defaultDeadline = chrono::milliseconds(deadlineMs);
+    }
+}
+
+// Задаёт число ждущих потоков подключений
+void Server::setPooledThreads(size_t count) {
+    pooledThreads = count;
+}
+
+// Включает ввод-вывод через io_uring
+void Server::enableUring() {
+    uringRequested = true;
+}
+
+// Срок ответа на запрос
+RequestQueue::Clock::time_point Server::requestDeadline(const vector<char>& requestData) const {
+    chrono::milliseconds budget = defaultDeadline;
+    if (requestData.size() >= REQUEST_SIZE) {
+        uint32_t deadlineMs = bytesToRequest(requestData).deadline_ms;
+        if (deadlineMs > 0) {
+            budget = chrono::milliseconds(deadlineMs);
+        }
+    }
+    return RequestQueue::Clock::now() + budget;
+}
+
+// Регистрирует метрики, которые считаются по состоянию сервера
+void Server::registerMetrics() {
+    Metrics::registerValue("active_tcp_connections", "Открытые TCP-подключения", "gauge", [this] {
+        // Подключения потоков общие, а у каждого кольца io_uring - свои
+        size_t active = connections.active();
+        for (const auto& listener : listeners) {
+            if (listener->uring) {
+                active += listener->uring->activeConnections();
+            }
+        }
+        return static_cast<double>(active);
+    });
+    Metrics::registerValue("tcp_connection_threads", "Потоки TCP-подключений (занятые и ждущие)", "gauge",
+                           [this] { return static_cast<double>(connections.threads()); });
+    Metrics::registerValue("tcp_threads_started_total", "Создано потоков TCP-подключений", "counter",
+                           [this] { return static_cast<double>(connections.getStarted()); });
+    Metrics::registerValue("tcp_threads_reused_total", "Подключений, обслуженных готовым потоком", "counter",
+                           [this] { return static_cast<double>(connections.getReused()); });
+    Metrics::registerValue("udp_channels", "Открытые надёжные каналы UDP", "gauge", [this] {
+        return static_cast<double>(udpChannels.size());
+    });
+    Metrics::registerValue("active_udp_clients", "UDP-клиенты без таймаута", "gauge", [this] {
+        lock_guard<mutex> lock(clientsMutex);
+        return static_cast<double>(activeClients.size());
+    });
+    Metrics::registerValue("cache_hits_total", "Попадания в кэш ответов", "counter",
+                           [this] { return static_cast<double>(resultCache.getHits()); });
+    Metrics::registerValue("cache_misses_total", "Промахи кэша ответов", "counter",
+                           [this] { return static_cast<double>(resultCache.getMisses()); });
+    Metrics::registerValue("cache_entries", "Записей в кэше ответов", "gauge",
+                           [this] { return static_cast<double>(resultCache.size()); });
+    Metrics::registerValue("stored_graphs", "Графов в хранилище", "gauge",
+                           [this] { return static_cast<double>(graphStore.size()); });
+    Metrics::registerValue("hierarchies_built_total", "Построено иерархий сжатий", "counter",
+                           [this] { return static_cast<double>(graphStore.getHierarchiesBuilt()); });
+    Metrics::registerValue("hierarchy_queue_depth", "Графов в очереди на построение иерархии", "gauge",
+                           [this] { return static_cast<double>(graphStore.getBuilderQueueDepth()); });
+    Metrics::registerValue("request_queue_depth", "Запросов в очереди к обработчикам", "gauge",
+                           [this] { return static_cast<double>(requestQueue.depth()); });
+    Metrics::registerValue("log_queue_depth", "Строк в очереди асинхронного логгера", "gauge",
+                           [] { return static_cast<double>(Logger::getQueueDepth()); });
+    Metrics::registerValue("log_dropped_total", "Строк лога выброшено при заполненной очереди", "counter",
+                           [] { return static_cast<double>(Logger::getDropped()); });
+}
+
 // Останавливает сервер
 void Server::stop() {
     if (!isRunning) {
@@ -38,72 +249,124 @@ void Server::stop() {
     
     Logger::info("Сервер завершает работу");
     isRunning = false;
+
+    // Функции метрик ссылаются на поля сервера - убираем их до уничтожения сервера
+    metricsEndpoint.stop();
+    Metrics::clearValues();
     
-    // Закрываем сокет
-    if (serverSocket >= 0) {
-        close(serverSocket);
-        serverSocket = -1;
-    }
-    
-    // Ждём завершения всех потоков клиентов
-    for (auto& thread : clientThreads) {
-        if (thread.joinable()) {
-            thread.join();
+    for (auto& listener : listeners) {
+        // Цикл io_uring выходит на следующей итерации
+        if (listener->uring) {
+            listener->uring->stop();
+        }
+
+        // Закрываем сокет: accept и recvfrom в потоке ввода-вывода вернут ошибку
+        if (listener->socket >= 0) {
+            shutdown(listener->socket, SHUT_RDWR);
+            close(listener->socket);
+            listener->socket = -1;
+        }
+        // Файл Unix-сокета остаётся после close - убираем его
+        if (!listener->unixPath.empty()) {
+            unlink(listener->unixPath.c_str());
         }
     }
-    clientThreads.clear();
+
+    // Обработчики останавливаются первыми: потоки подключений, ждущие
+    // ответа из очереди, получат DEADLINE_EXCEEDED
+    requestQueue.stop();
+
+    // Каналы UDP - после обработчиков: последние ответы ещё уходят в каналы
+    udpChannels.stop();
+    
+    // Закрываем подключения и ждём завершения всех потоков клиентов
+    connections.stop();
     
     // Очищаем информацию о клиентах
     {
         lock_guard<mutex> lock(clientsMutex);
         activeClients.clear();
     }
+
+    Logger::info("Кэш ответов: попаданий " + to_string(resultCache.getHits()) +
+                 ", промахов " + to_string(resultCache.getMisses()) +
+                 "; графов в хранилище: " + to_string(graphStore.size()) +
+                 ", иерархий сжатий: " + to_string(graphStore.getHierarchiesBuilt()));
+    bool threadedStream = false;
+    for (const auto& listener : listeners) {
+        threadedStream = threadedStream || (listener->protocol != "udp" && !listener->uring);
+    }
+    if (threadedStream) {
+        Logger::info("Потоков подключений создано: " + to_string(connections.getStarted()) +
+                     ", подключений готовым потоком: " + to_string(connections.getReused()));
+    }
 }
 
 // Создаёт и настраивает сокет
-bool Server::createSocket() {
-    // Определяем тип сокета в зависимости от протокола
-    int socketType = (protocol == "tcp") ? SOCK_STREAM : SOCK_DGRAM;
+bool Server::createSocket(Listener& listener) {
+    // Определяем тип сокета в зависимости от протокола (shm - тоже
+    // потоковый Unix-сокет: по нему передаётся область памяти)
+    int socketType = (listener.protocol == "udp") ? SOCK_DGRAM : SOCK_STREAM;
+    
+    // Настраиваем адрес сервера: Unix-сокет или порт на всех интерфейсах
+    SocketAddress serverAddr;
+    if (!listener.unixPath.empty()) {
+        if (!SocketAddress::unixPath(listener.unixPath, serverAddr)) {
+            Logger::error("Слишком длинный путь Unix-сокета: " + listener.unixPath);
+            return false;
+        }
+    } else {
+        sockaddr_in inetAddr;
+        memset(&inetAddr, 0, sizeof(inetAddr));
+        inetAddr.sin_family = AF_INET;
+        inetAddr.sin_addr.s_addr = INADDR_ANY;
+        inetAddr.sin_port = htons(listener.port);
+        serverAddr = SocketAddress::inet(inetAddr);
+    }
     
     // Создаём сокет
-    serverSocket = socket(AF_INET, socketType, 0);
-    if (serverSocket < 0) {
+    listener.socket = socket(serverAddr.family(), socketType, 0);
+    if (listener.socket < 0) {
         Logger::error("Не удалось создать сокет");
         return false;
     }
     
-    // Устанавливаем опцию SO_REUSEADDR
-    int opt = 1;
-    if (setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        Logger::warning("Не удалось установить SO_REUSEADDR");
+    if (listener.unixPath.empty()) {
+        // Устанавливаем опцию SO_REUSEADDR
+        int opt = 1;
+        if (setsockopt(listener.socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+            Logger::warning("Не удалось установить SO_REUSEADDR");
+        }
+    } else {
+        // Файл сокета от прошлого запуска мешает bind (аналог SO_REUSEADDR)
+        unlink(listener.unixPath.c_str());
     }
     
-    // Настраиваем адрес сервера
-    sockaddr_in serverAddr;
-    memset(&serverAddr, 0, sizeof(serverAddr));
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(port);
-    
     // Привязываем сокет к адресу
-    if (bind(serverSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
-        Logger::error("Не удалось привязать сокет к порту " + to_string(port));
-        close(serverSocket);
+    if (bind(listener.socket, serverAddr.get(), serverAddr.length) < 0) {
+        if (listener.unixPath.empty()) {
+            Logger::error("Не удалось привязать сокет к порту " + to_string(listener.port));
+        } else {
+            Logger::error("Не удалось привязать сокет к " + UNIX_ADDRESS_PREFIX + listener.unixPath);
+        }
+        close(listener.socket);
+        listener.socket = -1;
         return false;
     }
     
-    // Для TCP нужно начать слушать входящие подключения
-    if (protocol == "tcp") {
-        if (listen(serverSocket, 5) < 0) {
+    // Для TCP и shm нужно начать слушать входящие подключения
+    if (listener.protocol != "udp") {
+        if (listen(listener.socket, SOMAXCONN) < 0) {
             Logger::error("Не удалось начать прослушивание");
-            close(serverSocket);
+            close(listener.socket);
+            listener.socket = -1;
             return false;
         }
     } else {
         // Для UDP устанавливаем неблокирующий режим (опционально)
         // Это позволит лучше контролировать цикл обработки
-        int flags = fcntl(serverSocket, F_GETFL, 0);
-        fcntl(serverSocket, F_SETFL, flags | O_NONBLOCK);
+        int flags = fcntl(listener.socket, F_GETFL, 0);
+        fcntl(listener.socket, F_SETFL, flags | O_NONBLOCK);
     }
     
     return true;
@@ -111,20 +374,36 @@ bool Server::createSocket() {
 
 // Главный цикл сервера
 void Server::run() {
-    if (protocol == "tcp") {
-        runTCP();
+    // Каждый сокет - в своём потоке, первый - в этом
+    for (size_t i = 1; i < listeners.size(); i++) {
+        Listener* listener = listeners[i].get();
+        listener->ioThread = thread([this, listener] { runListener(*listener); });
+    }
+    runListener(*listeners.front());
+    for (auto& listener : listeners) {
+        if (listener->ioThread.joinable()) {
+            listener->ioThread.join();
+        }
+    }
+}
+
+// Цикл ввода-вывода одного сокета
+void Server::runListener(Listener& listener) {
+    if (listener.uring) {
+        runUring(listener);
+    } else if (listener.protocol != "udp") {
+        runTCP(listener);
     } else {
-        runUDP();
+        runUDP(listener);
     }
 }
 
 // Работа с TCP-клиентами
-void Server::runTCP() {
+void Server::runTCP(Listener& listener) {
     while (isRunning) {
-        sockaddr_in clientAddr;
-        socklen_t clientLen = sizeof(clientAddr);
+        SocketAddress clientAddr;
         
-        int clientSocket = accept(serverSocket, (sockaddr*)&clientAddr, &clientLen);
+        int clientSocket = accept(listener.socket, clientAddr.get(), &clientAddr.length);
         
         if (clientSocket < 0) {
             if (isRunning) {
@@ -133,50 +412,147 @@ void Server::runTCP() {
             continue;
         }
         
-        char clientIP[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, INET_ADDRSTRLEN);
-        Logger::info("Подключён TCP-клиент: " + string(clientIP));
+        // Длина кадра и данные уходят отдельными send: без TCP_NODELAY
+        // алгоритм Нейгла задерживает второй вызов до ACK клиента (до 40 мс)
+        // (у Unix-сокета алгоритма Нейгла нет)
+        if (clientAddr.family() == AF_INET) {
+            int noDelay = 1;
+            setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        }
         
-        // Создаём новый поток для обработки клиента
-        clientThreads.emplace_back(&Server::handleTCPClient, this, clientSocket);
+        string clientIP = clientAddr.toString();
+
+        // Передаём клиента потоку подключения (ждущему или новому).
+        // Подключений уже слишком много - каждое новое означало бы ещё один
+        // поток и ещё медленнее ответы всем. Клиент сразу получает OVERLOADED
+        // (ответ ляжет в его буфер и будет прочитан после отправки запроса)
+        if (!connections.admit(clientSocket)) {
+            LOG_WARNING("Отклонено подключение ", clientIP, ": подключений уже ", maxConnections);
+            sendTCP(clientSocket, errorResponseBytes(OVERLOADED));
+            Metrics::countResponse(OVERLOADED);
+            close(clientSocket);
+            continue;
+        }
+        LOG_INFO("Подключён TCP-клиент: ", clientIP);
     }
 }
 
 // Работа с UDP-клиентами
-void Server::runUDP() {
+void Server::runUDP(Listener& listener) {
     Logger::info("UDP-сервер ожидает запросы...");
+    int socket = listener.socket;
     
     while (isRunning) {
         vector<char> packetData;
-        sockaddr_in clientAddr;
+        SocketAddress clientAddr;
         
-        // Получаем пакет от клиента
-        if (!receiveUDPPacket(packetData, clientAddr)) {
-            this_thread::sleep_for(chrono::milliseconds(10));
+        // Получаем пакет от клиента; если пакетов нет - ждём следующий
+        // (poll, а не пауза: RTT канала не должен включать сон цикла).
+        // Ожидание ограничено, чтобы заметить остановку сервера
+        if (!receiveUDPPacket(socket, packetData, clientAddr)) {
+            pollfd pfd = {socket, POLLIN, 0};
+            poll(&pfd, 1, UDP_POLL_TIMEOUT_MS);
             continue;
         }
         
-        // Парсим пакет
-        auto [header, payload] = UDPProtocol::parsePacket(packetData);
-        
-        // Обновляем время последней активности клиента
-        updateClientActivity(clientAddr);
-        
-        // Обрабатываем пакет в зависимости от типа
-        if (header.type == PACKET_DATA) {
-            handleUDPDataPacket(header, payload, clientAddr);
-        } else if (header.type == PACKET_ACK) {
-            // Для сервера ACK не требуется (требование 2.9.1)
-            // Клиенты не подтверждают получение ACK
+        handleUDPPacket(packetData, clientAddr,
+                        [this, socket, clientAddr](const vector<char>& packet) {
+                            return sendUDP(socket, packet, clientAddr);
+                        },
+                        [this, socket, clientAddr](const vector<vector<char>>& packets) {
+                            return sendUDPBatch(socket, packets, clientAddr);
+                        });
+    }
+}
+
+// Работа с клиентами через io_uring
+void Server::runUring(Listener& listener) {
+    UringBackend* uring = listener.uring.get();
+    if (listener.protocol == "tcp") {
+        // Лишние подключения получают OVERLOADED, как и в runTCP
+        uring->setConnectionLimit(static_cast<size_t>(maxConnections), errorResponseBytes(OVERLOADED),
+                                  [] { Metrics::countResponse(OVERLOADED); });
+        bool ran = uring->runTCP(listener.socket, [this](vector<char> requestData, vector<char> edgesData,
+                                                      UringBackend::Reply reply) {
+            auto deadline = requestDeadline(requestData);
+            auto queuedAt = RequestQueue::Clock::now();
+            // Поток кольца не ждёт обработчика: ответ вернёт reply
+            bool queued = requestQueue.submit(deadline, [this, requestData, edgesData, deadline,
+                                                         queuedAt, reply](bool expired) {
+                Tracer::beginRequest(queuedAt);
+                {
+                    Metrics::StageTimer timer(Metrics::STAGE_QUEUE, queuedAt);
+                }
+                vector<char> responseData;
+                answerRequest(requestData, edgesData.data(), edgesData.size(), deadline, expired,
+                              responseData);
+                // Ответ отправляет поток кольца: он и завершит запрос в трассе
+                reply(move(responseData), Tracer::handOffRequest());
+            });
+            if (!queued) {
+                LOG_WARNING("Очередь запросов заполнена, TCP-запрос отклонён");
+                Metrics::countResponse(OVERLOADED);
+                reply(errorResponseBytes(OVERLOADED), Tracer::Request());
+            }
+        });
+        if (!ran) {
+            Logger::error("Не удалось создать кольцо io_uring");
         }
-        
-        // Проверяем таймауты клиентов
-        checkClientTimeouts();
+        return;
+    }
+
+    // Сокет UDP был неблокирующим для цикла recvfrom, а io_uring для
+    // неблокирующего сокета не ждёт данных и сразу возвращает EAGAIN
+    int flags = fcntl(listener.socket, F_GETFL, 0);
+    fcntl(listener.socket, F_SETFL, flags & ~O_NONBLOCK);
+    Logger::info("UDP-сервер ожидает запросы (io_uring)...");
+    bool ran = uring->runUDP(listener.socket, [this](const vector<char>& datagram, const SocketAddress& from,
+                                                  const UringBackend::DatagramSender& send) {
+        // Кольцо и так отправляет накопленные пакеты одной подачей
+        handleUDPPacket(datagram, from, send, [send](const vector<vector<char>>& packets) {
+            bool sent = true;
+            for (const auto& packet : packets) {
+                sent = send(packet) && sent;
+            }
+            return sent;
+        });
+    });
+    if (!ran) {
+        Logger::error("Не удалось создать кольцо io_uring");
     }
 }
 
+// Разбирает UDP-пакет клиента
+void Server::handleUDPPacket(const vector<char>& packetData, const SocketAddress& clientAddr,
+                             const UringBackend::DatagramSender& send, const ChannelTable::Sender& sendBatch) {
+    // Парсим пакет
+    auto [header, payload] = UDPProtocol::parsePacket(packetData);
+    
+    // Обновляем время последней активности клиента
+    updateClientActivity(clientAddr);
+    
+    // Обрабатываем пакет в зависимости от типа
+    if (header.type == PACKET_DATA) {
+        handleUDPDataPacket(header, payload, clientAddr, send);
+    } else if (header.type == PACKET_ACK) {
+        // Для сервера ACK не требуется (требование 2.9.1)
+        // Клиенты не подтверждают получение ACK
+    } else if (header.type == PACKET_SEGMENT || header.type == PACKET_SACK) {
+        // Надёжный канал: подтверждения и повторы ведёт ChannelTable
+        string clientKey = getClientKey(clientAddr);
+        udpChannels.receive(clientKey, header, payload, sendBatch,
+                            [this, &clientKey, &clientAddr](uint32_t channelId, uint32_t seq,
+                                                            vector<char>& message) {
+            handleUDPChannelMessage(clientKey, channelId, seq, message, clientAddr);
+        });
+    }
+    
+    // Проверяем таймауты клиентов
+    checkClientTimeouts();
+}
+
 // Обновляет информацию об активности клиента
-void Server::updateClientActivity(const sockaddr_in& clientAddr) {
+void Server::updateClientActivity(const SocketAddress& clientAddr) {
     lock_guard<mutex> lock(clientsMutex);
     
     string clientKey = getClientKey(clientAddr);
@@ -201,80 +577,115 @@ void Server::checkClientTimeouts() {
 }
 
 // Получает ключ клиента из адреса
-string Server::getClientKey(const sockaddr_in& clientAddr) {
-    char ip[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &clientAddr.sin_addr, ip, INET_ADDRSTRLEN);
-    return string(ip) + ":" + to_string(ntohs(clientAddr.sin_port));
+string Server::getClientKey(const SocketAddress& clientAddr) {
+    return clientAddr.toString();
 }
 
 // Обрабатывает UDP-пакет с данными
 void Server::handleUDPDataPacket(const UDPPacketHeader& header, 
                                  const vector<char>& payload, 
-                                 const sockaddr_in& clientAddr) {
+                                 const SocketAddress& clientAddr,
+                                 const UringBackend::DatagramSender& send) {
     // 1. Немедленно отправляем ACK (требование 2.9.1)
-    sendAck(header.packet_id, clientAddr);
+    sendAck(header.packet_id, send);
     
-    // 2. Обрабатываем полезную нагрузку
-    processUDPRequest(payload, clientAddr);
+    // 2. Ставим запрос в очередь: ответ уходит с тем же ID, что и запрос
+    // (ответ может обогнать ACK, и клиент всё равно узнает свой ответ)
+    uint32_t packetId = header.packet_id;
+    submitUDPRequest(payload, clientAddr, [packetId, send](const vector<char>& responseData) {
+        return send(UDPProtocol::createDataPacket(packetId, responseData));
+    });
+}
+
+// Запрос из канала клиента
+void Server::handleUDPChannelMessage(const string& clientKey, uint32_t channelId, uint32_t seq,
+                                     const vector<char>& message, const SocketAddress& clientAddr) {
+    // Ответы на запросы одного канала могут быть готовы в любом порядке:
+    // клиент узнаёт свой ответ по номеру сегмента запроса
+    submitUDPRequest(message, clientAddr, [this, clientKey, channelId, seq](const vector<char>& responseData) {
+        vector<char> reply(sizeof(seq) + responseData.size());
+        memcpy(reply.data(), &seq, sizeof(seq));
+        if (!responseData.empty()) {
+            memcpy(reply.data() + sizeof(seq), responseData.data(), responseData.size());
+        }
+        return udpChannels.send(clientKey, channelId, reply);
+    });
+}
+
+// Ставит UDP-запрос в очередь
+void Server::submitUDPRequest(const vector<char>& payload, const SocketAddress& clientAddr, UDPReply reply) {
+    // Цикл приёма не ждёт поиска пути и продолжает принимать пакеты
+    // остальных клиентов
+    auto deadline = requestDeadline(payload);
+    auto queuedAt = RequestQueue::Clock::now();
+    bool queued = requestQueue.submit(deadline, [this, payload, clientAddr, deadline, queuedAt,
+                                                 reply](bool expired) {
+        Tracer::beginRequest(queuedAt);
+        {
+            Metrics::StageTimer timer(Metrics::STAGE_QUEUE, queuedAt);
+        }
+        processUDPRequest(payload, clientAddr, deadline, expired, reply);
+        Tracer::endRequest();
+    });
+    if (!queued) {
+        LOG_WARNING("Очередь запросов заполнена, UDP-запрос от ", getClientKey(clientAddr), " отклонён");
+        sendUDPError(OVERLOADED, reply);
+    }
+}
+
+// Отправляет UDP-ответ с кодом ошибки
+void Server::sendUDPError(int errorCode, const UDPReply& reply) {
+    Metrics::countResponse(errorCode);
+    reply(errorResponseBytes(errorCode));
 }
 
 // Отправляет ACK-пакет
-bool Server::sendAck(uint32_t packet_id, const sockaddr_in& clientAddr) {
+bool Server::sendAck(uint32_t packet_id, const UringBackend::DatagramSender& send) {
     vector<char> ackPacket = UDPProtocol::createAckPacket(packet_id);
-    return sendUDP(ackPacket, clientAddr);
+    return send(ackPacket);
 }
 
 // Обрабатывает UDP-запрос
-void Server::processUDPRequest(const vector<char>& payload, const sockaddr_in& clientAddr) {
+void Server::processUDPRequest(const vector<char>& payload, const SocketAddress& clientAddr,
+                               RequestQueue::Clock::time_point deadline, bool expired, const UDPReply& reply) {
     try {
-        // Минимальный размер: запрос (8 байт) + количество рёбер (4 байта)
-        if (payload.size() < 12) {
+        // Запрос ждал в очереди дольше срока - клиент ответа уже не ждёт
+        if (expired) {
+            LOG_WARNING("Срок UDP-запроса от ", getClientKey(clientAddr), " истёк в очереди");
+            sendUDPError(DEADLINE_EXCEEDED, reply);
+            return;
+        }
+
+        // Минимальный размер: запрос (12 байт) + количество рёбер (4 байта)
+        if (payload.size() < REQUEST_SIZE + sizeof(uint32_t)) {
             Logger::error("Слишком маленький пакет данных");
             return;
         }
         
-        // Первые 8 байт - запрос
-        vector<char> requestData(payload.begin(), payload.begin() + 8);
-        ClientRequest request = bytesToRequest(requestData);
+        // Первые 12 байт - запрос
+        vector<char> requestData(payload.begin(), payload.begin() + REQUEST_SIZE);
         
-        // Остальное - данные о рёбрах
-        vector<char> edgesData(payload.begin() + 8, payload.end());
+        // Остальное - данные о рёбрах (разбираются прямо из пакета)
+        const char* edgesData = payload.data() + REQUEST_SIZE;
+        size_t edgesSize = payload.size() - REQUEST_SIZE;
         
-        int numEdges;
-        memcpy(&numEdges, edgesData.data(), sizeof(int));
+        LOG_INFO("Получен UDP-запрос от ", getClientKey(clientAddr));
         
-        vector<vector<int>> edges;
-        size_t offset = sizeof(int);
-        
-        for (int i = 0; i < numEdges && offset + 2 * sizeof(int) <= edgesData.size(); i++) {
-            int from, to;
-            memcpy(&from, edgesData.data() + offset, sizeof(int));
-            offset += sizeof(int);
-            memcpy(&to, edgesData.data() + offset, sizeof(int));
-            offset += sizeof(int);
-            
-            edges.push_back({from, to});
+        // Обрабатываем запрос (с учётом кэша ответов)
+        vector<char> responseData;
+        if (!handleRequest(requestData, edgesData, edgesSize, deadline, responseData)) {
+            return;
         }
         
-        Logger::info("Получен UDP-запрос от " + getClientKey(clientAddr));
-        
-        // Обрабатываем запрос
-        ServerResponse response;
-        processRequest(request, edges, response);
-        
-        // Сериализуем ответ
-        vector<char> responseData = responseToBytes(response);
-        
-        // Создаём пакет с данными
-        uint32_t packet_id = getNextPacketId();
-        vector<char> dataPacket = UDPProtocol::createDataPacket(packet_id, responseData);
-        
-        // Даём клиенту время перейти из waitForAck() в receiveResponse()
-        this_thread::sleep_for(chrono::milliseconds(50));
-        
-        // Отправляем ответ (без ожидания подтверждения для сервера)
-        if (sendUDP(dataPacket, clientAddr)) {
-            Logger::info("Ответ отправлен клиенту " + getClientKey(clientAddr));
+        // Отправляем ответ: пакетом с ID запроса (без подтверждения) или
+        // в канал клиента (с повтором до подтверждения)
+        bool sent;
+        {
+            Metrics::StageTimer timer(Metrics::STAGE_SEND);
+            sent = reply(responseData);
+        }
+        if (sent) {
+            LOG_INFO("Ответ отправлен клиенту ", getClientKey(clientAddr));
         } else {
             Logger::error("Не удалось отправить ответ клиенту");
         }
@@ -291,6 +702,12 @@ uint32_t Server::getNextPacketId() {
 
 // Обрабатывает TCP-клиента
 void Server::handleTCPClient(int clientSocket) {
+    // Ожидание ответа обработчика из очереди (одно на всё подключение:
+    // обработчик сообщает о готовности под мьютексом и больше ничего не трогает)
+    mutex doneMutex;
+    condition_variable doneCondition;
+    bool done = false;
+
     while (isRunning) {
         vector<char> requestData;
         
@@ -298,93 +715,222 @@ void Server::handleTCPClient(int clientSocket) {
             break;
         }
         
-        ClientRequest request = bytesToRequest(requestData);
-        
         vector<char> edgesData;
         if (!receiveTCP(clientSocket, edgesData)) {
             break;
         }
+        auto deadline = requestDeadline(requestData);
+        auto queuedAt = RequestQueue::Clock::now();
         
-        if (edgesData.size() < sizeof(int)) {
-            Logger::error("Некорректные данные о рёбрах");
+        // Запрос выполняет обработчик из очереди (вместе с отправкой ответа,
+        // чтобы этапы запроса остались в одном потоке для трассы), а поток
+        // подключения ждёт: ответы уходят в порядке запросов
+        bool keepConnection = false;
+        done = false;
+        bool queued = requestQueue.submit(deadline, [&](bool expired) {
+            Tracer::beginRequest(queuedAt);
+            {
+                Metrics::StageTimer timer(Metrics::STAGE_QUEUE, queuedAt);
+            }
+            vector<char> responseData;
+            if (answerRequest(requestData, edgesData.data(), edgesData.size(), deadline, expired,
+                              responseData)) {
+                Metrics::StageTimer timer(Metrics::STAGE_SEND);
+                keepConnection = sendTCP(clientSocket, responseData);
+            }
+            Tracer::endRequest();
+            lock_guard<mutex> lock(doneMutex);
+            done = true;
+            doneCondition.notify_one();
+        });
+        if (queued) {
+            unique_lock<mutex> lock(doneMutex);
+            doneCondition.wait(lock, [&done] { return done; });
+        } else {
+            // Очередь заполнена: отвечаем сразу, не дожидаясь обработчика
+            LOG_WARNING("Очередь запросов заполнена, TCP-запрос отклонён");
+            Metrics::countResponse(OVERLOADED);
+            keepConnection = sendTCP(clientSocket, errorResponseBytes(OVERLOADED));
+        }
+        if (!keepConnection) {
             break;
         }
-        
-        int numEdges;
-        memcpy(&numEdges, edgesData.data(), sizeof(int));
-        
-        vector<vector<int>> edges;
-        size_t offset = sizeof(int);
-        
-        for (int i = 0; i < numEdges && offset + 2 * sizeof(int) <= edgesData.size(); i++) {
-            int from, to;
-            memcpy(&from, edgesData.data() + offset, sizeof(int));
-            offset += sizeof(int);
-            memcpy(&to, edgesData.data() + offset, sizeof(int));
-            offset += sizeof(int);
-            
-            edges.push_back({from, to});
+    }
+    
+    LOG_INFO("TCP-клиент отключён");
+}
+
+// Обслуживает клиента канала в общей памяти
+void Server::handleShmClient(int clientSocket) {
+    ShmChannel channel;
+    if (!channel.receiveDescriptors(clientSocket)) {
+        LOG_WARNING("Клиент shm не передал корректную область памяти");
+        return;
+    }
+    // Подтверждение: клиент начинает писать запросы только после него
+    char ready = 'R';
+    if (send(clientSocket, &ready, sizeof(ready), MSG_NOSIGNAL) != sizeof(ready)) {
+        return;
+    }
+    LOG_INFO("Клиент shm подключён, область рёбер ", channel.edgeAreaSize(), " байт");
+
+    mutex doneMutex;
+    condition_variable doneCondition;
+    bool done = false;
+
+    // Записывает ответ в кольцо; клиент ждёт ответы по порядку и освобождает
+    // ячейку до следующего запроса, поэтому кольцо ответов не переполняется
+    auto publishResponse = [&channel](const vector<char>& responseData) {
+        ShmResponseSlot* slot = channel.responseSlot();
+        if (slot == nullptr || responseData.size() > SHM_RESPONSE_CAPACITY) {
+            return false;
         }
-        
-        ServerResponse response;
-        processRequest(request, edges, response);
-        
-        vector<char> responseData = responseToBytes(response);
-        
-        if (!sendTCP(clientSocket, responseData)) {
+        memcpy(slot->data, responseData.data(), responseData.size());
+        slot->size = static_cast<uint32_t>(responseData.size());
+        channel.publishResponse();
+        return true;
+    };
+
+    while (isRunning) {
+        ShmRequestSlot* slot = channel.waitRequest(clientSocket);
+        if (slot == nullptr) {
+            break;
+        }
+        // Ячейку читаем один раз: клиент не должен менять её до ответа,
+        // но сервер всё равно не полагается на это при проверке границ
+        uint32_t requestSize = min<uint32_t>(slot->requestSize, REQUEST_SIZE);
+        vector<char> requestData(slot->request, slot->request + requestSize);
+        uint64_t edgesOffset = slot->edgesOffset;
+        uint64_t edgesSize = slot->edgesSize;
+        channel.releaseRequest();
+
+        // Рёбра разбираются прямо из общей памяти, без копии
+        const char* edgesData = channel.edgesAt(edgesOffset, edgesSize);
+        if (edgesData == nullptr) {
+            LOG_WARNING("Запрос shm ссылается за пределы области рёбер");
+            break;
+        }
+        auto deadline = requestDeadline(requestData);
+        auto queuedAt = RequestQueue::Clock::now();
+
+        // Как в handleTCPClient: запрос выполняет обработчик из очереди
+        // (допуск и сроки те же), поток подключения ждёт его
+        bool keepConnection = false;
+        done = false;
+        bool queued = requestQueue.submit(deadline, [&](bool expired) {
+            Tracer::beginRequest(queuedAt);
+            {
+                Metrics::StageTimer timer(Metrics::STAGE_QUEUE, queuedAt);
+            }
+            vector<char> responseData;
+            if (answerRequest(requestData, edgesData, static_cast<size_t>(edgesSize), deadline, expired,
+                              responseData)) {
+                Metrics::StageTimer timer(Metrics::STAGE_SEND);
+                keepConnection = publishResponse(responseData);
+            }
+            Tracer::endRequest();
+            lock_guard<mutex> lock(doneMutex);
+            done = true;
+            doneCondition.notify_one();
+        });
+        if (queued) {
+            unique_lock<mutex> lock(doneMutex);
+            doneCondition.wait(lock, [&done] { return done; });
+        } else {
+            LOG_WARNING("Очередь запросов заполнена, запрос shm отклонён");
+            Metrics::countResponse(OVERLOADED);
+            keepConnection = publishResponse(errorResponseBytes(OVERLOADED));
+        }
+        if (!keepConnection) {
             break;
         }
     }
-    
-    close(clientSocket);
-    Logger::info("TCP-клиент отключён");
+
+    LOG_INFO("Клиент shm отключён");
 }
 
 // Получает UDP-пакет
-bool Server::receiveUDPPacket(vector<char>& data, sockaddr_in& clientAddr) {
+bool Server::receiveUDPPacket(int socket, vector<char>& data, SocketAddress& clientAddr) {
     char buffer[BUFFER_SIZE];
-    socklen_t addrLen = sizeof(clientAddr);
+    clientAddr.length = sizeof(clientAddr.storage);
     
-    int bytesRead = recvfrom(serverSocket, buffer, BUFFER_SIZE, 0,
-                            (sockaddr*)&clientAddr, &addrLen);
+    int bytesRead = recvfrom(socket, buffer, BUFFER_SIZE, 0,
+                            clientAddr.get(), &clientAddr.length);
     
     if (bytesRead <= 0) {
         return false;
     }
     
+    Metrics::add(Metrics::BYTES_RECEIVED, bytesRead);
     data.assign(buffer, buffer + bytesRead);
     return true;
 }
 
 // Отправляет данные по UDP
-bool Server::sendUDP(const vector<char>& data, const sockaddr_in& clientAddr) {
-    int bytesSent = sendto(serverSocket, data.data(), data.size(), 0,
-                          (sockaddr*)&clientAddr, sizeof(clientAddr));
+bool Server::sendUDP(int socket, const vector<char>& data, const SocketAddress& clientAddr) {
+    int bytesSent = sendto(socket, data.data(), data.size(), 0,
+                          clientAddr.get(), clientAddr.length);
+    if (bytesSent > 0) {
+        Metrics::add(Metrics::BYTES_SENT, bytesSent);
+    }
     return bytesSent > 0;
 }
 
+// Отправляет пачку пакетов по UDP
+bool Server::sendUDPBatch(int socket, const vector<vector<char>>& packets, const SocketAddress& clientAddr) {
+    vector<iovec> iovecs(packets.size());
+    vector<mmsghdr> messages(packets.size());
+    for (size_t i = 0; i < packets.size(); i++) {
+        iovecs[i].iov_base = const_cast<char*>(packets[i].data());
+        iovecs[i].iov_len = packets[i].size();
+        messages[i].msg_hdr.msg_name = const_cast<sockaddr*>(clientAddr.get());
+        messages[i].msg_hdr.msg_namelen = clientAddr.length;
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    // sendmmsg может отправить не всё (буфер сокета заполнен): остаток -
+    // следующим вызовом, а при ошибке пакеты считаются потерянными
+    size_t sent = 0;
+    while (sent < messages.size()) {
+        int count = sendmmsg(socket, messages.data() + sent, messages.size() - sent, 0);
+        if (count <= 0) {
+            return false;
+        }
+        for (int i = 0; i < count; i++) {
+            Metrics::add(Metrics::BYTES_SENT, messages[sent + i].msg_len);
+        }
+        sent += count;
+    }
+    return true;
+}
+
 // Отправляет данные по TCP
 bool Server::sendTCP(int socket, const vector<char>& data) {
     uint32_t dataSize = data.size();
     uint32_t networkSize = htonl(dataSize);
     
-    if (send(socket, &networkSize, sizeof(networkSize), 0) < 0) {
+    // MSG_NOSIGNAL: клиент, не дождавшийся ответа и закрывший соединение,
+    // не должен завершать сервер сигналом SIGPIPE
+    if (send(socket, &networkSize, sizeof(networkSize), MSG_NOSIGNAL) < 0) {
         return false;
     }
     
-    if (send(socket, data.data(), data.size(), 0) < 0) {
+    if (send(socket, data.data(), data.size(), MSG_NOSIGNAL) < 0) {
         return false;
     }
     
+    Metrics::add(Metrics::BYTES_SENT, sizeof(networkSize) + data.size());
     return true;
 }
 
 // Получает данные по TCP
 bool Server::receiveTCP(int socket, vector<char>& data) {
+    // MSG_WAITALL: кадр может прийти частями (особенно когда клиент шлёт
+    // запросы подряд, не дожидаясь ответов), а один recv вернул бы первую часть
     uint32_t networkSize;
-    int bytesRead = recv(socket, &networkSize, sizeof(networkSize), 0);
+    int bytesRead = recv(socket, &networkSize, sizeof(networkSize), MSG_WAITALL);
     
-    if (bytesRead <= 0) {
+    if (bytesRead != sizeof(networkSize)) {
         return false;
     }
     
@@ -396,66 +942,150 @@ bool Server::receiveTCP(int socket, vector<char>& data) {
     }
     
     char buffer[BUFFER_SIZE];
-    bytesRead = recv(socket, buffer, dataSize, 0);
+    bytesRead = recv(socket, buffer, dataSize, MSG_WAITALL);
     
-    if (bytesRead <= 0) {
+    if (bytesRead <= 0 || static_cast<uint32_t>(bytesRead) != dataSize) {
         return false;
     }
     
+    Metrics::add(Metrics::BYTES_RECEIVED, sizeof(networkSize) + bytesRead);
     data.assign(buffer, buffer + bytesRead);
     return true;
 }
 
+// Обрабатывает один запрос целиком (общая часть TCP и UDP)
+bool Server::handleRequest(const vector<char>& requestData,
+                           const char* edgesData, size_t edgesSize,
+                           RequestQueue::Clock::time_point deadline,
+                           vector<char>& responseData) {
+    Metrics::add(Metrics::REQUESTS);
+
+    if (requestData.size() < 2 * sizeof(int)) {
+        Logger::error("Некорректные данные запроса");
+        Metrics::add(Metrics::MALFORMED_REQUESTS);
+        return false;
+    }
+    
+    // Временные структуры запроса живут в арене и освобождаются разом в конце
+    RequestArena arena;
+
+    // Разбираем рёбра и сразу считаем хэш графа и компоненты связности
+    ClientRequest request;
+    pmr::vector<Edge> edges(arena.resource());
+    uint64_t graphHash;
+    DisjointSet components(arena.resource());
+    bool decoded;
+    {
+        Metrics::StageTimer timer(Metrics::STAGE_DECODE);
+        request = bytesToRequest(requestData);
+        decoded = bytesToEdges(edgesData, edgesSize, edges, graphHash, components);
+    }
+    if (!decoded) {
+        Logger::error("Некорректные данные о рёбрах");
+        Metrics::add(Metrics::MALFORMED_REQUESTS);
+        return false;
+    }
+    
+    // Тот же граф с теми же вершинами уже обрабатывался - отдаём готовый ответ
+    CacheKey key{graphHash, request.start_node, request.end_node, graphSignature(edges)};
+    if (resultCache.get(key, responseData)) {
+        LOG_INFO("Ответ найден в кэше");
+        // Код ошибки - первые байты сериализованного ответа
+        int errorCode;
+        memcpy(&errorCode, responseData.data(), sizeof(int));
+        Metrics::countResponse(errorCode);
+        return true;
+    }
+    
+    // Готового ответа нет, а срок уже истёк (долгий разбор большого графа):
+    // построение графа и поиск пути пропускаются
+    if (RequestQueue::Clock::now() > deadline) {
+        LOG_WARNING("Срок запроса истёк до поиска пути");
+        Metrics::countResponse(DEADLINE_EXCEEDED);
+        responseData = errorResponseBytes(DEADLINE_EXCEEDED);
+        return true;
+    }
+    
+    // Граф уже встречался (с другими вершинами) - не строим его заново
+    shared_ptr<const StoredGraph> stored = graphStore.find(graphHash, key.graph);
+    if (!stored) {
+        Metrics::StageTimer timer(Metrics::STAGE_GRAPH_BUILD);
+        stored = graphStore.insert(StoredGraph::build(graphHash, key.graph, edges, components));
+    }
+    
+    // Частые графы получают иерархию сжатий (строится в фоне)
+    graphStore.noteQuery(stored);
+
+    ServerResponse response;
+    {
+        Metrics::StageTimer timer(Metrics::STAGE_SEARCH);
+        processRequest(request, *stored, response);
+    }
+    Metrics::countResponse(response.error_code);
+    
+    {
+        Metrics::StageTimer timer(Metrics::STAGE_ENCODE);
+        responseData = responseToBytes(response);
+    }
+    resultCache.put(key, responseData);
+    return true;
+}
+
+// Ответ на запрос в обработчике очереди
+bool Server::answerRequest(const vector<char>& requestData, const char* edgesData, size_t edgesSize,
+                           RequestQueue::Clock::time_point deadline, bool expired,
+                           vector<char>& responseData) {
+    if (expired) {
+        LOG_WARNING("Срок TCP-запроса истёк в очереди");
+        Metrics::countResponse(DEADLINE_EXCEEDED);
+        responseData = errorResponseBytes(DEADLINE_EXCEEDED);
+        return true;
+    }
+    return handleRequest(requestData, edgesData, edgesSize, deadline, responseData);
+}
+
 // Обрабатывает запрос клиента
 void Server::processRequest(const ClientRequest& request, 
-                           const vector<vector<int>>& edges, 
+                           const StoredGraph& stored, 
                            ServerResponse& response) {
-    Graph graph;
-    
-    try {
-        graph.addEdges(edges);
-        
-        if (!graph.hasMinimumSize()) {
-            response.error_code = INVALID_REQUEST;
-            response.path_length = 0;
-            Logger::warning("Граф не соответствует минимальному размеру");
-            return;
-        }
-        
-        if (!graph.hasMaximumSize()) {
-            response.error_code = INVALID_REQUEST;
-            response.path_length = 0;
-            Logger::warning("Граф превышает максимальный размер");
-            return;
-        }
-        
-        if (!graph.containsVertices(request.start_node, request.end_node)) {
-            response.error_code = INVALID_REQUEST;
-            response.path_length = 0;
-            Logger::warning("Вершины не найдены в графе");
-            return;
-        }
-        
-    } catch (const std::exception& e) {
+    if (stored.errorCode != SUCCESS) {
         response.error_code = INVALID_REQUEST;
         response.path_length = 0;
-        Logger::error(string("Ошибка при построении графа: ") + e.what());
+        Logger::warning(stored.errorMessage);
         return;
     }
     
-    int maxNode = 0;
-    for (const auto& edge : edges) {
-        maxNode = max(maxNode, max(edge[0], edge[1]));
+    if (!stored.graph.containsVertices(request.start_node, request.end_node)) {
+        response.error_code = INVALID_REQUEST;
+        response.path_length = 0;
+        Logger::warning("Вершины не найдены в графе");
+        return;
     }
     
-    Dijkstra dijkstra(maxNode + 1);
-    
-    for (const auto& edge : edges) {
-        dijkstra.addEdge(edge[0], edge[1]);
-        dijkstra.addEdge(edge[1], edge[0]);
+    // Вершины в разных компонентах связности - путь искать бессмысленно
+    if (!stored.connected(request.start_node, request.end_node)) {
+        response.error_code = NO_PATH;
+        response.path_length = 0;
+        Logger::warning("Путь между вершинами не существует (разные компоненты связности)");
+        return;
     }
     
-    pair<int, vector<int>> result = dijkstra.findPath(request.start_node, request.end_node);
+    // Иерархия сжатий (если фоновый поток её уже построил) обрабатывает
+    // меньше всего вершин, затем A* с ориентирами (ALT), затем обычный поиск
+    SearchStats stats;
+    pair<double, vector<int>> result;
+    const char* method;
+    shared_ptr<const ContractionHierarchy> hierarchy = stored.getHierarchy();
+    if (hierarchy) {
+        result = hierarchy->findPath(request.start_node, request.end_node, &stats);
+        method = "CH";
+    } else if (!stored.landmarks.empty()) {
+        result = stored.landmarks.findPath(stored.search, request.start_node, request.end_node, &stats);
+        method = "ALT";
+    } else {
+        result = stored.search.findPath(request.start_node, request.end_node, &stats);
+        method = "Дейкстра";
+    }
     
     if (result.first == INF) {
         response.error_code = NO_PATH;
@@ -465,6 +1095,8 @@ void Server::processRequest(const ClientRequest& request,
         response.error_code = SUCCESS;
         response.path_length = result.first;
         response.path = result.second;
-        Logger::info("Путь найден, длина: " + to_string(result.first));
+        // Строка собирается, только если уровень INFO включён
+        LOG_INFO("Путь найден, длина: ", result.first,
+                 " (", method, ", обработано вершин: ", stats.settled, ")");
     }
-}
\ No newline at end of file
+}
@@ -7,16 +7,23 @@
 #include <atomic>
 #include <mutex>
 #include <unordered_map>
+#include <memory>
+#include <sstream>
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
 #include <csignal>
 #include <cstdlib>
 #include <cstring>
 #include <chrono>
+#include <condition_variable>
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <poll.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 
@@ -25,8 +32,19 @@
 #include "../common/Protocol.h"
 #include "../utils/Validator.h"
 #include "../common/UDPProtocol.h"
+#include "../server/ChannelTable.h"
+#include "../common/SocketAddress.h"
 #include "../common/Dijkstra.h"
 #include "../utils/Logger.h"
+#include "../server/ResultCache.h"
+#include "../server/GraphStore.h"
+#include "../server/RequestArena.h"
+#include "../server/Metrics.h"
+#include "../server/Tracer.h"
+#include "../server/RequestQueue.h"
+#include "../server/ConnectionManager.h"
+#include "../server/UringBackend.h"
+#include "../common/ShmChannel.h"
 
 using namespace std;
 
@@ -34,6 +52,9 @@ using namespace std;
 
 // Поддерживает работу по протоколам TCP и UDP
 // Может обслуживать несколько клиентов одновременно (минимум 3)
+// Может слушать несколько сокетов сразу (например, TCP и UDP на одном
+// порту): у каждого свой поток ввода-вывода, а обработчики запросов,
+// хранилище графов и кэш ответов - общие
 
 class Server {
 public:
@@ -59,18 +80,64 @@ public:
     void stop();
 
     // Главный цикл обработки запросов
-    // Принимает подключения клиентов и создаёт для них отдельные потоки
+    // Принимает подключения клиентов и создаёт для них отдельные потоки.
+    // Каждый слушающий сокет, кроме первого, обслуживает свой поток, первый -
+    // вызвавший поток; run возвращается, когда остановлены все
     void run();
 
+    // Добавляет ещё один слушающий сокет (вызывать до start)
+    // protocol "tcp", "udp" или "shm"
+    // port Порт (если unixPath пуст); TCP и UDP могут слушать один и тот же порт
+    // unixPath Путь Unix-сокета (пусто - порт)
+    void addListener(const string& protocol, int port, const string& unixPath);
+
+    // Слушать Unix-сокет по пути path вместо порта (вызывать до start).
+    // "tcp" - потоковый сокет с теми же кадрами, "udp" - датаграммный
+    // с теми же пакетами и ACK; стек TCP/IP для локальных клиентов не нужен.
+    // "shm" - только Unix-сокет: запросы и ответы идут через общую память (ShmChannel)
+    // Относится к сокету, заданному в конструкторе
+    void setUnixPath(const string& path);
+
+    // Включает HTTP-точку метрик Prometheus на 127.0.0.1:port (вызывать до start)
+    void enableMetrics(int port);
+
+    // Ограничения нагрузки (вызывать до start)
+    // maxConnections Наибольшее число одновременных TCP-подключений;
+    //                лишние сразу получают OVERLOADED и закрываются
+    // queueCapacity  Сколько запросов может ждать обработчика; при
+    //                заполненной очереди запрос получает OVERLOADED
+    // deadlineMs     Срок ответа для запросов, в которых клиент его не указал
+    // 0 - оставить значение по умолчанию
+    void setLimits(int maxConnections, size_t queueCapacity, int deadlineMs);
+
+    // Сколько потоков TCP-подключений после конца подключения ждут
+    // следующего, а не завершаются (0 - новый поток на каждое подключение)
+    void setPooledThreads(size_t count);
+
+    // Ввод-вывод через io_uring вместо потока на подключение (вызывать до start).
+    // Если ядро io_uring не поддерживает, сервер работает как обычно
+    void enableUring();
+
 private:
-    int port;                    // Порт сервера
-    string protocol;             // Тип протокола (tcp/udp)
-    int serverSocket;            // Дескриптор серверного сокета
+    // Слушающий сокет одного протокола со своим потоком ввода-вывода
+    struct Listener {
+        string protocol;             // Тип протокола (tcp/udp/shm)
+        int port = 0;                // Порт сервера
+        string unixPath;             // Путь Unix-сокета (пусто - сокет AF_INET на порту)
+        int socket = -1;             // Дескриптор серверного сокета
+        // Ввод-вывод через io_uring (nullptr - потоки подключений и блокирующие вызовы);
+        // у каждого сокета своё кольцо: кольцо ведёт один поток
+        unique_ptr<UringBackend> uring;
+        thread ioThread;             // Поток ввода-вывода (у первого сокета - поток run)
+
+        // Адрес для лога: "порт 8080 (tcp)" или "unix:/путь (shm)"
+        string describe() const;
+    };
+
+    // Слушающие сокеты (первый задан в конструкторе)
+    vector<unique_ptr<Listener>> listeners;
     atomic<bool> isRunning;      // Флаг работы сервера (атомарный для многопоточности)
     
-    // Вектор потоков для обработки клиентов
-    vector<thread> clientThreads;
-    
     // Для надёжной UDP-доставки - атомарный счётчик идентификаторов пакетов
     // 
     // Назначение:
@@ -131,62 +198,172 @@ private:
     mutex clientsMutex;
     unordered_map<string, chrono::steady_clock::time_point> activeClients;
 
+    // Кэш готовых ответов: (хэш графа, start, end) -> байты ServerResponse
+    // Общий для всех потоков клиентов
+    ResultCache resultCache;
+
+    // Ограничения нагрузки (см. setLimits, setPooledThreads)
+    int maxConnections;
+    size_t pooledThreads;
+    size_t queueCapacity;
+    chrono::milliseconds defaultDeadline;
+
+    // Очередь запросов: поиск пути выполняют обработчики из пула,
+    // а потоки подключений и цикл UDP только принимают и ставят запросы
+    RequestQueue requestQueue;
+
+    // Надёжные каналы UDP-клиентов (запросы и ответы с окном и повтором)
+    ChannelTable udpChannels;
+
+    // Срок ответа на запрос: от текущего момента плюс срок из запроса
+    // (или срок по умолчанию, если клиент его не указал)
+    RequestQueue::Clock::time_point requestDeadline(const vector<char>& requestData) const;
+
+    // Потоки TCP-подключений: ограничение числа подключений, повторное
+    // использование потоков и присоединение завершившихся
+    ConnectionManager connections;
+
+    // Ввод-вывод через io_uring (кольца - у слушающих сокетов)
+    bool uringRequested;
+
+    // Порт метрик (0 - метрики по HTTP не отдаются) и сама HTTP-точка
+    int metricsPort;
+    MetricsEndpoint metricsEndpoint;
+
+    // Регистрирует метрики, которые считаются по состоянию сервера
+    // (подключения, клиенты UDP, кэш, хранилище графов, очереди)
+    void registerMetrics();
+
+    // Хранилище уже встречавшихся графов: проверенный граф, список смежности
+    // и компоненты связности. Запросы к тому же графу с другими вершинами
+    // не строят граф заново и сразу отсекаются по компонентам
+    GraphStore graphStore;
+
     // Создаёт и настраивает серверный сокет
     // true, если сокет успешно создан
-    bool createSocket();
+    bool createSocket(Listener& listener);
+
+    // Цикл ввода-вывода одного сокета (runUring, runTCP или runUDP)
+    void runListener(Listener& listener);
     
-    // Запускает работу с TCP-клиентами
-    void runTCP();
+    // Запускает работу с TCP-клиентами (и клиентами shm)
+    void runTCP(Listener& listener);
     
     // Запускает работу с UDP-клиентами
-    void runUDP();
+    void runUDP(Listener& listener);
+
+    // Запускает работу с клиентами через io_uring
+    void runUring(Listener& listener);
+
+    // Подключение принято сокетом shm (потоки подключений общие у всех
+    // потоковых сокетов, поэтому протокол узнаётся по адресу сокета)
+    bool isShmConnection(int clientSocket) const;
+
+    // Разбирает UDP-пакет клиента и обрабатывает его по типу
+    // packetData Пакет целиком
+    // clientAddr Адрес клиента
+    // send Отправка пакетов этому клиенту
+    // sendBatch Отправка пачки пакетов этому клиенту (пакеты канала)
+    void handleUDPPacket(const vector<char>& packetData, const SocketAddress& clientAddr,
+                         const UringBackend::DatagramSender& send, const ChannelTable::Sender& sendBatch);
 
     // Обрабатывает одного клиента (TCP)
     // clientSocket Дескриптор сокета клиента
  
-    // Эта функция запускается в отдельном потоке для каждого клиента
-    // Читает запросы, обрабатывает их и отправляет ответы
+    // Эта функция выполняется в потоке подключения (ConnectionManager)
+    // Читает запросы, обрабатывает их и отправляет ответы; сокет закрывает менеджер
     void handleTCPClient(int clientSocket);
+
+    // Обслуживает клиента канала в общей памяти (протокол "shm")
+    // clientSocket Unix-сокет клиента: по нему приходят область памяти
+    //              и eventfd, а его закрытие означает конец работы клиента
+    // Выполняется в потоке подключения, как handleTCPClient
+    void handleShmClient(int clientSocket);
     
     // Обрабатывает UDP-пакет с данными
     // header Заголовок пакета
     // payload Полезная нагрузка
     // clientAddr Адрес клиента
+    // send Отправка пакетов клиенту (sendto или sendmsg через io_uring)
     void handleUDPDataPacket(const struct UDPPacketHeader& header, 
                             const vector<char>& payload, 
-                            const sockaddr_in& clientAddr);
+                            const SocketAddress& clientAddr,
+                            const UringBackend::DatagramSender& send);
     
-    // Обрабатывает UDP-запрос
+    // Отправка байтов ответа на UDP-запрос: отдельным пакетом с ID
+    // запроса или сообщением в канал клиента
+    using UDPReply = function<bool(const vector<char>& responseData)>;
+
+    // Запрос из канала клиента (ReliableChannel): ответ уходит в тот же
+    // канал с номером сегмента запроса в начале сообщения
+    void handleUDPChannelMessage(const string& clientKey, uint32_t channelId, uint32_t seq,
+                                 const vector<char>& message, const SocketAddress& clientAddr);
+
+    // Ставит UDP-запрос в очередь (при заполненной очереди отвечает OVERLOADED)
+    void submitUDPRequest(const vector<char>& payload, const SocketAddress& clientAddr, UDPReply reply);
+
+    // Обрабатывает UDP-запрос (в потоке-обработчике очереди)
     // payload Данные запроса
     // clientAddr Адрес клиента
-    void processUDPRequest(const vector<char>& payload, const sockaddr_in& clientAddr);
+    // deadline Срок ответа
+    // expired Срок истёк, пока запрос ждал в очереди
+    // reply Отправка ответа клиенту
+    void processUDPRequest(const vector<char>& payload, const SocketAddress& clientAddr,
+                           RequestQueue::Clock::time_point deadline, bool expired, const UDPReply& reply);
+
+    // Отправляет UDP-ответ с кодом ошибки без пути (OVERLOADED, DEADLINE_EXCEEDED)
+    void sendUDPError(int errorCode, const UDPReply& reply);
     
     // Отправляет ACK-пакет
     // packet_id ID подтверждаемого пакета
-    // clientAddr Адрес клиента
-    bool sendAck(uint32_t packet_id, const sockaddr_in& clientAddr);
+    // send Отправка пакетов клиенту
+    bool sendAck(uint32_t packet_id, const UringBackend::DatagramSender& send);
     
     // Обновляет информацию об активности клиента
     // clientAddr Адрес клиента
-    void updateClientActivity(const sockaddr_in& clientAddr);
+    void updateClientActivity(const SocketAddress& clientAddr);
     
     // Проверяет таймауты клиентов
     void checkClientTimeouts();
     
     // Получает ключ клиента из адреса
     // clientAddr Адрес клиента
-    string getClientKey(const sockaddr_in& clientAddr);
+    string getClientKey(const SocketAddress& clientAddr);
     
     // Получает следующий ID пакета
     uint32_t getNextPacketId();
 
+    // Обрабатывает один запрос целиком: от байтов запроса до байтов ответа
+    // requestData Байты ClientRequest
+    // edgesData, edgesSize Блок рёбер (в пакете, кадре или общей памяти)
+    // deadline Срок ответа
+    // responseData Байты ServerResponse (выходной параметр)
+
+    // Общая часть для TCP, UDP и общей памяти: разбирает рёбра (заодно считая хэш графа
+    // и компоненты связности), ищет готовый ответ в кэше, при промахе
+    // берёт граф из хранилища (или строит его) и вызывает processRequest.
+    // Если срок истёк до построения графа и поиска, отвечает DEADLINE_EXCEEDED
+    // false, если данные запроса некорректны и отвечать нечего
+    bool handleRequest(const vector<char>& requestData, const char* edgesData, size_t edgesSize,
+                       RequestQueue::Clock::time_point deadline, vector<char>& responseData);
+
+    // Ответ на TCP-запрос (или запрос из общей памяти) в обработчике очереди: DEADLINE_EXCEEDED, если
+    // запрос простоял в очереди дольше срока, иначе handleRequest
+    // expired Срок истёк в очереди
+    // false, если отвечать нечего (некорректный запрос)
+    bool answerRequest(const vector<char>& requestData, const char* edgesData, size_t edgesSize,
+                       RequestQueue::Clock::time_point deadline, bool expired,
+                       vector<char>& responseData);
+
     // Обрабатывает запрос на поиск пути в графе
     // request Запрос от клиента
     // response Ответ для клиента
 
-    // Парсит граф из запроса, выполняет алгоритм Дейкстры,
-    // формирует ответ с результатом или ошибкой
-    void processRequest(const ClientRequest& request, const vector<vector<int>>& edges, ServerResponse& response);
+    // Проверяет вершины по сохранённому графу; если они в разных компонентах
+    // связности, сразу отвечает NO_PATH, иначе выполняет поиск пути
+    // (по иерархии сжатий, если она готова, иначе A* с ориентирами ALT)
+    // и формирует ответ
+    void processRequest(const ClientRequest& request, const StoredGraph& stored, ServerResponse& response);
 
     // Отправляет данные по TCP
     // socket Сокет клиента
@@ -199,14 +376,22 @@ private:
     bool receiveTCP(int socket, vector<char>& data);
 
     // Отправляет данные по UDP
+    // socket Сокет UDP сервера
     // data Данные для отправки
     // clientAddr Адрес клиента
-    bool sendUDP(const vector<char>& data, const sockaddr_in& clientAddr);
+    bool sendUDP(int socket, const vector<char>& data, const SocketAddress& clientAddr);
+
+    // Отправляет пачку UDP-пакетов одному клиенту одним вызовом (sendmmsg)
+    // socket Сокет UDP сервера
+    // packets Пакеты
+    // clientAddr Адрес клиента
+    bool sendUDPBatch(int socket, const vector<vector<char>>& packets, const SocketAddress& clientAddr);
 
     // Получает данные по UDP
+    // socket Сокет UDP сервера
     // data Буфер для полученных данных
     // clientAddr Адрес клиента (выходной параметр)
-    bool receiveUDPPacket(vector<char>& data, sockaddr_in& clientAddr);
+    bool receiveUDPPacket(int socket, vector<char>& data, SocketAddress& clientAddr);
 };
 
 #endif
\ No newline at end of file
@@ -20,56 +20,292 @@ void signalHandler(int signal) {
 
 // Выводит справку по использованию программы
 void printUsage(const char* programName) {
-    cout << "Использование: " << programName << " <порт> <протокол>" << endl;
+    cout << "Использование: " << programName << " <порт> <протокол> [параметры]" << endl;
     cout << endl;
     cout << "Параметры:" << endl;
     cout << "  <порт>     - Номер порта для прослушивания (1024-65535)" << endl;
-    cout << "  <протокол> - Протокол: tcp или udp" << endl;
+    cout << "               или unix:<путь> - Unix-сокет для клиентов на той же машине" << endl;
+    cout << "  <протокол> - Протокол: tcp, udp или shm (общая память, только с unix:<путь>);" << endl;
+    cout << "               несколько через запятую (tcp,udp) - на одном порту сразу" << endl;
+    cout << "  --log-level=<уровень> - Минимальный уровень лога: info, warning или error" << endl;
+    cout << "  --metrics-port=<порт> - Отдавать метрики Prometheus на 127.0.0.1:<порт>/metrics" << endl;
+    cout << "  --trace-sample=<N>    - Трассировать каждый N-й запрос (сохранение: kill -USR1 <pid>)" << endl;
+    cout << "  --max-connections=<N> - Наибольшее число TCP-подключений (по умолчанию 256)" << endl;
+    cout << "  --queue-size=<N>      - Наибольшая очередь запросов к обработчикам (по умолчанию 256)" << endl;
+    cout << "  --deadline-ms=<N>     - Срок ответа, если клиент его не указал (по умолчанию 2000 мс)" << endl;
+    cout << "  --pooled-threads=<N>  - Потоков TCP, ждущих следующего подключения (по умолчанию 16," << endl;
+    cout << "                          0 - новый поток на каждое подключение)" << endl;
+    cout << "  --io=<режим>          - Ввод-вывод: threads (потоки подключений, по умолчанию)" << endl;
+    cout << "                          или uring (io_uring; без поддержки ядра - threads)" << endl;
+    cout << "  --listen=<протокол>@<адрес> - Ещё один слушающий сокет (можно несколько раз)," << endl;
+    cout << "                          адрес - порт или unix:<путь>" << endl;
     cout << endl;
     cout << "Примеры:" << endl;
     cout << "  " << programName << " 8080 tcp" << endl;
     cout << "  " << programName << " 12345 udp" << endl;
+    cout << "  " << programName << " unix:/tmp/graph.sock tcp" << endl;
+    cout << "  " << programName << " unix:/tmp/graph.sock shm" << endl;
+    cout << "  " << programName << " 8080 tcp --log-level=warning" << endl;
+    cout << "  " << programName << " 8080 tcp --metrics-port=9100" << endl;
+    cout << "  " << programName << " 8080 tcp --trace-sample=100" << endl;
+    cout << "  " << programName << " 8080 tcp --max-connections=64 --queue-size=32 --deadline-ms=500" << endl;
+    cout << "  " << programName << " 8080 tcp --io=uring" << endl;
+    cout << "  " << programName << " 8080 tcp,udp" << endl;
+    cout << "  " << programName << " 8080 tcp --listen=shm@unix:/tmp/graph.sock" << endl;
+}
+
+// Разбирает положительное целое значение параметра
+// false, если значение не число или не больше нуля
+bool parsePositive(const string& text, int& value) {
+    try {
+        value = stoi(text);
+    } catch (...) {
+        return false;
+    }
+    return value > 0;
+}
+
+// Разбирает адрес сокета: порт или unix:<путь>
+// false (с сообщением в лог), если адрес неверный
+bool parseAddress(const string& address, int& port, string& unixPath) {
+    port = 0;
+    unixPath.clear();
+    if (isUnixAddress(address)) {
+        unixPath = unixAddressPath(address);
+        SocketAddress unixAddr;
+        if (!SocketAddress::unixPath(unixPath, unixAddr)) {
+            Logger::error("Путь Unix-сокета пустой или слишком длинный");
+            return false;
+        }
+        return true;
+    }
+    // Парсим порт из строки в число
+    try {
+        port = stoi(address);
+    } catch (...) {
+        Logger::error("Порт должен быть числом");
+        return false;
+    }
+    
+    // Валидируем порт
+    if (!Validator::isValidPort(port)) {
+        Logger::error("Порт должен быть в диапазоне 1024-65535");
+        return false;
+    }
+    return true;
+}
+
+// Проверяет протокол слушающего сокета
+// false (с сообщением в лог), если протокол неизвестен или не подходит к адресу
+bool checkProtocol(const string& protocol, const string& unixPath) {
+    if (protocol != "tcp" && protocol != "udp" && protocol != "shm") {
+        Logger::error("Протокол должен быть 'tcp', 'udp' или 'shm'");
+        return false;
+    }
+    if (protocol == "shm" && unixPath.empty()) {
+        Logger::error("Протокол shm работает только через Unix-сокет (unix:<путь>)");
+        return false;
+    }
+    return true;
 }
 
 // Главная функция сервера
 int main(int argc, char* argv[]) {
     // Проверяем количество аргументов
     // argv[0] - имя программы
-    // argv[1] - порт
-    // argv[2] - протокол
-    if (argc != 3) {
+    // argv[1] - порт или unix:<путь>
+    // argv[2] - протокол (или несколько через запятую)
+    // argv[3...] - необязательные параметры (--log-level=..., --metrics-port=..., --trace-sample=...,
+    //              --max-connections=..., --queue-size=..., --deadline-ms=..., --pooled-threads=..., --io=...,
+    //              --listen=...)
+    if (argc < 3) {
         Logger::error("Неверное количество аргументов");
         printUsage(argv[0]);
         return 1;
     }
     
-    // Парсим порт из строки в число
-    int port;
-    try {
-        port = stoi(argv[1]);
-    } catch (...) {
-        Logger::error("Порт должен быть числом");
+    // Вместо порта может быть задан Unix-сокет
+    int port = 0;
+    string unixPath;
+    if (!parseAddress(argv[1], port, unixPath)) {
         printUsage(argv[0]);
         return 1;
     }
     
-    // Валидируем порт
-    if (!Validator::isValidPort(port)) {
-        Logger::error("Порт должен быть в диапазоне 1024-65535");
-        return 1;
+    // Получаем протокол (теперь обязательный параметр); несколько
+    // протоколов через запятую - несколько сокетов на одном адресе
+    vector<string> protocols;
+    stringstream protocolList(argv[2]);
+    string protocol;
+    while (getline(protocolList, protocol, ',')) {
+        if (!checkProtocol(protocol, unixPath)) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (find(protocols.begin(), protocols.end(), protocol) != protocols.end()) {
+            Logger::error("Протокол " + protocol + " указан дважды");
+            return 1;
+        }
+        protocols.push_back(protocol);
     }
-    
-    // Получаем протокол (теперь обязательный параметр)
-    string protocol = argv[2];
-    if (protocol != "tcp" && protocol != "udp") {
-        Logger::error("Протокол должен быть 'tcp' или 'udp'");
+    if (protocols.empty()) {
+        Logger::error("Не указан протокол");
         printUsage(argv[0]);
         return 1;
     }
+    // У порта TCP и UDP разные пространства имён, а путь Unix-сокета -
+    // один файл: второй протокол задаётся через --listen с другим путём
+    if (!unixPath.empty() && protocols.size() > 1) {
+        Logger::error("На одном Unix-сокете - только один протокол (остальные через --listen)");
+        return 1;
+    }
+    
+    // Дополнительные сокеты из --listen: (протокол, порт, путь)
+    struct ExtraListener {
+        string protocol;
+        int port;
+        string unixPath;
+    };
+    vector<ExtraListener> extraListeners;
     
+    // Необязательные параметры
+    int metricsPort = 0;
+    int traceSample = 0;
+    // Ограничения нагрузки (0 - значение по умолчанию сервера)
+    int maxConnections = 0;
+    int queueSize = 0;
+    int deadlineMs = 0;
+    int pooledThreads = -1;  // -1 - значение по умолчанию сервера
+    bool useUring = false;
+    for (int i = 3; i < argc; i++) {
+        string option = argv[i];
+        const string levelOption = "--log-level=";
+        const string metricsOption = "--metrics-port=";
+        const string traceOption = "--trace-sample=";
+        const string connectionsOption = "--max-connections=";
+        const string queueOption = "--queue-size=";
+        const string deadlineOption = "--deadline-ms=";
+        const string pooledOption = "--pooled-threads=";
+        const string ioOption = "--io=";
+        const string listenOption = "--listen=";
+        if (option.compare(0, levelOption.size(), levelOption) == 0) {
+            Logger::Level level;
+            if (!Logger::parseLevel(option.substr(levelOption.size()), level)) {
+                Logger::error("Уровень лога должен быть info, warning или error");
+                printUsage(argv[0]);
+                return 1;
+            }
+            Logger::setLevel(level);
+        } else if (option.compare(0, metricsOption.size(), metricsOption) == 0) {
+            try {
+                metricsPort = stoi(option.substr(metricsOption.size()));
+            } catch (...) {
+                metricsPort = -1;
+            }
+            if (!Validator::isValidPort(metricsPort) || metricsPort == port) {
+                Logger::error("Порт метрик должен быть в диапазоне 1024-65535 и отличаться от порта сервера");
+                return 1;
+            }
+        } else if (option.compare(0, traceOption.size(), traceOption) == 0) {
+            try {
+                traceSample = stoi(option.substr(traceOption.size()));
+            } catch (...) {
+                traceSample = -1;
+            }
+            if (traceSample < 1) {
+                Logger::error("Частота трассировки должна быть положительным числом");
+                return 1;
+            }
+        } else if (option.compare(0, connectionsOption.size(), connectionsOption) == 0) {
+            if (!parsePositive(option.substr(connectionsOption.size()), maxConnections)) {
+                Logger::error("Число подключений должно быть положительным числом");
+                return 1;
+            }
+        } else if (option.compare(0, queueOption.size(), queueOption) == 0) {
+            if (!parsePositive(option.substr(queueOption.size()), queueSize)) {
+                Logger::error("Размер очереди должен быть положительным числом");
+                return 1;
+            }
+        } else if (option.compare(0, deadlineOption.size(), deadlineOption) == 0) {
+            if (!parsePositive(option.substr(deadlineOption.size()), deadlineMs)) {
+                Logger::error("Срок ответа должен быть положительным числом");
+                return 1;
+            }
+        } else if (option.compare(0, pooledOption.size(), pooledOption) == 0) {
+            try {
+                pooledThreads = stoi(option.substr(pooledOption.size()));
+            } catch (...) {
+                pooledThreads = -1;
+            }
+            if (pooledThreads < 0) {
+                Logger::error("Число ждущих потоков должно быть неотрицательным числом");
+                return 1;
+            }
+        } else if (option.compare(0, ioOption.size(), ioOption) == 0) {
+            string mode = option.substr(ioOption.size());
+            if (mode != "threads" && mode != "uring") {
+                Logger::error("Режим ввода-вывода должен быть threads или uring");
+                return 1;
+            }
+            useUring = mode == "uring";
+        } else if (option.compare(0, listenOption.size(), listenOption) == 0) {
+            string value = option.substr(listenOption.size());
+            size_t at = value.find('@');
+            ExtraListener extra;
+            if (at == string::npos) {
+                Logger::error("Формат --listen: <протокол>@<порт или unix:путь>");
+                return 1;
+            }
+            extra.protocol = value.substr(0, at);
+            if (!parseAddress(value.substr(at + 1), extra.port, extra.unixPath) ||
+                !checkProtocol(extra.protocol, extra.unixPath)) {
+                return 1;
+            }
+            extraListeners.push_back(extra);
+        } else {
+            Logger::error("Неизвестный параметр: " + option);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Поток сохранения трассы запускается раньше всех остальных потоков
+    // (в том числе потока логгера): они наследуют заблокированный SIGUSR1,
+    // и сигнал получит только он
+    if (traceSample > 0) {
+        Tracer::setSampleRate(static_cast<uint32_t>(traceSample));
+        Tracer::startSignalDumper("trace-" + to_string(getpid()));
+        atexit(Tracer::stopSignalDumper);
+    }
+
+    // Лог сервера пишет фоновый поток: потоки клиентов не ждут консоль.
+    // Остаток очереди выводится при любом завершении (в том числе через exit
+    // из обработчика сигнала)
+    Logger::startAsync();
+    atexit(Logger::stopAsync);
+
     // Создаём сервер
-    Server server(port, protocol);
+    Server server(port, protocols.front());
     globalServer = &server;
+    if (!unixPath.empty()) {
+        server.setUnixPath(unixPath);
+    }
+    for (size_t i = 1; i < protocols.size(); i++) {
+        server.addListener(protocols[i], port, unixPath);
+    }
+    for (const auto& extra : extraListeners) {
+        server.addListener(extra.protocol, extra.port, extra.unixPath);
+    }
+    if (metricsPort > 0) {
+        server.enableMetrics(metricsPort);
+    }
+    server.setLimits(maxConnections, static_cast<size_t>(queueSize), deadlineMs);
+    if (pooledThreads >= 0) {
+        server.setPooledThreads(static_cast<size_t>(pooledThreads));
+    }
+    if (useUring) {
+        server.enableUring();
+    }
     
     // Устанавливаем обработчик сигналов
     // SIGINT - сигнал прерывания (Ctrl+C)
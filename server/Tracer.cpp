@@ -0,0 +1,247 @@
+#include "../server/Tracer.h"
+
+using namespace std;
+
+// Сколько событий хранит кольцевой буфер одного потока
+const size_t TRACE_EVENTS_PER_THREAD = 4096;
+// Сколько буферов завершившихся потоков хранить для следующего сохранения
+const size_t TRACE_RETIRED_BUFFERS = 64;
+
+// Название события всего запроса (от получения до отправки)
+static const char* const REQUEST_EVENT_NAME = "request";
+
+atomic<uint32_t> Tracer::sampleEvery(0);
+thread_local bool Tracer::requestSampled = false;
+thread_local uint64_t Tracer::requestId = 0;
+atomic<uint64_t> Tracer::requestCounter(0);
+thread_local chrono::steady_clock::time_point Tracer::requestBegin;
+
+mutex Tracer::registryMutex;
+vector<shared_ptr<Tracer::ThreadBuffer>> Tracer::buffers;
+atomic<int> Tracer::nextThreadId(1);
+chrono::steady_clock::time_point Tracer::epoch = chrono::steady_clock::now();
+
+thread Tracer::dumperThread;
+atomic<bool> Tracer::dumperRunning(false);
+string Tracer::dumpPath;
+
+// Наносекунды от запуска программы
+static uint64_t sinceEpoch(chrono::steady_clock::time_point epoch,
+                           chrono::steady_clock::time_point moment) {
+    auto elapsed = moment - epoch;
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+}
+
+// Включает выборку
+void Tracer::setSampleRate(uint32_t every) {
+    sampleEvery.store(every, memory_order_relaxed);
+}
+
+// Решает, попадает ли запрос в выборку (выборка включена)
+void Tracer::startSampledRequest(chrono::steady_clock::time_point receivedAt) {
+    requestId = requestCounter.fetch_add(1, memory_order_relaxed) + 1;
+    requestSampled = requestId % sampleEvery.load(memory_order_relaxed) == 0;
+    if (requestSampled) {
+        requestBegin = receivedAt;
+    }
+}
+
+// Записывает событие всего запроса
+void Tracer::finishSampledRequest() {
+    record(REQUEST_EVENT_NAME, requestBegin, chrono::steady_clock::now());
+    requestSampled = false;
+}
+
+// Снимает текущий запрос с потока
+Tracer::Request Tracer::handOffRequest() {
+    Request request;
+    if (requestSampled) {
+        request.sampled = true;
+        request.id = requestId;
+        request.begin = requestBegin;
+        requestSampled = false;
+    }
+    return request;
+}
+
+// Записывает этап текущего запроса
+void Tracer::record(const char* name, chrono::steady_clock::time_point begin,
+                    chrono::steady_clock::time_point end) {
+    record(Request{true, requestId, requestBegin}, name, begin, end);
+}
+
+// Записывает этап запроса (в буфер вызывающего потока)
+void Tracer::record(const Request& request, const char* name, chrono::steady_clock::time_point begin,
+                    chrono::steady_clock::time_point end) {
+    Event event;
+    event.name = name;
+    event.beginNs = sinceEpoch(epoch, begin);
+    event.durationNs = end > begin ? sinceEpoch(begin, end) : 0;
+    event.requestId = request.id;
+    push(local(), event);
+}
+
+// Ответ на переданный запрос отправлен
+void Tracer::endRequest(const Request& request, chrono::steady_clock::time_point end) {
+    if (request.sampled) {
+        record(request, REQUEST_EVENT_NAME, request.begin, end);
+    }
+}
+
+// Новый поток регистрирует свой буфер
+Tracer::BufferHolder::BufferHolder() : buffer(make_shared<ThreadBuffer>()) {
+    buffer->events.resize(TRACE_EVENTS_PER_THREAD);
+    buffer->threadId = nextThreadId++;
+    lock_guard<mutex> lock(registryMutex);
+    buffers.push_back(buffer);
+}
+
+// Поток завершается: его события остаются в трассе, но хранятся
+// только последние TRACE_RETIRED_BUFFERS завершившихся потоков
+// (TCP-сервер создаёт поток на каждого клиента)
+Tracer::BufferHolder::~BufferHolder() {
+    lock_guard<mutex> lock(registryMutex);
+    size_t finished = 0;
+    for (const auto& other : buffers) {
+        if (other.use_count() == 1) {
+            finished++;  // Буфер держит только реестр - поток уже завершился
+        }
+    }
+    // Наш буфер держим мы и реестр; после выхода он тоже станет завершённым
+    finished++;
+    for (size_t i = 0; i < buffers.size() && finished > TRACE_RETIRED_BUFFERS; ) {
+        if (buffers[i].use_count() == 1) {
+            buffers.erase(buffers.begin() + static_cast<ptrdiff_t>(i));  // Самый старый
+            finished--;
+        } else {
+            i++;
+        }
+    }
+}
+
+// Буфер текущего потока (создаётся при первом трассируемом запросе)
+Tracer::ThreadBuffer& Tracer::local() {
+    thread_local BufferHolder holder;
+    return *holder.buffer;
+}
+
+// Добавляет событие в кольцевой буфер
+void Tracer::push(ThreadBuffer& buffer, const Event& event) {
+    // Мьютекс свободен всегда, кроме момента сохранения трассы
+    lock_guard<mutex> lock(buffer.bufferMutex);
+    buffer.events[buffer.next] = event;
+    buffer.next = (buffer.next + 1) % buffer.events.size();
+    if (buffer.size < buffer.events.size()) {
+        buffer.size++;
+    }
+}
+
+// Все события в формате Chrome trace-event JSON
+string Tracer::dumpChromeJson() {
+    vector<shared_ptr<ThreadBuffer>> snapshot;
+    {
+        lock_guard<mutex> lock(registryMutex);
+        snapshot = buffers;
+    }
+
+    int pid = static_cast<int>(getpid());
+    ostringstream out;
+    out.setf(ios::fixed);
+    out.precision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool first = true;
+    for (const auto& buffer : snapshot) {
+        lock_guard<mutex> lock(buffer->bufferMutex);
+        if (buffer->size == 0) {
+            continue;
+        }
+
+        // Имя дорожки
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"tid\":" << buffer->threadId
+            << ",\"args\":{\"name\":\"worker " << buffer->threadId << "\"}}";
+        first = false;
+
+        // События от старых к новым; время в микросекундах (формат trace-event)
+        size_t capacity = buffer->events.size();
+        size_t start = (buffer->next + capacity - buffer->size) % capacity;
+        for (size_t i = 0; i < buffer->size; i++) {
+            const Event& event = buffer->events[(start + i) % capacity];
+            out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":" << pid
+                << ",\"tid\":" << buffer->threadId
+                << ",\"ts\":" << static_cast<double>(event.beginNs) / 1000.0
+                << ",\"dur\":" << static_cast<double>(event.durationNs) / 1000.0
+                << ",\"args\":{\"request\":" << event.requestId << "}}";
+        }
+    }
+
+    out << "\n]}\n";
+    return out.str();
+}
+
+// Сохраняет трассу в файл
+bool Tracer::dumpToFile(const string& path) {
+    ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file << dumpChromeJson();
+    return static_cast<bool>(file);
+}
+
+// Запускает поток сохранения по SIGUSR1
+void Tracer::startSignalDumper(const string& path) {
+    if (dumperRunning) {
+        return;
+    }
+
+    // Блокируем SIGUSR1: его примет только sigwait потока сохранения
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    dumpPath = path;
+    dumperRunning = true;
+    dumperThread = thread(dumperLoop);
+}
+
+// Останавливает поток сохранения
+void Tracer::stopSignalDumper() {
+    if (!dumperRunning.exchange(false)) {
+        return;
+    }
+    // Будим sigwait; поток увидит dumperRunning = false и выйдет
+    pthread_kill(dumperThread.native_handle(), SIGUSR1);
+    if (dumperThread.joinable()) {
+        dumperThread.join();
+    }
+}
+
+// Цикл потока сохранения
+void Tracer::dumperLoop() {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+
+    int dumpNumber = 0;
+    while (true) {
+        int received = 0;
+        if (sigwait(&signals, &received) != 0) {
+            continue;
+        }
+        if (!dumperRunning) {
+            return;
+        }
+
+        // Каждое сохранение - отдельный файл: трассы не затирают друг друга
+        dumpNumber++;
+        string path = dumpPath + "-" + to_string(dumpNumber) + ".json";
+        if (dumpToFile(path)) {
+            LOG_INFO("Трасса запросов сохранена в ", path);
+        } else {
+            LOG_ERROR("Не удалось сохранить трассу запросов в ", path);
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <csignal>
+#include <cstdint>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../utils/Logger.h"
+
+using namespace std;
+
+// Трассировка этапов обработки запросов
+
+// Каждый N-й запрос сервера (выборка 1/N) записывает моменты начала и конца
+// этапов: разбор, построение графа, поиск, сериализация, отправка -
+// и весь запрос от получения данных до завершения отправки.
+// События хранятся в кольцевом буфере потока (старые затираются новыми).
+
+// По сигналу SIGUSR1 буферы всех потоков сохраняются в файл в формате
+// Chrome trace-event JSON: его открывают chrome://tracing или ui.perfetto.dev,
+// где каждый поток - отдельная дорожка с отрезками этапов.
+
+// Если выборка выключена (N = 0), трассировка стоит одного чтения
+// атомарной переменной на запрос и проверки флага потока на этап.
+// Запрос вне выборки добавляет к этому одно атомарное увеличение счётчика.
+
+// Сигнал обрабатывает отдельный поток через sigwait: в обработчике сигнала
+// нельзя выделять память и писать файлы, а в обычном потоке можно.
+
+class Tracer {
+public:
+    // Включает выборку: трассируется каждый every-й запрос (0 - выключено)
+    static void setSampleRate(uint32_t every);
+
+    // Запускает поток, который по SIGUSR1 сохраняет трассу в path
+    // Вызывать до создания остальных потоков: SIGUSR1 блокируется
+    // в вызывающем потоке, и новые потоки наследуют эту маску
+    static void startSignalDumper(const string& path);
+
+    // Останавливает поток сохранения
+    static void stopSignalDumper();
+
+    // Запрос, который дальше ведёт другой поток (io_uring: ответ
+    // отправляет поток кольца, а не обработчик)
+    struct Request {
+        bool sampled = false;
+        uint64_t id = 0;
+        chrono::steady_clock::time_point begin;
+    };
+
+    // Обработчик взял запрос: решаем, попадает ли запрос в выборку
+    // receivedAt Когда данные запроса были получены (до ожидания в очереди)
+    static void beginRequest(chrono::steady_clock::time_point receivedAt) {
+        if (sampleEvery.load(memory_order_relaxed) == 0) {
+            requestSampled = false;
+            return;
+        }
+        startSampledRequest(receivedAt);
+    }
+
+    // Ответ отправлен: записываем событие всего запроса
+    static void endRequest() {
+        if (requestSampled) {
+            finishSampledRequest();
+        }
+    }
+
+    // Трассируется ли текущий запрос этого потока
+    static bool sampled() {
+        return requestSampled;
+    }
+
+    // Снимает текущий запрос с потока: его этапы и конец запишет
+    // тот поток, который получит Request
+    static Request handOffRequest();
+
+    // Записывает этап запроса, переданного из другого потока
+    static void record(const Request& request, const char* name, chrono::steady_clock::time_point begin,
+                       chrono::steady_clock::time_point end);
+
+    // Ответ на переданный запрос отправлен: записываем событие всего запроса
+    static void endRequest(const Request& request, chrono::steady_clock::time_point end);
+
+    // Записывает этап текущего запроса (только если sampled())
+    // name Название этапа (строка должна жить всё время работы программы)
+    static void record(const char* name, chrono::steady_clock::time_point begin,
+                       chrono::steady_clock::time_point end);
+
+    // Все события в формате Chrome trace-event JSON
+    static string dumpChromeJson();
+
+    // Сохраняет трассу в файл; false, если файл не удалось записать
+    static bool dumpToFile(const string& path);
+
+private:
+    // Одно событие: отрезок времени на дорожке потока
+    struct Event {
+        const char* name;
+        uint64_t beginNs;    // От запуска программы
+        uint64_t durationNs;
+        uint64_t requestId;  // Номер запроса (связывает этапы одного запроса)
+    };
+
+    // Кольцевой буфер событий одного потока
+    struct ThreadBuffer {
+        mutex bufferMutex;       // Берётся только трассируемыми запросами и при сохранении
+        vector<Event> events;
+        size_t next = 0;         // Куда писать следующее событие
+        size_t size = 0;         // Сколько событий в буфере
+        int threadId = 0;        // Номер дорожки в трассе
+    };
+
+    // Удерживает буфер потока, пока поток жив
+    struct BufferHolder {
+        shared_ptr<ThreadBuffer> buffer;
+        BufferHolder();
+        ~BufferHolder();
+    };
+
+    static atomic<uint32_t> sampleEvery;
+    static thread_local bool requestSampled;
+    static thread_local uint64_t requestId;
+    // Общий счётчик: у TCP-сервера поток на каждого клиента, и счётчик
+    // потока редко дошёл бы до N (увеличивается только при включённой выборке)
+    static atomic<uint64_t> requestCounter;
+    static thread_local chrono::steady_clock::time_point requestBegin;
+
+    static mutex registryMutex;
+    static vector<shared_ptr<ThreadBuffer>> buffers;
+    static atomic<int> nextThreadId;
+    static chrono::steady_clock::time_point epoch;
+
+    static thread dumperThread;
+    static atomic<bool> dumperRunning;
+    static string dumpPath;
+
+    // Медленные части beginRequest/endRequest (вызываются редко)
+    static void startSampledRequest(chrono::steady_clock::time_point receivedAt);
+    static void finishSampledRequest();
+
+    // Буфер текущего потока
+    static ThreadBuffer& local();
+
+    // Добавляет событие в кольцевой буфер
+    static void push(ThreadBuffer& buffer, const Event& event);
+
+    // Цикл потока сохранения: ждёт SIGUSR1
+    static void dumperLoop();
+};
+
+#endif
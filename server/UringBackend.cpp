@@ -0,0 +1,862 @@
+#include "../server/UringBackend.h"
+
+using namespace std;
+
+// Заявок в кольце и событий в очереди завершений (multishot даёт
+// много событий на одну заявку - очередь завершений больше)
+const unsigned RING_ENTRIES = 256;
+const unsigned COMPLETION_ENTRIES = 4096;
+// Предоставленные буферы: количество (степень двойки) и размер.
+// Размер с запасом под заголовок recvmsg и адрес UDP-клиента
+const unsigned PROVIDED_BUFFERS = 256;
+const size_t PROVIDED_BUFFER_SIZE = 8192;
+const unsigned short BUFFER_GROUP = 0;
+// Наибольший кадр TCP (как у Server::receiveTCP)
+const uint32_t MAX_FRAME_SIZE = 4096;
+// Сколько байт подключение может накопить, пока его запрос у обработчиков.
+// У потоков подключений лишнее ждёт в сокете (окно TCP), а multishot recv
+// забирает всё - клиент, шлющий запросы без ожидания ответов, отключается
+const size_t MAX_BUFFERED_INPUT = 16 * 2 * (sizeof(uint32_t) + MAX_FRAME_SIZE);
+// Наименьшая версия ядра: multishot recv появился в 6.0
+const int MIN_KERNEL_MAJOR = 6;
+
+// Системные вызовы io_uring (liburing не используется)
+static int ringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(SYS_io_uring_setup, entries, params));
+}
+
+static int ringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(SYS_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+static int ringRegister(int fd, unsigned opcode, void* arg, unsigned count) {
+    return static_cast<int>(syscall(SYS_io_uring_register, fd, opcode, arg, count));
+}
+
+// Кольца общие с ядром: голова и хвост читаются и пишутся с барьерами
+static unsigned loadAcquire(const unsigned* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void storeRelease(unsigned* p, unsigned value) {
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+// Конструктор (кольцо создаётся в runTCP/runUDP). eventfd пробуждения
+// создаётся здесь и живёт до деструктора: stop() и wake() вызываются из
+// других потоков и не должны застать его открытие или закрытие
+UringBackend::UringBackend()
+    : ringFd(-1), sqRing(nullptr), sqRingSize(0), cqRing(nullptr), cqRingSize(0),
+      sqes(nullptr), sqesSize(0), sqHead(nullptr), sqTail(nullptr), sqArray(nullptr),
+      sqMask(0), sqEntries(0), sqLocalTail(0), toSubmit(0), cqHead(nullptr), cqTail(nullptr),
+      cqMask(0), cqes(nullptr), bufferRing(nullptr), bufferRingSize(0), bufferTail(0),
+      wakeFd(-1), wakeValue(0), stopRequested(false), rearmAccept(false),
+      rearmWake(false), rearmUdpRecv(false), listenFd(-1), liveConnections(0),
+      maxConnections(SIZE_MAX), udpFd(-1) {
+    memset(&udpRecvHeader, 0, sizeof(udpRecvHeader));
+    wakeFd = eventfd(0, EFD_CLOEXEC);
+}
+
+// Деструктор
+UringBackend::~UringBackend() {
+    for (Connection& connection : connections) {
+        if (connection.fd >= 0) {
+            close(connection.fd);
+        }
+    }
+    teardownRing();
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+}
+
+// Проверяет поддержку ядром
+bool UringBackend::supported(string& reason) {
+    utsname name;
+    int major = 0;
+    if (uname(&name) == 0) {
+        major = atoi(name.release);
+    }
+    if (major < MIN_KERNEL_MAJOR) {
+        reason = "ядро старше 6.0 (нет multishot recv)";
+        return false;
+    }
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = ringSetup(4, &params);
+    if (fd < 0) {
+        reason = string("io_uring_setup: ") + strerror(errno);
+        return false;
+    }
+
+    // Нужные операции
+    size_t probeSize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+    vector<char> probeMemory(probeSize, 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeMemory.data());
+    bool ok = ringRegister(fd, IORING_REGISTER_PROBE, probe, 256) == 0;
+    const int required[] = {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND,
+                            IORING_OP_RECVMSG, IORING_OP_SENDMSG, IORING_OP_READ};
+    for (int op : required) {
+        if (!ok || op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            ok = false;
+            reason = "ядро не поддерживает операцию io_uring " + to_string(op);
+            break;
+        }
+    }
+
+    // Кольцо предоставленных буферов (5.19+)
+    if (ok) {
+        long page = sysconf(_SC_PAGESIZE);
+        void* memory = mmap(nullptr, static_cast<size_t>(page), PROT_READ | PROT_WRITE,
+                            MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+        io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = reinterpret_cast<uint64_t>(memory);
+        reg.ring_entries = 1;
+        reg.bgid = BUFFER_GROUP;
+        if (memory == MAP_FAILED || ringRegister(fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+            ok = false;
+            reason = "нет колец предоставленных буферов";
+        }
+        if (memory != MAP_FAILED) {
+            munmap(memory, static_cast<size_t>(page));
+        }
+    }
+    close(fd);
+    return ok;
+}
+
+// Ограничение числа подключений
+void UringBackend::setConnectionLimit(size_t maxConnections, vector<char> rejectResponse,
+                                      function<void()> onReject) {
+    this->maxConnections = maxConnections;
+    this->rejectResponse = move(rejectResponse);
+    this->onReject = move(onReject);
+}
+
+// Создаёт кольцо
+bool UringBackend::setupRing() {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    // Кольцо ведёт один поток: ядро может не синхронизировать отправку
+    // заявок и выполнять завершения только при ожидании событий
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL |
+                   IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    params.cq_entries = COMPLETION_ENTRIES;
+    ringFd = ringSetup(RING_ENTRIES, &params);
+    if (ringFd < 0) {
+        // Старое ядро без этих флагов - обычное кольцо
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = COMPLETION_ENTRIES;
+        ringFd = ringSetup(RING_ENTRIES, &params);
+    }
+    if (ringFd < 0) {
+        Logger::error(string("io_uring_setup: ") + strerror(errno));
+        return false;
+    }
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        sqRingSize = cqRingSize = max(sqRingSize, cqRingSize);
+    }
+    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        sqRing = nullptr;
+        return false;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        cqRing = sqRing;
+    } else {
+        cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            cqRing = nullptr;
+            return false;
+        }
+    }
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqesMemory = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ringFd, IORING_OFF_SQES);
+    if (sqesMemory == MAP_FAILED) {
+        return false;
+    }
+    sqes = static_cast<io_uring_sqe*>(sqesMemory);
+
+    char* sq = static_cast<char*>(sqRing);
+    char* cq = static_cast<char*>(cqRing);
+    sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqEntries = params.sq_entries;
+    sqLocalTail = *sqTail;
+    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Кольцо предоставленных буферов: описания буферов - в общей с ядром
+    // памяти, сами буферы - один большой блок
+    bufferRingSize = PROVIDED_BUFFERS * sizeof(io_uring_buf);
+    void* ringMemory = mmap(nullptr, bufferRingSize, PROT_READ | PROT_WRITE,
+                            MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ringMemory == MAP_FAILED) {
+        return false;
+    }
+    bufferRing = static_cast<io_uring_buf_ring*>(ringMemory);
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(bufferRing);
+    reg.ring_entries = PROVIDED_BUFFERS;
+    reg.bgid = BUFFER_GROUP;
+    if (ringRegister(ringFd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+        Logger::error(string("Регистрация буферов io_uring: ") + strerror(errno));
+        return false;
+    }
+    bufferMemory.assign(PROVIDED_BUFFERS * PROVIDED_BUFFER_SIZE, 0);
+    bufferTail = 0;
+    for (unsigned bid = 0; bid < PROVIDED_BUFFERS; bid++) {
+        recycleBuffer(bid);
+    }
+
+    return wakeFd >= 0;
+}
+
+// Освобождает кольцо
+void UringBackend::teardownRing() {
+    if (sqes != nullptr) {
+        munmap(sqes, sqesSize);
+        sqes = nullptr;
+    }
+    if (cqRing != nullptr && cqRing != sqRing) {
+        munmap(cqRing, cqRingSize);
+    }
+    cqRing = nullptr;
+    if (sqRing != nullptr) {
+        munmap(sqRing, sqRingSize);
+        sqRing = nullptr;
+    }
+    if (ringFd >= 0) {
+        close(ringFd);
+        ringFd = -1;
+    }
+    // Кольцо буферов снимается с регистрации вместе с io_uring
+    if (bufferRing != nullptr) {
+        munmap(bufferRing, bufferRingSize);
+        bufferRing = nullptr;
+    }
+}
+
+// Свободная заявка
+io_uring_sqe* UringBackend::getSqe() {
+    if (sqLocalTail - loadAcquire(sqHead) >= sqEntries) {
+        // Очередь заявок заполнена - отдаём накопленное ядру
+        submit(0);
+        if (sqLocalTail - loadAcquire(sqHead) >= sqEntries) {
+            return nullptr;
+        }
+    }
+    unsigned index = sqLocalTail & sqMask;
+    io_uring_sqe* sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqArray[index] = index;
+    sqLocalTail++;
+    toSubmit++;
+    return sqe;
+}
+
+// Гарантирует count свободных заявок подряд
+void UringBackend::reserveSqes(unsigned count) {
+    if (sqLocalTail - loadAcquire(sqHead) + count > sqEntries) {
+        submit(0);
+    }
+}
+
+// Отправляет заявки и ждёт событий
+void UringBackend::submit(unsigned minComplete) {
+    storeRelease(sqTail, sqLocalTail);
+    unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int result = ringEnter(ringFd, toSubmit, minComplete, flags);
+    if (result >= 0) {
+        toSubmit -= static_cast<unsigned>(result) < toSubmit ? static_cast<unsigned>(result) : toSubmit;
+    } else if (errno != EINTR && errno != EBUSY && errno != EAGAIN) {
+        Logger::error(string("io_uring_enter: ") + strerror(errno));
+    }
+}
+
+// user_data заявки: операция, поколение подключения (24 бита) и номер
+uint64_t UringBackend::makeUserData(Operation op, uint32_t generation, uint32_t index) {
+    return (static_cast<uint64_t>(op) << 56) |
+           (static_cast<uint64_t>(generation & 0xFFFFFF) << 32) | index;
+}
+
+// Возвращает буфер в кольцо
+void UringBackend::recycleBuffer(unsigned bid) {
+    // Описания буферов начинаются с начала кольца (хвост кольца лежит в поле
+    // resv первого описания). bufferRing->bufs не используется: в C++ пустая
+    // структура из __DECLARE_FLEX_ARRAY имеет размер 1 и сдвигает массив на 8 байт
+    io_uring_buf* buffers = reinterpret_cast<io_uring_buf*>(bufferRing);
+    io_uring_buf* buffer = &buffers[bufferTail & (PROVIDED_BUFFERS - 1)];
+    buffer->addr = reinterpret_cast<uint64_t>(bufferMemory.data() + bid * PROVIDED_BUFFER_SIZE);
+    buffer->len = static_cast<uint32_t>(PROVIDED_BUFFER_SIZE);
+    buffer->bid = static_cast<uint16_t>(bid);
+    bufferTail++;
+    __atomic_store_n(&bufferRing->tail, bufferTail, __ATOMIC_RELEASE);
+}
+
+// Пробуждает поток кольца
+void UringBackend::wake() {
+    if (this_thread::get_id() == loopThread) {
+        return;  // Поток кольца сам разберёт список в конце итерации
+    }
+    int fd = wakeFd;
+    if (fd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(fd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+// Останавливает цикл
+void UringBackend::stop() {
+    stopRequested = true;
+    int fd = wakeFd;
+    if (fd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(fd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+// Открытых подключений
+size_t UringBackend::activeConnections() const {
+    return liveConnections.load();
+}
+
+// Заявка multishot accept
+void UringBackend::armAccept() {
+    io_uring_sqe* sqe = getSqe();
+    rearmAccept = sqe == nullptr;
+    if (sqe == nullptr) {
+        return;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listenFd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = makeUserData(OP_ACCEPT, 0, 0);
+}
+
+// Заявка multishot recv подключения
+void UringBackend::armRecv(uint32_t index) {
+    Connection& connection = connections[index];
+    io_uring_sqe* sqe = getSqe();
+    if (sqe == nullptr) {
+        startClose(index);
+        return;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = connection.fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = makeUserData(OP_RECV, connection.generation, index);
+    connection.recvActive = true;
+}
+
+// Чтение eventfd: события от потоков-обработчиков
+void UringBackend::armWake() {
+    io_uring_sqe* sqe = getSqe();
+    rearmWake = sqe == nullptr;
+    if (sqe == nullptr) {
+        return;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wakeFd;
+    sqe->addr = reinterpret_cast<uint64_t>(&wakeValue);
+    sqe->len = sizeof(wakeValue);
+    sqe->user_data = makeUserData(OP_WAKE, 0, 0);
+}
+
+// Заявка multishot recvmsg для UDP
+void UringBackend::armUdpRecv() {
+    io_uring_sqe* sqe = getSqe();
+    rearmUdpRecv = sqe == nullptr;
+    if (sqe == nullptr) {
+        return;
+    }
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = udpFd;
+    sqe->addr = reinterpret_cast<uint64_t>(&udpRecvHeader);
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = makeUserData(OP_UDP_RECV, 0, 0);
+}
+
+// Повторяет заявки, которые не удалось поставить. Без этого multishot
+// accept или recvmsg, не поставленный при переполнении очереди событий
+// (io_uring_enter вернул EBUSY), больше не появился бы и сервер перестал бы
+// принимать подключения или датаграммы
+void UringBackend::rearmPending() {
+    if (rearmWake) {
+        armWake();
+    }
+    if (rearmAccept) {
+        armAccept();
+    }
+    if (rearmUdpRecv) {
+        armUdpRecv();
+    }
+}
+
+// Обслуживает TCP
+bool UringBackend::runTCP(int listenSocket, RequestHandler handler) {
+    if (!setupRing()) {
+        return false;
+    }
+    listenFd = listenSocket;
+    requestHandler = move(handler);
+    loopThread = this_thread::get_id();
+    armWake();
+    armAccept();
+    loop();
+    return true;
+}
+
+// Обслуживает UDP
+bool UringBackend::runUDP(int udpSocket, DatagramHandler handler) {
+    if (!setupRing()) {
+        return false;
+    }
+    udpFd = udpSocket;
+    datagramHandler = move(handler);
+    loopThread = this_thread::get_id();
+    // recvmsg в режиме multishot берёт из msghdr только размеры адреса и
+    // управляющих данных: в буфер ядро кладёт io_uring_recvmsg_out, адрес и данные
+    // (места под адрес - на любое семейство: сокет может быть и Unix-сокетом)
+    udpRecvHeader.msg_namelen = sizeof(sockaddr_storage);
+    udpRecvHeader.msg_controllen = 0;
+    armWake();
+    armUdpRecv();
+    loop();
+    return true;
+}
+
+// Главный цикл
+void UringBackend::loop() {
+    while (!stopRequested) {
+        rearmPending();
+        drainPending();
+        submit(1);
+        processCompletions();
+    }
+}
+
+// Разбирает все готовые события
+void UringBackend::processCompletions() {
+    unsigned head = *cqHead;
+    while (head != loadAcquire(cqTail)) {
+        io_uring_cqe cqe = cqes[head & cqMask];
+        head++;
+        // Место в очереди освобождается сразу: обработка может добавить заявки
+        storeRelease(cqHead, head);
+        handleCompletion(cqe);
+    }
+}
+
+// Обрабатывает одно событие
+void UringBackend::handleCompletion(const io_uring_cqe& cqe) {
+    Operation op = static_cast<Operation>(cqe.user_data >> 56);
+    uint32_t generation = static_cast<uint32_t>(cqe.user_data >> 32) & 0xFFFFFF;
+    uint32_t index = static_cast<uint32_t>(cqe.user_data);
+
+    switch (op) {
+        case OP_ACCEPT:
+            onAccept(cqe.res, cqe.flags);
+            break;
+        case OP_RECV:
+        case OP_SEND_HEADER:
+        case OP_SEND_BODY:
+            // Событие старого подключения, слот которого уже занят другим
+            if (index >= connections.size() ||
+                (connections[index].generation & 0xFFFFFF) != generation) {
+                if (cqe.flags & IORING_CQE_F_BUFFER) {
+                    recycleBuffer(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                }
+                break;
+            }
+            if (op == OP_RECV) {
+                onRecv(index, cqe.res, cqe.flags);
+            } else {
+                onSend(index, op, cqe.res);
+            }
+            break;
+        case OP_WAKE:
+            if (!stopRequested) {
+                armWake();
+            }
+            break;
+        case OP_UDP_RECV:
+            onUdpRecv(cqe.res, cqe.flags);
+            break;
+        case OP_UDP_SEND:
+            if (cqe.res > 0) {
+                Metrics::add(Metrics::BYTES_SENT, static_cast<uint64_t>(cqe.res));
+            }
+            datagramSlots[index].reset();
+            freeDatagramSlots.push_back(index);
+            break;
+        case OP_NOP:
+            break;
+    }
+}
+
+// Новое подключение
+void UringBackend::onAccept(int result, uint32_t flags) {
+    if (!(flags & IORING_CQE_F_MORE) && !stopRequested) {
+        armAccept();  // multishot accept завершился (ошибка или нехватка ресурсов)
+    }
+    if (result < 0) {
+        if (!stopRequested) {
+            Logger::error(string("Ошибка при принятии подключения: ") + strerror(-result));
+        }
+        return;
+    }
+    int fd = result;
+
+    // Подключений уже слишком много: ответ OVERLOADED и закрытие
+    // (ответ маленький и без ожидания помещается в буфер сокета)
+    if (liveConnections >= maxConnections) {
+        uint32_t size = htonl(static_cast<uint32_t>(rejectResponse.size()));
+        send(fd, &size, sizeof(size), MSG_NOSIGNAL | MSG_DONTWAIT);
+        send(fd, rejectResponse.data(), rejectResponse.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        close(fd);
+        if (onReject) {
+            onReject();
+        }
+        return;
+    }
+
+    // Для Unix-сокета TCP_NODELAY не нужен (вызов просто вернёт ошибку)
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    uint32_t index;
+    if (!freeConnections.empty()) {
+        index = freeConnections.back();
+        freeConnections.pop_back();
+    } else {
+        index = static_cast<uint32_t>(connections.size());
+        connections.emplace_back();
+    }
+    Connection& connection = connections[index];
+    connection.fd = fd;
+    connection.input.clear();
+    connection.output.clear();
+    connection.inFlight = false;
+    connection.sendsPending = 0;
+    connection.sendFailed = false;
+    connection.closing = false;
+    liveConnections++;
+    LOG_INFO("Подключён TCP-клиент (io_uring), подключений: ", liveConnections.load());
+    armRecv(index);
+}
+
+// Данные от клиента
+void UringBackend::onRecv(uint32_t index, int result, uint32_t flags) {
+    Connection& connection = connections[index];
+    bool more = (flags & IORING_CQE_F_MORE) != 0;
+    if (!more) {
+        connection.recvActive = false;
+    }
+
+    if (result > 0 && (flags & IORING_CQE_F_BUFFER)) {
+        unsigned bid = flags >> IORING_CQE_BUFFER_SHIFT;
+        const char* data = bufferMemory.data() + bid * PROVIDED_BUFFER_SIZE;
+        connection.input.insert(connection.input.end(), data, data + result);
+        recycleBuffer(bid);
+        Metrics::add(Metrics::BYTES_RECEIVED, static_cast<uint64_t>(result));
+    }
+
+    if (result == 0 || (result < 0 && result != -ENOBUFS)) {
+        // Клиент закрыл соединение или ошибка
+        startClose(index);
+    } else if (!connection.closing && connection.input.size() > MAX_BUFFERED_INPUT) {
+        Logger::warning("Клиент прислал слишком много данных, не дожидаясь ответов (io_uring)");
+        startClose(index);
+    } else if (!more && !connection.closing) {
+        // Кончились буферы или ядро завершило multishot - заявка заново
+        armRecv(index);
+    }
+
+    if (connection.closing) {
+        finishClose(index);
+    } else {
+        dispatch(index);
+    }
+}
+
+// Отправлена часть ответа
+void UringBackend::onSend(uint32_t index, Operation op, int result) {
+    Connection& connection = connections[index];
+    connection.sendsPending--;
+    size_t expected = op == OP_SEND_HEADER ? sizeof(connection.outputHeader) : connection.output.size();
+    if (result < 0 || static_cast<size_t>(result) != expected) {
+        connection.sendFailed = true;
+    }
+    if (connection.sendsPending > 0) {
+        return;
+    }
+
+    if (connection.sendFailed) {
+        startClose(index);
+        finishClose(index);
+        return;
+    }
+    Metrics::add(Metrics::BYTES_SENT, sizeof(connection.outputHeader) + connection.output.size());
+    // Этап отправки - от подачи заявок до завершения обеих (как StageTimer
+    // вокруг sendTCP у потоков подключений)
+    auto sentAt = chrono::steady_clock::now();
+    Metrics::observe(Metrics::STAGE_SEND, static_cast<uint64_t>(
+        chrono::duration_cast<chrono::microseconds>(sentAt - connection.sendStartedAt).count()));
+    if (connection.trace.sampled) {
+        Tracer::record(connection.trace, Metrics::stageName(Metrics::STAGE_SEND), connection.sendStartedAt, sentAt);
+        Tracer::endRequest(connection.trace, sentAt);
+        connection.trace = Tracer::Request();
+    }
+    connection.output.clear();
+    if (connection.closing) {
+        finishClose(index);
+    } else {
+        dispatch(index);
+    }
+}
+
+// Отдаёт обработчику следующий полный запрос (два кадра)
+void UringBackend::dispatch(uint32_t index) {
+    Connection& connection = connections[index];
+    if (connection.inFlight || connection.sendsPending > 0 || connection.closing) {
+        return;  // Ответы уходят по порядку: следующий запрос - после отправки ответа
+    }
+
+    // Разбираем кадры: [длина][запрос][длина][рёбра]
+    const vector<char>& input = connection.input;
+    size_t offset = 0;
+    size_t frames[2][2];
+    for (int i = 0; i < 2; i++) {
+        if (input.size() < offset + sizeof(uint32_t)) {
+            return;
+        }
+        uint32_t size;
+        memcpy(&size, input.data() + offset, sizeof(size));
+        size = ntohl(size);
+        if (size > MAX_FRAME_SIZE) {
+            Logger::error("Слишком большой размер данных");
+            startClose(index);
+            finishClose(index);
+            return;
+        }
+        offset += sizeof(uint32_t);
+        if (input.size() < offset + size) {
+            return;
+        }
+        frames[i][0] = offset;
+        frames[i][1] = size;
+        offset += size;
+    }
+
+    vector<char> requestData(input.begin() + frames[0][0], input.begin() + frames[0][0] + frames[0][1]);
+    vector<char> edgesData(input.begin() + frames[1][0], input.begin() + frames[1][0] + frames[1][1]);
+    connection.input.erase(connection.input.begin(), connection.input.begin() + offset);
+    connection.inFlight = true;
+
+    uint32_t generation = connection.generation;
+    requestHandler(move(requestData), move(edgesData), [this, index, generation](vector<char> response,
+                                                                                 Tracer::Request trace) {
+        {
+            lock_guard<mutex> lock(pendingMutex);
+            pendingReplies.push_back({index, generation, move(response), trace});
+        }
+        wake();
+    });
+}
+
+// Начинает отправку ответа: длина и данные - две связанные заявки send
+void UringBackend::startSend(uint32_t index, vector<char> response, const Tracer::Request& trace) {
+    Connection& connection = connections[index];
+    connection.output = move(response);
+    connection.outputHeader = htonl(static_cast<uint32_t>(connection.output.size()));
+    connection.sendFailed = false;
+    connection.sendStartedAt = chrono::steady_clock::now();
+    connection.trace = trace;
+
+    reserveSqes(2);
+    io_uring_sqe* header = getSqe();
+    io_uring_sqe* body = header != nullptr ? getSqe() : nullptr;
+    if (body == nullptr) {
+        if (header != nullptr) {
+            // Одна заявка уже занята - превращаем её в пустую операцию
+            header->opcode = IORING_OP_NOP;
+            header->user_data = makeUserData(OP_NOP, 0, 0);
+        }
+        startClose(index);
+        finishClose(index);
+        return;
+    }
+    header->opcode = IORING_OP_SEND;
+    header->fd = connection.fd;
+    header->addr = reinterpret_cast<uint64_t>(&connection.outputHeader);
+    header->len = sizeof(connection.outputHeader);
+    header->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+    header->flags = IOSQE_IO_LINK;
+    header->user_data = makeUserData(OP_SEND_HEADER, connection.generation, index);
+
+    body->opcode = IORING_OP_SEND;
+    body->fd = connection.fd;
+    body->addr = reinterpret_cast<uint64_t>(connection.output.data());
+    body->len = static_cast<uint32_t>(connection.output.size());
+    body->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+    body->user_data = makeUserData(OP_SEND_BODY, connection.generation, index);
+    connection.sendsPending = 2;
+}
+
+// Начинает закрытие: shutdown завершает multishot recv
+void UringBackend::startClose(uint32_t index) {
+    Connection& connection = connections[index];
+    if (connection.closing) {
+        return;
+    }
+    connection.closing = true;
+    shutdown(connection.fd, SHUT_RDWR);
+}
+
+// Закрывает подключение, если у него не осталось заявок и запроса у обработчиков
+void UringBackend::finishClose(uint32_t index) {
+    Connection& connection = connections[index];
+    if (!connection.closing || connection.fd < 0 || connection.recvActive ||
+        connection.inFlight || connection.sendsPending > 0) {
+        return;
+    }
+    close(connection.fd);
+    connection.fd = -1;
+    connection.generation++;
+    connection.input.clear();
+    connection.input.shrink_to_fit();
+    connection.output.clear();
+    freeConnections.push_back(index);
+    liveConnections--;
+    LOG_INFO("TCP-клиент отключён (io_uring)");
+}
+
+// UDP-пакет
+void UringBackend::onUdpRecv(int result, uint32_t flags) {
+    if (!(flags & IORING_CQE_F_MORE) && !stopRequested) {
+        armUdpRecv();
+    }
+    if (result <= 0 || !(flags & IORING_CQE_F_BUFFER)) {
+        return;
+    }
+    unsigned bid = flags >> IORING_CQE_BUFFER_SHIFT;
+    const char* buffer = bufferMemory.data() + bid * PROVIDED_BUFFER_SIZE;
+
+    // Буфер: io_uring_recvmsg_out, адрес (msg_namelen байт), данные
+    io_uring_recvmsg_out out;
+    memcpy(&out, buffer, sizeof(out));
+    const char* name = buffer + sizeof(out);
+    const char* payload = name + udpRecvHeader.msg_namelen + udpRecvHeader.msg_controllen;
+    bool valid = !(out.flags & MSG_TRUNC) && out.namelen <= udpRecvHeader.msg_namelen &&
+                 sizeof(out) + udpRecvHeader.msg_namelen + out.payloadlen <= PROVIDED_BUFFER_SIZE;
+    SocketAddress from;
+    vector<char> datagram;
+    if (valid) {
+        memcpy(&from.storage, name, out.namelen);
+        from.length = out.namelen;
+        datagram.assign(payload, payload + out.payloadlen);
+    }
+    recycleBuffer(bid);
+    if (!valid) {
+        return;
+    }
+    Metrics::add(Metrics::BYTES_RECEIVED, out.payloadlen);
+
+    DatagramSender send = [this, from](const vector<char>& packet) {
+        auto datagramSend = make_unique<DatagramSend>();
+        datagramSend->to = from;
+        datagramSend->data = packet;
+        {
+            lock_guard<mutex> lock(pendingMutex);
+            pendingDatagrams.push_back(move(datagramSend));
+        }
+        wake();
+        return true;
+    };
+    datagramHandler(datagram, from, send);
+}
+
+// Отправка UDP-пакета
+void UringBackend::startDatagramSend(unique_ptr<DatagramSend> datagramSend) {
+    io_uring_sqe* sqe = getSqe();
+    if (sqe == nullptr) {
+        return;  // Пакет теряется, как при переполнении буфера сокета
+    }
+    uint32_t index;
+    if (!freeDatagramSlots.empty()) {
+        index = freeDatagramSlots.back();
+        freeDatagramSlots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(datagramSlots.size());
+        datagramSlots.emplace_back();
+    }
+    DatagramSend& slot = *datagramSend;
+    slot.iov.iov_base = slot.data.data();
+    slot.iov.iov_len = slot.data.size();
+    memset(&slot.header, 0, sizeof(slot.header));
+    slot.header.msg_name = &slot.to.storage;
+    slot.header.msg_namelen = slot.to.length;
+    slot.header.msg_iov = &slot.iov;
+    slot.header.msg_iovlen = 1;
+    datagramSlots[index] = move(datagramSend);
+
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = udpFd;
+    sqe->addr = reinterpret_cast<uint64_t>(&slot.header);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = makeUserData(OP_UDP_SEND, 0, index);
+}
+
+// Отправляет ответы и пакеты из других потоков
+void UringBackend::drainPending() {
+    vector<Completion> replies;
+    vector<unique_ptr<DatagramSend>> datagrams;
+    {
+        lock_guard<mutex> lock(pendingMutex);
+        replies.swap(pendingReplies);
+        datagrams.swap(pendingDatagrams);
+    }
+
+    for (Completion& completion : replies) {
+        Connection& connection = connections[completion.index];
+        if (connection.generation != completion.generation || connection.fd < 0) {
+            continue;
+        }
+        connection.inFlight = false;
+        if (connection.closing) {
+            finishClose(completion.index);
+        } else if (completion.response.empty()) {
+            // Некорректный запрос - отвечать нечего, соединение закрывается
+            startClose(completion.index);
+            finishClose(completion.index);
+        } else {
+            startSend(completion.index, move(completion.response), completion.trace);
+        }
+    }
+    for (auto& datagram : datagrams) {
+        startDatagramSend(move(datagram));
+    }
+}
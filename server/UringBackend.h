@@ -0,0 +1,260 @@
+#ifndef URING_BACKEND_H
+#define URING_BACKEND_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/utsname.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <linux/io_uring.h>
+
+#include "../common/SocketAddress.h"
+#include "../utils/Logger.h"
+#include "../server/Metrics.h"
+#include "../server/Tracer.h"
+
+using namespace std;
+
+// Ввод-вывод сервера через io_uring (вместо потока на подключение)
+
+// Один поток (тот, что вызвал runTCP/runUDP) ведёт кольцо io_uring:
+//   - accept в режиме multishot: одна заявка принимает все подключения;
+//   - recv (TCP) и recvmsg (UDP) в режиме multishot с буферами из кольца
+//     предоставленных буферов (provided buffer ring): буферы один раз
+//     регистрируются в ядре, ядро само выбирает свободный, а после
+//     разбора данные копируются и буфер сразу возвращается в кольцо;
+//   - ответ TCP - две связанные заявки send (длина кадра и данные,
+//     IOSQE_IO_LINK): порядок гарантирован, а ошибка первой отменяет вторую;
+//   - ответы UDP - sendmsg.
+// Сам запрос обрабатывается вне этого потока (очередь запросов сервера):
+// обработчик вызывает reply из любого потока, ответ попадает в общий
+// список, а поток кольца будит eventfd, чтение которого всегда ждёт в кольце.
+
+// Системных вызовов на запрос - один io_uring_enter на пачку событий
+// всех подключений вместо recv/send каждого потока, и нет переключений
+// между потоками подключений.
+
+// Кадры TCP - те же, что у Server::receiveTCP/sendTCP (длина uint32 в
+// сетевом порядке + данные), запрос - два кадра: ClientRequest и рёбра.
+
+class UringBackend {
+public:
+    // Ответ на запрос TCP (можно вызывать из любого потока, один раз);
+    // пустой ответ - закрыть подключение (некорректный запрос).
+    // trace - запрос в трассе (Tracer::handOffRequest): поток кольца запишет
+    // этап отправки и конец запроса, когда ответ уйдёт
+    using Reply = function<void(vector<char> response, Tracer::Request trace)>;
+
+    // Отправка UDP-пакета клиенту (из любого потока)
+    using DatagramSender = function<bool(const vector<char>& packet)>;
+
+    // Получен запрос TCP целиком (оба кадра)
+    using RequestHandler = function<void(vector<char> requestData, vector<char> edgesData, Reply reply)>;
+
+    // Получен UDP-пакет (вызывается в потоке кольца)
+    using DatagramHandler = function<void(const vector<char>& datagram, const SocketAddress& from,
+                                          const DatagramSender& send)>;
+
+    UringBackend();
+
+    // Деструктор: закрывает подключения и освобождает кольцо
+    ~UringBackend();
+
+    // Поддерживает ли ядро всё, что нужно (multishot accept/recv, кольцо буферов)
+    // reason Причина, если не поддерживает
+    static bool supported(string& reason);
+
+    // Ограничение числа подключений TCP
+    // maxConnections Наибольшее число подключений
+    // rejectResponse Ответ лишнему подключению (после него подключение закрывается)
+    // onReject Вызывается на каждое отклонённое подключение
+    void setConnectionLimit(size_t maxConnections, vector<char> rejectResponse, function<void()> onReject);
+
+    // Обслуживает TCP-подключения на слушающем сокете (до stop)
+    // false, если кольцо не удалось создать
+    bool runTCP(int listenSocket, RequestHandler handler);
+
+    // Обслуживает UDP-сокет (до stop)
+    bool runUDP(int udpSocket, DatagramHandler handler);
+
+    // Останавливает цикл (из любого потока)
+    void stop();
+
+    // Открытых TCP-подключений
+    size_t activeConnections() const;
+
+private:
+    // Что означает завершившаяся заявка (старшие биты user_data)
+    enum Operation : uint64_t {
+        OP_ACCEPT = 1,
+        OP_RECV,
+        OP_SEND_HEADER,
+        OP_SEND_BODY,
+        OP_WAKE,
+        OP_UDP_RECV,
+        OP_UDP_SEND,
+        OP_NOP      // Пустая заявка на месте несостоявшейся (событие пропускается)
+    };
+
+    // TCP-подключение
+    struct Connection {
+        int fd = -1;
+        uint32_t generation = 0;  // Меняется при освобождении: старые ответы не попадут в новое подключение
+        vector<char> input;       // Полученные, но ещё не разобранные байты
+        vector<char> output;      // Ответ, который сейчас отправляется
+        uint32_t outputHeader = 0;// Длина ответа (сетевой порядок)
+        bool recvActive = false;  // multishot recv ещё выдаёт события
+        bool inFlight = false;    // Запрос у обработчиков
+        int sendsPending = 0;     // Незавершённых send
+        bool sendFailed = false;
+        bool closing = false;
+        chrono::steady_clock::time_point sendStartedAt;  // Для этапа отправки
+        Tracer::Request trace;    // Запрос отправляемого ответа в трассе
+    };
+
+    // Ответ обработчика, ждущий отправки в потоке кольца
+    struct Completion {
+        uint32_t index;
+        uint32_t generation;
+        vector<char> response;
+        Tracer::Request trace;
+    };
+
+    // UDP-пакет на отправку (msghdr должен жить до завершения sendmsg)
+    struct DatagramSend {
+        SocketAddress to;
+        vector<char> data;
+        iovec iov;
+        msghdr header;
+    };
+
+    // Кольцо
+    int ringFd;
+    void* sqRing;
+    size_t sqRingSize;
+    void* cqRing;
+    size_t cqRingSize;
+    io_uring_sqe* sqes;
+    size_t sqesSize;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqArray;
+    unsigned sqMask;
+    unsigned sqEntries;
+    unsigned sqLocalTail;
+    unsigned toSubmit;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned cqMask;
+    io_uring_cqe* cqes;
+
+    // Кольцо предоставленных буферов для recv/recvmsg
+    io_uring_buf_ring* bufferRing;
+    size_t bufferRingSize;
+    vector<char> bufferMemory;
+    unsigned short bufferTail;
+
+    // Пробуждение потока кольца (eventfd открыт от конструктора до деструктора)
+    atomic<int> wakeFd;
+    uint64_t wakeValue;
+    atomic<bool> stopRequested;
+    thread::id loopThread;
+
+    // Заявки accept, recvmsg и чтения eventfd, которые не удалось поставить
+    // (очередь заявок заполнена): loop повторяет их в начале итерации
+    bool rearmAccept;
+    bool rearmWake;
+    bool rearmUdpRecv;
+
+    // TCP
+    int listenFd;
+    RequestHandler requestHandler;
+    vector<Connection> connections;
+    vector<uint32_t> freeConnections;
+    atomic<size_t> liveConnections;
+    size_t maxConnections;
+    vector<char> rejectResponse;
+    function<void()> onReject;
+
+    // UDP
+    int udpFd;
+    DatagramHandler datagramHandler;
+    msghdr udpRecvHeader;
+    vector<unique_ptr<DatagramSend>> datagramSlots;
+    vector<uint32_t> freeDatagramSlots;
+
+    // Ответы и пакеты из других потоков
+    mutex pendingMutex;
+    vector<Completion> pendingReplies;
+    vector<unique_ptr<DatagramSend>> pendingDatagrams;
+
+    // Создаёт кольцо и регистрирует буферы
+    bool setupRing();
+    // Освобождает кольцо
+    void teardownRing();
+
+    // Свободная заявка (nullptr, если очередь заявок заполнена и после отправки)
+    io_uring_sqe* getSqe();
+    // Гарантирует count свободных заявок подряд (для связанных send)
+    void reserveSqes(unsigned count);
+    // Отправляет накопленные заявки и ждёт хотя бы minComplete событий
+    void submit(unsigned minComplete);
+
+    // Главный цикл
+    void loop();
+    // Разбирает все готовые события
+    void processCompletions();
+    void handleCompletion(const io_uring_cqe& cqe);
+
+    // Заявки
+    void armAccept();
+    void armRecv(uint32_t index);
+    void armWake();
+    void armUdpRecv();
+    // Повторяет заявки, которые не удалось поставить
+    void rearmPending();
+    // Возвращает буфер bid в кольцо
+    void recycleBuffer(unsigned bid);
+
+    // Пробуждает поток кольца (если вызвано не из него)
+    void wake();
+
+    // TCP: события подключения
+    void onAccept(int result, uint32_t flags);
+    void onRecv(uint32_t index, int result, uint32_t flags);
+    void onSend(uint32_t index, Operation op, int result);
+    // Отдаёт обработчику следующий полный запрос подключения
+    void dispatch(uint32_t index);
+    // Начинает отправку ответа
+    void startSend(uint32_t index, vector<char> response, const Tracer::Request& trace);
+    // Закрывает подключение, когда все его заявки завершены
+    void startClose(uint32_t index);
+    void finishClose(uint32_t index);
+
+    // UDP
+    void onUdpRecv(int result, uint32_t flags);
+    void startDatagramSend(unique_ptr<DatagramSend> send);
+
+    // Отправляет ответы и пакеты, пришедшие из других потоков
+    void drainPending();
+
+    static uint64_t makeUserData(Operation op, uint32_t generation, uint32_t index);
+};
+
+#endif
@@ -0,0 +1,121 @@
+#!/bin/bash
+# Проверка надёжного канала UDP при потерях пакетов
+
+# Запускает сервер UDP и нагружает его через lossyproxy (потери и задержка
+# в обе стороны) при 1, 5 и 10% потерь, плюс прогон с узким местом
+# (ограничение пакетов в секунду и короткая очередь). Выводит таблицу:
+# полезная пропускная способность (ответов в секунду), доля от прогона без
+# потерь и сколько пакетов прошло через прокси на один ответ (повторы).
+# Проверка успешна, если ни один запрос не остался без ответа.
+
+# Использование:
+#   loss_check.sh --build-dir=<каталог сборки> [--duration=S] [--delay=MS]
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TESTS_DIR="$(dirname "$SCRIPT_DIR")"
+
+source "$TESTS_DIR/utils.sh"
+
+BUILD_DIR=""
+DURATION=4
+DELAY_MS=5
+for arg in "$@"; do
+    case "$arg" in
+        --build-dir=*) BUILD_DIR="${arg#*=}" ;;
+        --duration=*) DURATION="${arg#*=}" ;;
+        --delay=*) DELAY_MS="${arg#*=}" ;;
+        *)
+            echo "Неизвестный параметр: $arg"
+            exit 2
+            ;;
+    esac
+done
+
+if [ -z "$BUILD_DIR" ]; then
+    echo "Укажите каталог сборки: --build-dir=<каталог>"
+    exit 2
+fi
+
+BIN_DIR="$BUILD_DIR/bin"
+LOG_DIR="$BUILD_DIR/loss"
+mkdir -p "$LOG_DIR"
+
+for binary in server loadgen lossyproxy; do
+    if [ ! -x "$BIN_DIR/$binary" ]; then
+        echo -e "${RED}ОШИБКА: Не найден $BIN_DIR/$binary${NC}"
+        exit 2
+    fi
+done
+
+print_header "ПРОВЕРКА КАНАЛА UDP ПРИ ПОТЕРЯХ"
+
+export BASE_PORT=18380
+server_port=$(find_free_port)
+export BASE_PORT=$((server_port + 1))
+proxy_port=$(find_free_port)
+
+"$BIN_DIR/server" "$server_port" udp --log-level=warning > "$LOG_DIR/server.log" 2>&1 &
+server_pid=$!
+proxy_pid=""
+sleep 0.5
+
+cleanup() {
+    [ -n "$proxy_pid" ] && kill -TERM "$proxy_pid" 2>/dev/null && wait "$proxy_pid" 2>/dev/null
+    kill -TERM "$server_pid" 2>/dev/null
+    wait "$server_pid" 2>/dev/null
+}
+trap cleanup EXIT
+
+# Прогон через прокси: имя, параметры прокси
+# Выводит строку таблицы; код 1 - были запросы без ответа
+run_case() {
+    local name="$1"
+    shift
+    local log="$LOG_DIR/$name"
+    "$BIN_DIR/lossyproxy" "$proxy_port" "$server_port" --delay="$DELAY_MS" --seed=1 "$@" \
+        > "$log.proxy.log" 2>&1 &
+    proxy_pid=$!
+    sleep 0.2
+    "$BIN_DIR/loadgen" 127.0.0.1 udp "$proxy_port" --connections=4 --async=64 \
+        --duration="$DURATION" --warmup=0.5 > "$log.loadgen.log" 2>&1
+    kill -TERM "$proxy_pid" 2>/dev/null
+    wait "$proxy_pid" 2>/dev/null
+    proxy_pid=""
+
+    local answers errors rps packets
+    answers=$(grep -oP 'Ответов: \K[0-9]+' "$log.loadgen.log")
+    errors=$(grep -oP 'ошибок: \K[0-9]+' "$log.loadgen.log")
+    rps=$(grep -oP 'пропускная способность: \K[0-9.]+' "$log.loadgen.log")
+    packets=$(grep -oP 'пакетов \K[0-9]+' "$log.proxy.log" | awk '{ sum += $1 } END { print sum }')
+    if [ -z "$rps" ]; then
+        rps=0
+    fi
+    if [ -z "$baseline_rps" ]; then
+        baseline_rps=$rps
+    fi
+    awk -v name="$name" -v rps="$rps" -v base="$baseline_rps" -v answers="${answers:-0}" \
+        -v packets="${packets:-0}" -v errors="${errors:--}" 'BEGIN {
+        share = base > 0 ? 100 * rps / base : 0
+        perAnswer = answers > 0 ? packets / answers : 0
+        printf "%12.1f %7.0f%% %8.2f %7s  %s\n", rps, share, perAnswer, errors, name
+    }'
+    [ "$errors" = "0" ]
+}
+
+# Ширина столбцов - в байтах, поэтому русские заголовки отдельной строкой
+echo "Ответов/с, доля от прогона без потерь, пакетов на ответ, ошибок, сеть:"
+baseline_rps=""
+failed=0
+run_case "без_потерь" --loss=0 || failed=1
+for loss in 1 5 10; do
+    run_case "потери_${loss}%" --loss="$loss" || failed=1
+done
+run_case "узкое_место" --loss=1 --rate=3000 --queue=32 || failed=1
+
+if [ $failed -ne 0 ]; then
+    echo -e "${RED}ОШИБКА: есть запросы без ответа (журналы в $LOG_DIR)${NC}"
+    exit 1
+fi
+
+echo -e "${GREEN}Канал UDP при потерях работает: все запросы получили ответ${NC}"
+exit 0
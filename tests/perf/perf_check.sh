@@ -0,0 +1,108 @@
+#!/bin/bash
+# Проверка производительности: сравнение с эталоном из репозитория
+
+# Несколько раз запускает микробенчмарки (bench) и нагрузочный тест
+# (loadgen против server по TCP на loopback), сводит прогоны в медианы
+# с оценкой шума и сравнивает с tests/perf/baselines/perf_baseline.json.
+# Завершается с ошибкой, если время операций, p99 задержки запросов или
+# пропускная способность ухудшились больше порога (и больше шума измерений).
+
+# Использование:
+#   perf_check.sh --build-dir=<каталог сборки> [--runs=N] [--threshold=0.15] [--update-baseline]
+# Порог можно задать и переменной окружения PERF_THRESHOLD.
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TESTS_DIR="$(dirname "$SCRIPT_DIR")"
+
+source "$TESTS_DIR/utils.sh"
+source "$TESTS_DIR/report.sh"
+
+BUILD_DIR=""
+RUNS=5
+THRESHOLD="${PERF_THRESHOLD:-0.15}"
+UPDATE_BASELINE=0
+
+for arg in "$@"; do
+    case "$arg" in
+        --build-dir=*) BUILD_DIR="${arg#*=}" ;;
+        --runs=*) RUNS="${arg#*=}" ;;
+        --threshold=*) THRESHOLD="${arg#*=}" ;;
+        --update-baseline) UPDATE_BASELINE=1 ;;
+        *)
+            echo "Неизвестный параметр: $arg"
+            exit 2
+            ;;
+    esac
+done
+
+if [ -z "$BUILD_DIR" ]; then
+    echo "Укажите каталог сборки: --build-dir=<каталог>"
+    exit 2
+fi
+
+BIN_DIR="$BUILD_DIR/bin"
+BASELINE_FILE="$SCRIPT_DIR/baselines/perf_baseline.json"
+export TIMESTAMP=$(date +%Y%m%d_%H%M%S)
+PERF_DIR="$BUILD_DIR/perf/$TIMESTAMP"
+export PERF_SUMMARY_FILE="$BUILD_DIR/perf/perf_summary_$TIMESTAMP.txt"
+mkdir -p "$PERF_DIR"
+
+# Параметры замеров: небольшие, чтобы проверка шла около минуты
+BENCH_ARGS="--max-edges=100000 --reps=9 --budget=0.5"
+LOADGEN_ARGS="--connections=8 --duration=3 --warmup=0.5"
+export BASE_PORT=18180
+
+for binary in server bench loadgen; do
+    if [ ! -x "$BIN_DIR/$binary" ]; then
+        echo -e "${RED}ОШИБКА: Не найден $BIN_DIR/$binary${NC}"
+        exit 2
+    fi
+done
+
+print_header "ПРОВЕРКА ПРОИЗВОДИТЕЛЬНОСТИ"
+echo "Прогонов: $RUNS, порог: $THRESHOLD"
+
+for run in $(seq 1 "$RUNS"); do
+    echo ""
+    echo "Прогон $run из $RUNS"
+
+    echo "  Микробенчмарки..."
+    if ! "$BIN_DIR/bench" $BENCH_ARGS --json="$PERF_DIR/bench_$run.json" > "$PERF_DIR/bench_$run.log"; then
+        echo -e "${RED}ОШИБКА: bench завершился с ошибкой (см. $PERF_DIR/bench_$run.log)${NC}"
+        exit 2
+    fi
+
+    echo "  Нагрузочный тест (TCP, закрытый цикл)..."
+    port=$(find_free_port)
+    "$BIN_DIR/server" "$port" tcp --log-level=error > "$PERF_DIR/server_$run.log" 2>&1 &
+    server_pid=$!
+    sleep 0.5
+    "$BIN_DIR/loadgen" 127.0.0.1 tcp "$port" $LOADGEN_ARGS \
+        --json="$PERF_DIR/loadgen_$run.json" > "$PERF_DIR/loadgen_$run.log"
+    loadgen_status=$?
+    kill -TERM "$server_pid" 2>/dev/null
+    wait "$server_pid" 2>/dev/null
+    if [ $loadgen_status -ne 0 ]; then
+        echo -e "${RED}ОШИБКА: loadgen завершился с ошибкой (см. $PERF_DIR/loadgen_$run.log)${NC}"
+        exit 2
+    fi
+done
+
+CURRENT_FILE="$PERF_DIR/current.json"
+python3 "$SCRIPT_DIR/perf_compare.py" aggregate "$CURRENT_FILE" "$PERF_DIR"/bench_*.json "$PERF_DIR"/loadgen_*.json
+
+if [ $UPDATE_BASELINE -eq 1 ]; then
+    mkdir -p "$(dirname "$BASELINE_FILE")"
+    cp "$CURRENT_FILE" "$BASELINE_FILE"
+    echo ""
+    echo -e "${GREEN}Эталон обновлён: $BASELINE_FILE${NC}"
+    exit 0
+fi
+
+echo ""
+python3 "$SCRIPT_DIR/perf_compare.py" compare "$BASELINE_FILE" "$CURRENT_FILE" "$THRESHOLD" \
+    "$PERF_DIR/comparison.txt"
+status=$?
+
+generate_perf_report $status "$PERF_DIR/comparison.txt"
+exit $?
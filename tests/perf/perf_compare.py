@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+# Сравнение результатов производительности с эталоном
+
+# Команды:
+#   aggregate <выход.json> <прогон.json>...
+#       Сводит несколько прогонов bench/loadgen в один файл метрик:
+#       для каждой метрики - медиана по прогонам и шум. Шум - большее из
+#       двух: разброс между прогонами (медианное абсолютное отклонение, MAD)
+#       и разброс внутри прогона (у микробенчмарков - от минимума до p99
+#       по повторениям). Второе нужно, потому что короткие операции на
+#       общей машине "прыгают" и между запусками процесса, а прогонов
+#       всего несколько.
+#   compare <эталон.json> <текущий.json> <порог> [<отчёт.txt>]
+#       Сравнивает медианы. Метрика считается ухудшившейся, если изменение
+#       в худшую сторону больше порога И больше трёх "сигм" шума
+#       (шум - наибольший из эталонного и текущего): так случайные колебания
+#       нагруженной машины не выдаются за регрессию, а настоящая - не
+#       прячется за слишком маленьким порогом.
+#       Код выхода 1, если есть ухудшения; 2 - если эталона нет.
+
+import json
+import statistics
+import sys
+
+# MAD * 1.4826 - оценка стандартного отклонения для нормального распределения
+MAD_TO_SIGMA = 1.4826
+# Во сколько "сигм" шума должно уложиться случайное отклонение
+NOISE_SIGMAS = 3.0
+# Размах ~10 замеров (от минимума до максимума) - примерно три "сигмы"
+RANGE_TO_SIGMA = 1.0 / 3.0
+
+
+def metrics_of_run(run):
+    """Метрики одного прогона: имя -> (значение, что лучше: lower/higher, шум внутри прогона)."""
+    metrics = {}
+    if run.get("suite") == "microbench":
+        for r in run["results"]:
+            key = "bench/%s/%s" % (r["name"], r["size"])
+            # p99 микробенчмарка из десятка повторений - это почти максимум,
+            # он слишком шумный для проверки; хвост задержек проверяется по loadgen
+            spread = 0.0
+            if r["median_ns"] > 0:
+                spread = RANGE_TO_SIGMA * (r["p99_ns"] - r["min_ns"]) / r["median_ns"]
+            metrics[key + "/median_ns"] = (r["median_ns"], "lower", spread)
+    elif run.get("tool") == "loadgen":
+        key = "loadgen/%s/%s" % (run["protocol"], run["mode"])
+        metrics[key + "/throughput_rps"] = (run["throughput_rps"], "higher", 0.0)
+        metrics[key + "/p99_us"] = (run["latency_us"]["p99"], "lower", 0.0)
+    return metrics
+
+
+def aggregate(output, inputs):
+    samples = {}
+    spreads = {}
+    better = {}
+    for path in inputs:
+        with open(path) as f:
+            for name, (value, direction, spread) in metrics_of_run(json.load(f)).items():
+                samples.setdefault(name, []).append(float(value))
+                spreads.setdefault(name, []).append(spread)
+                better[name] = direction
+
+    result = {}
+    for name, values in sorted(samples.items()):
+        median = statistics.median(values)
+        mad = statistics.median([abs(v - median) for v in values])
+        noise = MAD_TO_SIGMA * mad / median if median > 0 else 0.0
+        noise = max(noise, statistics.median(spreads[name]))
+        result[name] = {
+            "median": median,
+            "noise": round(noise, 4),
+            "runs": len(values),
+            "better": better[name],
+        }
+
+    with open(output, "w") as f:
+        json.dump({"version": 1, "metrics": result}, f, indent=2, sort_keys=True)
+        f.write("\n")
+    return 0
+
+
+def compare(baseline_path, current_path, threshold, report_path=None):
+    try:
+        with open(baseline_path) as f:
+            baseline = json.load(f)["metrics"]
+    except FileNotFoundError:
+        print("Эталон не найден: %s (создайте его: perf_check.sh --update-baseline)" % baseline_path)
+        return 2
+    with open(current_path) as f:
+        current = json.load(f)["metrics"]
+
+    lines = []
+    regressions = 0
+    improvements = 0
+    for name in sorted(baseline):
+        if name not in current:
+            lines.append("  %-60s нет в текущем прогоне" % name)
+            continue
+        base = baseline[name]
+        cur = current[name]
+        if base["median"] <= 0:
+            continue
+        change = (cur["median"] - base["median"]) / base["median"]
+        # Положительное - ухудшение, независимо от того, что лучше для метрики
+        worse = change if base["better"] == "lower" else -change
+        tolerance = max(threshold, NOISE_SIGMAS * max(base["noise"], cur["noise"]))
+
+        if worse > tolerance:
+            status = "ХУЖЕ"
+            regressions += 1
+        elif -worse > tolerance:
+            status = "лучше"
+            improvements += 1
+        else:
+            status = "ok"
+        lines.append("  %-60s %14.1f -> %14.1f  %+7.1f%%  (допуск %.1f%%)  %s" % (
+            name, base["median"], cur["median"], change * 100, tolerance * 100, status))
+
+    lines.append("")
+    lines.append("Метрик: %d, ухудшений: %d, улучшений: %d (порог %.1f%%)" % (
+        len(baseline), regressions, improvements, threshold * 100))
+
+    text = "\n".join(lines)
+    print(text)
+    if report_path:
+        with open(report_path, "w") as f:
+            f.write(text + "\n")
+    return 1 if regressions > 0 else 0
+
+
+def main(argv):
+    if len(argv) >= 3 and argv[1] == "aggregate":
+        return aggregate(argv[2], argv[3:])
+    if len(argv) >= 5 and argv[1] == "compare":
+        return compare(argv[2], argv[3], float(argv[4]), argv[5] if len(argv) > 5 else None)
+    print("Использование:")
+    print("  %s aggregate <выход.json> <прогон.json>..." % argv[0])
+    print("  %s compare <эталон.json> <текущий.json> <порог> [<отчёт.txt>]" % argv[0])
+    return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,110 @@
+#!/bin/bash
+# Проверка клиента нескольких серверов (PooledClient)
+
+# Запускает три сервера на разных портах и нагружает их через loadgen со
+# списком серверов. Во время нагрузки один сервер останавливается и через
+# пару секунд запускается снова. Проверка успешна, если:
+#   - ни один запрос не остался без ответа (запросы остановленного сервера
+#     ушли на соседей по кольцу);
+#   - каждый сервер обслужил запросы (в том числе перезапущенный - он
+#     вернулся в кольцо после пробы).
+
+# Использование:
+#   pool_check.sh --build-dir=<каталог сборки>
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+TESTS_DIR="$(dirname "$SCRIPT_DIR")"
+
+source "$TESTS_DIR/utils.sh"
+
+BUILD_DIR=""
+for arg in "$@"; do
+    case "$arg" in
+        --build-dir=*) BUILD_DIR="${arg#*=}" ;;
+        *)
+            echo "Неизвестный параметр: $arg"
+            exit 2
+            ;;
+    esac
+done
+
+if [ -z "$BUILD_DIR" ]; then
+    echo "Укажите каталог сборки: --build-dir=<каталог>"
+    exit 2
+fi
+
+BIN_DIR="$BUILD_DIR/bin"
+LOG_DIR="$BUILD_DIR/pool"
+mkdir -p "$LOG_DIR"
+
+for binary in server loadgen; do
+    if [ ! -x "$BIN_DIR/$binary" ]; then
+        echo -e "${RED}ОШИБКА: Не найден $BIN_DIR/$binary${NC}"
+        exit 2
+    fi
+done
+
+print_header "ПРОВЕРКА КЛИЕНТА НЕСКОЛЬКИХ СЕРВЕРОВ"
+
+# Три сервера на соседних свободных портах
+ports=()
+pids=()
+export BASE_PORT=18280
+for i in 0 1 2; do
+    port=$(find_free_port)
+    "$BIN_DIR/server" "$port" tcp --log-level=warning > "$LOG_DIR/server_$i.log" 2>&1 &
+    pids+=($!)
+    ports+=($port)
+    export BASE_PORT=$((port + 1))
+done
+sleep 0.5
+
+stop_servers() {
+    for pid in "${pids[@]}"; do
+        kill -TERM "$pid" 2>/dev/null
+        wait "$pid" 2>/dev/null
+    done
+}
+trap stop_servers EXIT
+
+endpoints="127.0.0.1:${ports[0]},127.0.0.1:${ports[1]},127.0.0.1:${ports[2]}"
+echo "Серверы: $endpoints"
+
+# Средний сервер останавливается на второй секунде и возвращается на четвёртой
+(
+    sleep 2
+    kill -TERM "${pids[1]}" 2>/dev/null
+    sleep 2
+    "$BIN_DIR/server" "${ports[1]}" tcp --log-level=warning > "$LOG_DIR/server_1_restart.log" 2>&1 &
+    echo $! > "$LOG_DIR/restarted.pid"
+) &
+restarter=$!
+
+"$BIN_DIR/loadgen" "$endpoints" tcp --connections=2 --duration=7 --warmup=0.5 --graphs=64 \
+    > "$LOG_DIR/loadgen.log" 2>&1
+loadgen_status=$?
+wait $restarter
+pids[1]=$(cat "$LOG_DIR/restarted.pid")
+
+if [ $loadgen_status -ne 0 ]; then
+    echo -e "${RED}ОШИБКА: loadgen завершился с ошибкой (см. $LOG_DIR/loadgen.log)${NC}"
+    exit 1
+fi
+
+grep -E "Ответов|Запросов по серверам" "$LOG_DIR/loadgen.log"
+
+errors=$(grep -oP 'ошибок: \K[0-9]+' "$LOG_DIR/loadgen.log")
+if [ "$errors" != "0" ]; then
+    echo -e "${RED}ОШИБКА: запросов без ответа: $errors${NC}"
+    exit 1
+fi
+for port in "${ports[@]}"; do
+    served=$(grep -oP "127\.0\.0\.1:$port - \K[0-9]+" "$LOG_DIR/loadgen.log")
+    if [ -z "$served" ] || [ "$served" -eq 0 ]; then
+        echo -e "${RED}ОШИБКА: сервер на порту $port не обслужил ни одного запроса${NC}"
+        exit 1
+    fi
+done
+
+echo -e "${GREEN}Клиент нескольких серверов работает: ошибок нет, все серверы в кольце${NC}"
+exit 0
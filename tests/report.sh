@@ -51,4 +51,48 @@ EOF
         echo -e "${RED}==========================================${NC}"
         return 1
     fi
-}
\ No newline at end of file
+}
+
+# Отчёт проверки производительности (perf/perf_check.sh)
+# $1 - код сравнения (0 - ухудшений нет, 1 - есть, 2 - нет эталона)
+# $2 - файл с таблицей сравнения
+generate_perf_report() {
+    local status=$1
+    local comparison_file=$2
+
+    print_header "ОТЧЕТ О ПРОИЗВОДИТЕЛЬНОСТИ"
+
+    local verdict="Ухудшений нет"
+    if [ $status -eq 1 ]; then
+        verdict="Есть ухудшения"
+    elif [ $status -ne 0 ]; then
+        verdict="Сравнение не выполнено (нет эталона)"
+    fi
+
+    cat > "$PERF_SUMMARY_FILE" << EOF2
+ОТЧЕТ О ПРОИЗВОДИТЕЛЬНОСТИ
+==========================
+Дата: $(date)
+
+РЕЗУЛЬТАТ: $verdict
+
+СРАВНЕНИЕ С ЭТАЛОНОМ:
+$(cat "$comparison_file" 2>/dev/null || echo "Детали недоступны")
+
+КОНЕЦ ОТЧЕТА
+EOF2
+
+    echo "Краткий отчет: $PERF_SUMMARY_FILE"
+
+    if [ $status -eq 0 ]; then
+        echo -e "\n${GREEN}==========================================${NC}"
+        echo -e "${GREEN}  ПРОИЗВОДИТЕЛЬНОСТЬ В НОРМЕ${NC}"
+        echo -e "${GREEN}==========================================${NC}"
+        return 0
+    else
+        echo -e "\n${RED}==========================================${NC}"
+        echo -e "${RED}  $verdict${NC}"
+        echo -e "${RED}==========================================${NC}"
+        return 1
+    fi
+}
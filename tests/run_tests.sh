@@ -38,6 +38,7 @@ run_test "protocols/test_tcp_multiple.expect" "TCP: Несколько клие
 run_test "protocols/test_udp_basic.expect" "UDP: Базовая работа"
 run_test "protocols/test_udp_unavailable.expect" "UDP: Недоступный сервер"
 run_test "protocols/test_udp_retransmission.expect" "UDP: Повторная отправка"
+run_test "protocols/test_unix_basic.expect" "Unix-сокет: Базовая работа"
 
 # Методы ввода
 echo ""
@@ -58,6 +59,7 @@ run_test "validation/test_graph_above_max.expect" "ОДЗ: 21 вершина (в
 echo ""
 echo "4. ТЕСТИРОВАНИЕ АЛГОРИТМОВ:"
 run_test "algorithms/test_no_path.expect" "Алгоритм: Несуществующий путь"
+run_test "algorithms/test_weighted_length.expect" "Алгоритм: Длина пути с дробными весами"
 
 # Очистка
 echo ""
@@ -49,11 +49,11 @@ Graph FileReader::readGraphFromFile(const std::string& filename) {
     }
     
     // Создаем список числовых ребер
-    vector<vector<int>> numericEdges;
+    vector<Edge> numericEdges;
     for (const auto& edge : stringEdges) {
         int from = vertexMap[edge.vertex1];
         int to = vertexMap[edge.vertex2];
-        numericEdges.push_back({from, to});
+        numericEdges.push_back({from, to, edge.weight});
     }
     
     // Добавляем все ребра в граф
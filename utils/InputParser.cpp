@@ -29,15 +29,31 @@ bool InputParser::parseGraph(const string& input, vector<Edge>& edges) {
             return false;
         }
         
-        // Проверяем, что после двух вершин больше ничего нет
+        // Третье слово (если есть) - вес ребра
+        double weight = 1.0;
+        string weightStr;
+        if (ss >> weightStr) {
+            // Вес должен быть числом целиком: "2.5" - да, "2x" - нет
+            size_t parsed = 0;
+            try {
+                weight = stod(weightStr, &parsed);
+            } catch (...) {
+                return false;
+            }
+            if (parsed != weightStr.size()) {
+                return false;
+            }
+        }
+        
+        // Проверяем, что после вершин и веса больше ничего нет
         string extra;
         if (ss >> extra) {
-            // Если есть третье слово - это ошибка
+            // Если есть четвёртое слово - это ошибка
             return false;
         }
         
         // Добавляем ребро в список
-        edges.push_back(Edge(v1, v2));
+        edges.push_back(Edge(v1, v2, weight));
     }
     
     return true;
@@ -23,10 +23,11 @@ public:
     struct Edge {
         string vertex1;  // Первая вершина ребра
         string vertex2;  // Вторая вершина ребра
+        double weight;   // Вес ребра (если не указан - 1)
         
         // Конструктор для удобного создания
-        Edge(const string& v1, const string& v2) 
-            : vertex1(v1), vertex2(v2) {}
+        Edge(const string& v1, const string& v2, double w = 1.0) 
+            : vertex1(v1), vertex2(v2), weight(w) {}
     };
 
     // Парсит описание графа из строки
@@ -37,6 +38,10 @@ public:
     // Формат ввода: пары вершин, разделённые запятыми
     // Пример входа: "A B, B C, C D, D E, E F, F A"
     // Результат: [(A,B), (B,C), (C,D), (D,E), (E,F), (F,A)]
+    
+    // После пары вершин можно указать вес ребра (по умолчанию 1)
+    // Пример входа: "A B 2.5, B C 4, C D"
+    // Результат: [(A,B,2.5), (B,C,4), (C,D,1)]
 
     static bool parseGraph(const string& input, vector<Edge>& edges);
 
@@ -2,9 +2,32 @@
 
 using namespace std;
 
+// До какого размера копить пачку строк перед вызовом write (байты)
+const size_t LOG_BATCH_BYTES = 64 * 1024;
+// Как долго фоновый поток спит, если его никто не разбудил
+const int LOG_IDLE_WAIT_MS = 100;
+
 // Инициализация статического мьютекса
 mutex Logger::logMutex;
 
+// По умолчанию выводится всё, что пропустила сборка
+atomic<Logger::Level> Logger::currentLevel(Logger::Level::INFO);
+
+// Состояние асинхронного режима
+unique_ptr<Logger::Slot[]> Logger::slots;
+size_t Logger::slotMask = 0;
+atomic<size_t> Logger::head(0);
+atomic<size_t> Logger::tail(0);
+Logger::Overflow Logger::overflow = Logger::Overflow::DROP;
+atomic<bool> Logger::asyncEnabled(false);
+atomic<int> Logger::activeProducers(0);
+atomic<size_t> Logger::dropped(0);
+thread Logger::writerThread;
+atomic<bool> Logger::stopRequested(false);
+atomic<bool> Logger::writerSleeping(false);
+mutex Logger::wakeMutex;
+condition_variable Logger::wakeCondition;
+
 // Логирует информационное сообщение
 void Logger::info(const string& message) {
     log(Level::INFO, message);
@@ -20,16 +43,34 @@ void Logger::error(const string& message) {
     log(Level::ERROR, message);
 }
 
-// Основная функция логирования
+// Устанавливает минимальный уровень во время работы
+void Logger::setLevel(Level level) {
+    currentLevel.store(level, memory_order_relaxed);
+}
 
-// Выводит сообщение в формате: [УРОВЕНЬ] сообщение
-// Использует мьютекс для предотвращения смешивания вывода из разных потоков
-void Logger::log(Level level, const string& message) {
-    // Блокируем мьютекс, чтобы только один поток мог писать в консоль
-    lock_guard<mutex> lock(logMutex);
-    
+// Текущий минимальный уровень
+Logger::Level Logger::getLevel() {
+    return currentLevel.load(memory_order_relaxed);
+}
+
+// Разбирает название уровня
+bool Logger::parseLevel(const string& name, Level& level) {
+    if (name == "info") {
+        level = Level::INFO;
+    } else if (name == "warning") {
+        level = Level::WARNING;
+    } else if (name == "error") {
+        level = Level::ERROR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Форматирует строку лога
+string Logger::format(Level level, const string& message) {
     // Определяем префикс в зависимости от уровня
-    string prefix;
+    const char* prefix = "";
     switch (level) {
         case Level::INFO:
             prefix = "[INFO] ";
@@ -41,7 +82,220 @@ void Logger::log(Level level, const string& message) {
             prefix = "[ERROR] ";
             break;
     }
-    
-    // Выводим сообщение с префиксом
-    cout << prefix << message << endl;
-}
\ No newline at end of file
+
+    string text;
+    text.reserve(12 + message.size());
+    text += prefix;
+    text += message;
+    text += '\n';
+    return text;
+}
+
+// Основная функция логирования
+
+// Синхронный режим: выводит сообщение в формате [УРОВЕНЬ] сообщение
+// под мьютексом, чтобы вывод разных потоков не смешивался.
+// Асинхронный режим: кладёт готовую строку в очередь фонового потока.
+void Logger::log(Level level, const string& message) {
+    // Сообщения ниже текущего уровня не выводятся
+    if (!isEnabled(level)) {
+        return;
+    }
+
+    string text = format(level, message);
+
+    // Отмечаемся как пишущий поток до проверки флага:
+    // stopAsync дождётся, пока мы закончим
+    activeProducers++;
+    if (asyncEnabled) {
+        bool pushed = tryPush(text);
+        while (!pushed && overflow == Overflow::BLOCK) {
+            this_thread::yield();
+            pushed = tryPush(text);
+        }
+        if (!pushed) {
+            dropped++;
+        }
+        activeProducers--;
+
+        // Будим фоновый поток, только если он действительно спит -
+        // обычно он и так работает, и лишних системных вызовов нет
+        if (pushed && writerSleeping) {
+            lock_guard<mutex> lock(wakeMutex);
+            wakeCondition.notify_one();
+        }
+        return;
+    }
+    activeProducers--;
+
+    // Блокируем мьютекс, чтобы только один поток мог писать в консоль
+    lock_guard<mutex> lock(logMutex);
+    cout << text << flush;
+}
+
+// Включает асинхронный режим
+void Logger::startAsync(size_t capacity, Overflow policy) {
+    if (asyncEnabled) {
+        return;
+    }
+
+    // Размер - степень двойки, чтобы позиция в кольце считалась маской
+    size_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+    slots.reset(new Slot[size]);
+    for (size_t i = 0; i < size; i++) {
+        slots[i].sequence.store(i);
+    }
+    slotMask = size - 1;
+    head = 0;
+    tail = 0;
+    overflow = policy;
+    dropped = 0;
+    stopRequested = false;
+
+    // Всё, что уже лежит в буфере cout, должно выйти раньше строк из очереди
+    cout.flush();
+
+    writerThread = thread(writerLoop);
+    asyncEnabled = true;
+}
+
+// Выключает асинхронный режим
+void Logger::stopAsync() {
+    if (!asyncEnabled.exchange(false)) {
+        return;
+    }
+
+    // Ждём потоки, которые успели увидеть asyncEnabled = true
+    while (activeProducers > 0) {
+        this_thread::yield();
+    }
+
+    {
+        lock_guard<mutex> lock(wakeMutex);
+        stopRequested = true;
+    }
+    wakeCondition.notify_one();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+}
+
+// Сколько сообщений выброшено
+size_t Logger::getDropped() {
+    return dropped;
+}
+
+// Сколько строк ждут вывода
+size_t Logger::getQueueDepth() {
+    // Позиции читаются не одновременно, поэтому значение приблизительное
+    size_t written = head.load(memory_order_relaxed);
+    size_t read = tail.load(memory_order_relaxed);
+    return written > read ? written - read : 0;
+}
+
+// Кладёт строку в очередь
+bool Logger::tryPush(string& text) {
+    size_t position = head.load(memory_order_relaxed);
+    while (true) {
+        Slot& slot = slots[position & slotMask];
+        size_t sequence = slot.sequence.load(memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if (diff == 0) {
+            // Ячейка свободна - пробуем её занять
+            if (head.compare_exchange_weak(position, position + 1, memory_order_relaxed)) {
+                slot.text = move(text);
+                // seq_cst, а не release: запись должна быть видна раньше, чем
+                // мы прочитаем writerSleeping (иначе можно не разбудить поток)
+                slot.sequence.store(position + 1);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;  // Очередь заполнена: фоновый поток ещё не прочитал эту ячейку
+        } else {
+            position = head.load(memory_order_relaxed);  // Ячейку занял другой поток
+        }
+    }
+}
+
+// Забирает строку из очереди (вызывает только фоновый поток)
+bool Logger::tryPop(string& text) {
+    size_t position = tail.load(memory_order_relaxed);
+    Slot& slot = slots[position & slotMask];
+    size_t sequence = slot.sequence.load(memory_order_acquire);
+    if (sequence != position + 1) {
+        return false;
+    }
+    text = move(slot.text);
+    slot.text.clear();
+    tail.store(position + 1, memory_order_relaxed);
+    // Ячейка снова свободна для записи на следующем круге
+    slot.sequence.store(position + slotMask + 1, memory_order_release);
+    return true;
+}
+
+// Есть ли в очереди готовые строки
+bool Logger::hasPending() {
+    size_t position = tail.load(memory_order_relaxed);
+    return slots[position & slotMask].sequence.load() == position + 1;
+}
+
+// Главный цикл фонового потока
+void Logger::writerLoop() {
+    string batch;
+    batch.reserve(LOG_BATCH_BYTES);
+    string text;
+    size_t reportedDrops = 0;
+
+    while (true) {
+        // Забираем всё, что накопилось, и выводим крупными кусками
+        while (tryPop(text)) {
+            batch += text;
+            if (batch.size() >= LOG_BATCH_BYTES) {
+                writeAll(batch);
+                batch.clear();
+            }
+        }
+
+        size_t drops = dropped;
+        if (drops != reportedDrops) {
+            batch += "[WARNING] Логгер: очередь заполнена, пропущено сообщений: " +
+                     to_string(drops - reportedDrops) + "\n";
+            reportedDrops = drops;
+        }
+
+        if (!batch.empty()) {
+            writeAll(batch);
+            batch.clear();
+        }
+
+        if (stopRequested && !hasPending()) {
+            return;
+        }
+
+        // Очередь пуста - засыпаем до первой новой строки
+        unique_lock<mutex> lock(wakeMutex);
+        writerSleeping = true;
+        wakeCondition.wait_for(lock, chrono::milliseconds(LOG_IDLE_WAIT_MS), [] {
+            return stopRequested || hasPending();
+        });
+        writerSleeping = false;
+    }
+}
+
+// Выводит data целиком
+void Logger::writeAll(const string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t written = ::write(STDOUT_FILENO, data.data() + offset, data.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;  // Вывод закрыт - строки теряются, как и при cout
+        }
+        offset += static_cast<size_t>(written);
+    }
+}
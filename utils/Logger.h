@@ -5,14 +5,46 @@
 #include <mutex>
 #include <iostream>
 #include <ctime>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <condition_variable>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <sstream>
+#include <unistd.h>
 
 using namespace std;
 
+// Минимальный уровень, который вообще попадает в программу:
+// 0 - INFO, 1 - WARNING, 2 - ERROR (задаётся при сборке, см. CMakeLists.txt)
+// Вызовы LOG_INFO и т.п. ниже этого уровня компилятор выбрасывает целиком
+#ifndef LOGGER_MIN_LEVEL
+#define LOGGER_MIN_LEVEL 0
+#endif
+
 // Класс для потокобезопасного логирования сообщений
 
 // Используется для вывода информационных сообщений, предупреждений и ошибок
 // Потокобезопасен - можно использовать из разных потоков одновременно
 
+// Два режима:
+// 1. Синхронный (по умолчанию): каждая строка выводится сразу под мьютексом.
+// 2. Асинхронный (startAsync, включает сервер): поток только кладёт готовую
+//    строку в ограниченную очередь без блокировок и сразу возвращается.
+//    Фоновый поток забирает строки пачками и выводит их крупными вызовами
+//    write. Потоки клиентов больше не ждут друг друга и консоль.
+
+// Фильтрация по уровню:
+// - при сборке: LOGGER_MIN_LEVEL
+// - во время работы: setLevel (например, сервер с --log-level=warning)
+// Logger::info("a" + to_string(x)) собирает строку до вызова, даже если
+// уровень INFO выключен. В частых местах используйте макросы:
+//   LOG_INFO("Путь найден, длина: ", length);
+// Аргументы склеиваются через << и вычисляются, только если уровень включён -
+// иначе вызов стоит одной проверки.
+
 class Logger {
 public:
     // Типы сообщений для логирования
@@ -22,6 +54,40 @@ public:
         ERROR     // Ошибка (например: "Не удалось подключиться")
     };
 
+    // Уровень, заданный при сборке
+    static constexpr Level COMPILED_MIN_LEVEL = static_cast<Level>(LOGGER_MIN_LEVEL);
+
+    // Устанавливает минимальный уровень во время работы
+    // Сообщения ниже уровня не выводятся
+    static void setLevel(Level level);
+
+    // Текущий минимальный уровень
+    static Level getLevel();
+
+    // Разбирает название уровня: "info", "warning" или "error"
+    // false, если название неизвестно
+    static bool parseLevel(const string& name, Level& level);
+
+    // Будет ли выведено сообщение этого уровня
+    // Первое сравнение - с константой, поэтому для уровней ниже
+    // LOGGER_MIN_LEVEL компилятор убирает и проверку, и вызов
+    static bool isEnabled(Level level) {
+        return level >= COMPILED_MIN_LEVEL &&
+               level >= currentLevel.load(memory_order_relaxed);
+    }
+
+    // Склеивает части сообщения через << и логирует результат
+    // Пример: Logger::write(Logger::Level::INFO, "Порт ", port, " занят");
+    template <typename... Parts>
+    static void write(Level level, const Parts&... parts) {
+        if (!isEnabled(level)) {
+            return;
+        }
+        ostringstream out;
+        (out << ... << parts);
+        log(level, out.str());
+    }
+
     
     // Логирует информационное сообщение
     // message Текст сообщения
@@ -47,6 +113,27 @@ public:
     
     static void error(const string& message);
 
+    // Что делать, если очередь асинхронного логгера заполнена
+    enum class Overflow {
+        DROP,   // Выбросить сообщение (поток не ждёт; число пропущенных выводится в лог)
+        BLOCK   // Ждать, пока фоновый поток освободит место
+    };
+
+    // Включает асинхронный режим
+    // capacity Размер очереди (округляется вверх до степени двойки)
+    // policy Поведение при заполненной очереди
+    static void startAsync(size_t capacity = 8192, Overflow policy = Overflow::DROP);
+
+    // Выключает асинхронный режим: выводит всё, что осталось в очереди,
+    // и останавливает фоновый поток. Дальше логгер снова синхронный
+    static void stopAsync();
+
+    // Сколько сообщений выброшено из-за заполненной очереди
+    static size_t getDropped();
+
+    // Сколько строк ждут вывода в очереди асинхронного режима
+    static size_t getQueueDepth();
+
 private:
     // Общая функция для логирования с указанием уровня
     // level Уровень сообщения (INFO, WARNING, ERROR)
@@ -55,6 +142,77 @@ private:
 
     // Мьютекс для синхронизации доступа к консоли из разных потоков
     static mutex logMutex;
+
+    // Минимальный уровень во время работы
+    static atomic<Level> currentLevel;
+
+    // Ячейка очереди асинхронного режима
+    // sequence говорит, чья сейчас очередь: записывающего потока
+    // (sequence == позиция) или фонового (sequence == позиция + 1)
+    struct Slot {
+        atomic<size_t> sequence;
+        string text;
+    };
+
+    // Ограниченная очередь "много писателей - один читатель" (кольцевой буфер).
+    // Писатели занимают позицию атомарным compare_exchange на head,
+    // блокировок нет
+    static unique_ptr<Slot[]> slots;
+    static size_t slotMask;                // Размер очереди - 1
+    static atomic<size_t> head;            // Следующая позиция для записи
+    static atomic<size_t> tail;            // Следующая позиция для чтения
+    static Overflow overflow;
+
+    static atomic<bool> asyncEnabled;      // Асинхронный режим включён
+    static atomic<int> activeProducers;    // Сколько потоков сейчас пишут в очередь
+    static atomic<size_t> dropped;         // Сколько сообщений выброшено
+
+    // Фоновый поток и его пробуждение
+    static thread writerThread;
+    static atomic<bool> stopRequested;
+    static atomic<bool> writerSleeping;
+    static mutex wakeMutex;
+    static condition_variable wakeCondition;
+
+    // Форматирует строку лога: префикс уровня, сообщение, перевод строки
+    static string format(Level level, const string& message);
+
+    // Кладёт строку в очередь; false, если очередь заполнена
+    static bool tryPush(string& text);
+
+    // Забирает строку из очереди; false, если очередь пуста
+    static bool tryPop(string& text);
+
+    // Есть ли в очереди готовые строки
+    static bool hasPending();
+
+    // Главный цикл фонового потока
+    static void writerLoop();
+
+    // Выводит data целиком одним или несколькими вызовами write
+    static void writeAll(const string& data);
 };
 
+// Ленивое логирование: аргументы вычисляются, только если уровень включён
+#define LOG_INFO(...) \
+    do { \
+        if (Logger::isEnabled(Logger::Level::INFO)) { \
+            Logger::write(Logger::Level::INFO, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_WARNING(...) \
+    do { \
+        if (Logger::isEnabled(Logger::Level::WARNING)) { \
+            Logger::write(Logger::Level::WARNING, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_ERROR(...) \
+    do { \
+        if (Logger::isEnabled(Logger::Level::ERROR)) { \
+            Logger::write(Logger::Level::ERROR, __VA_ARGS__); \
+        } \
+    } while (0)
+
 #endif
\ No newline at end of file